@@ -30,8 +30,6 @@
 
 #include <ranges>
 
-#include <malloc.h>
-
 #include <cassert>
 
 #include <fmt/format.h>
@@ -304,6 +302,25 @@ main_window_rubberband_all()
     }
 }
 
+void
+main_window_preview_all()
+{
+    for (MainWindow* window : all_windows)
+    {
+        for (const panel_t p : PANELS)
+        {
+            GtkNotebook* notebook = window->get_panel_notebook(p);
+            const i32 num_pages = gtk_notebook_get_n_pages(notebook);
+            for (const auto i : std::views::iota(0z, num_pages))
+            {
+                PtkFileBrowser* a_browser =
+                    PTK_FILE_BROWSER_REINTERPRET(gtk_notebook_get_nth_page(notebook, i));
+                a_browser->show_preview(xset_get_b(xset::name::view_preview));
+            }
+        }
+    }
+}
+
 void
 main_window_refresh_all()
 {
@@ -448,11 +465,6 @@ main_window_reload_thumbnails_all_windows()
             }
         }
     }
-
-    /* Ensuring free space at the end of the heap is freed to the OS,
-     * mainly to deal with the possibility thousands of large thumbnails
-     * have been freed but the memory not actually released by SpaceFM */
-    malloc_trim(0);
 }
 
 void
@@ -811,7 +823,8 @@ MainWindow::show_panels() noexcept
                         {
                             folder_path = vfs::user_dirs->home_dir();
                         }
-                        this->new_tab(folder_path);
+                        // only the tab that ends up shown loads its dir now
+                        this->new_tab(folder_path, true);
                         tab_added = true;
                     }
                     if (set->x && !set->ob1)
@@ -1626,10 +1639,22 @@ main_window_get_tab_cwd(PtkFileBrowser* file_browser, tab_t tab_num)
 const std::optional<std::filesystem::path>
 main_window_get_panel_cwd(PtkFileBrowser* file_browser, panel_t panel_num)
 {
-    if (!file_browser)
+    const PtkFileBrowser* panel_file_browser =
+        main_window_get_panel_file_browser(file_browser, panel_num);
+    if (!panel_file_browser)
     {
         return std::nullopt;
     }
+    return panel_file_browser->cwd();
+}
+
+PtkFileBrowser*
+main_window_get_panel_file_browser(PtkFileBrowser* file_browser, panel_t panel_num)
+{
+    if (!file_browser)
+    {
+        return nullptr;
+    }
     const MainWindow* main_window = file_browser->main_window();
     panel_t panel_x = file_browser->panel();
 
@@ -1645,7 +1670,7 @@ main_window_get_panel_cwd(PtkFileBrowser* file_browser, panel_t panel_num)
                 }
                 if (panel_x == file_browser->panel())
                 {
-                    return std::nullopt;
+                    return nullptr;
                 }
             } while (!gtk_widget_get_visible(GTK_WIDGET(main_window->get_panel_notebook(panel_x))));
             break;
@@ -1659,7 +1684,7 @@ main_window_get_panel_cwd(PtkFileBrowser* file_browser, panel_t panel_num)
                 }
                 if (panel_x == file_browser->panel())
                 {
-                    return std::nullopt;
+                    return nullptr;
                 }
             } while (!gtk_widget_get_visible(GTK_WIDGET(main_window->get_panel_notebook(panel_x))));
             break;
@@ -1667,7 +1692,7 @@ main_window_get_panel_cwd(PtkFileBrowser* file_browser, panel_t panel_num)
             panel_x = panel_num;
             if (!gtk_widget_get_visible(GTK_WIDGET(main_window->get_panel_notebook(panel_x))))
             {
-                return std::nullopt;
+                return nullptr;
             }
             break;
     }
@@ -1675,9 +1700,7 @@ main_window_get_panel_cwd(PtkFileBrowser* file_browser, panel_t panel_num)
     GtkNotebook* notebook = main_window->get_panel_notebook(panel_x);
     const i32 page_x = gtk_notebook_get_current_page(notebook);
 
-    const PtkFileBrowser* panel_file_browser =
-        PTK_FILE_BROWSER_REINTERPRET(gtk_notebook_get_nth_page(notebook, page_x));
-    return panel_file_browser->cwd();
+    return PTK_FILE_BROWSER_REINTERPRET(gtk_notebook_get_nth_page(notebook, page_x));
 }
 
 void
@@ -1975,7 +1998,7 @@ MainWindow::create_tab_label(PtkFileBrowser* file_browser) const noexcept
 }
 
 void
-MainWindow::new_tab(const std::filesystem::path& folder_path) noexcept
+MainWindow::new_tab(const std::filesystem::path& folder_path, bool deferred) noexcept
 {
     // ztd::logger::debug("New tab fb={} panel={} path={}", fmt::ptr(file_browser), this->curpanel, folder_path);
 
@@ -2047,7 +2070,11 @@ MainWindow::new_tab(const std::filesystem::path& folder_path) noexcept
         gtk_notebook_set_show_tabs(this->notebook, false);
     }
 
-    if (!file_browser->chdir(folder_path))
+    if (deferred)
+    {
+        file_browser->chdir_deferred(folder_path);
+    }
+    else if (!file_browser->chdir(folder_path))
     {
         file_browser->chdir("/");
     }
@@ -2982,6 +3009,10 @@ on_main_window_keypress_found_key(MainWindow* main_window, const xset_t& set)
     {
         main_window_rubberband_all();
     }
+    else if (set->xset_name == xset::name::view_preview)
+    {
+        main_window_preview_all();
+    }
     else
     {
         browser->on_action(set->xset_name);
@@ -3289,6 +3320,9 @@ main_write_exports(const std::shared_ptr<vfs::file_task>& vtask, const std::stri
             {vfs::file_task::type::link, "link"},
             {vfs::file_task::type::chmod_chown, "change"},
             {vfs::file_task::type::exec, "run"},
+            {vfs::file_task::type::rename, "rename"},
+            {vfs::file_task::type::sync, "sync"},
+            {vfs::file_task::type::find_dups, "dups"},
         };
 
         buf.append("\n");
@@ -92,7 +92,8 @@ struct MainWindow
     PtkFileBrowser* current_file_browser() const noexcept;
 
     GtkWidget* create_tab_label(PtkFileBrowser* file_browser) const noexcept;
-    void new_tab(const std::filesystem::path& folder_path) noexcept;
+    // a deferred tab does not load its dir until it is first shown
+    void new_tab(const std::filesystem::path& folder_path, bool deferred = false) noexcept;
     void open_path_in_current_tab(const std::filesystem::path& path) noexcept;
 
     void set_window_title(PtkFileBrowser* file_browser) noexcept;
@@ -144,10 +145,14 @@ const std::optional<std::filesystem::path> main_window_get_tab_cwd(PtkFileBrowse
                                                                    tab_t tab_num);
 const std::optional<std::filesystem::path> main_window_get_panel_cwd(PtkFileBrowser* file_browser,
                                                                      panel_t panel_num);
+// current tab of a visible panel, panel_num can be panel_control_code_prev/next
+PtkFileBrowser* main_window_get_panel_file_browser(PtkFileBrowser* file_browser,
+                                                   panel_t panel_num);
 bool main_window_panel_is_visible(PtkFileBrowser* file_browser, panel_t panel);
 void main_window_open_in_panel(PtkFileBrowser* file_browser, panel_t panel_num,
                                const std::filesystem::path& file_path);
 void main_window_rubberband_all();
+void main_window_preview_all();
 void main_window_refresh_all();
 void set_panel_focus(MainWindow* main_window, PtkFileBrowser* file_browser);
 
@@ -0,0 +1,752 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <string_view>
+
+#include <filesystem>
+
+#include <array>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+#include <span>
+
+#include <optional>
+
+#include <algorithm>
+#include <ranges>
+
+#include <bit>
+#include <charconv>
+
+#include <mutex>
+#include <shared_mutex>
+
+#include <cstdlib>
+
+#include <pugixml.hpp>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "mime-type/mime-overlay.hxx"
+
+// update-mime-database also applies this package after all others
+inline constexpr std::string_view OVERRIDE_PACKAGE{"Override.xml"};
+
+// a glob pattern that only exists to stop the type from being matched by name
+inline constexpr std::string_view NO_GLOBS_PATTERN{"__NOGLOBS__"};
+
+static bool
+is_literal_pattern(const std::string_view pattern)
+{
+    return pattern.find_first_of("*?[") == std::string_view::npos;
+}
+
+// "4" or "4:10", the end is the last offset the match may start at
+static bool
+parse_offset(const std::string_view offset, u32* start, u32* end)
+{
+    const auto split = offset.find(':');
+    const auto first = offset.substr(0, split);
+    if (std::from_chars(first.data(), first.data() + first.size(), *start).ec != std::errc())
+    {
+        return false;
+    }
+
+    *end = *start;
+    if (split != std::string_view::npos)
+    {
+        const auto last = offset.substr(split + 1);
+        if (std::from_chars(last.data(), last.data() + last.size(), *end).ec != std::errc() ||
+            *end < *start)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// string values use C style escapes, \xHH and \NNN for octal
+static const std::string
+parse_string_value(const std::string_view value)
+{
+    std::string result;
+    result.reserve(value.size());
+
+    for (usize i = 0; i < value.size(); ++i)
+    {
+        if (value[i] != '\\' || i + 1 == value.size())
+        {
+            result.push_back(value[i]);
+            continue;
+        }
+
+        i += 1;
+        const char c = value[i];
+        if (c == 'x')
+        {
+            u32 number = 0;
+            const auto digits = value.substr(i + 1, 2);
+            const auto [ptr, ec] =
+                std::from_chars(digits.data(), digits.data() + digits.size(), number, 16);
+            if (ec != std::errc())
+            {
+                result.push_back(c);
+                continue;
+            }
+            result.push_back(static_cast<char>(number));
+            i += ptr - digits.data();
+        }
+        else if (c >= '0' && c <= '7')
+        {
+            const auto digits = value.substr(i, 3);
+            u32 number = 0;
+            const auto [ptr, ec] =
+                std::from_chars(digits.data(), digits.data() + digits.size(), number, 8);
+            result.push_back(static_cast<char>(number));
+            i += ptr - digits.data() - 1;
+        }
+        else if (c == 'n')
+        {
+            result.push_back('\n');
+        }
+        else if (c == 'r')
+        {
+            result.push_back('\r');
+        }
+        else if (c == 't')
+        {
+            result.push_back('\t');
+        }
+        else
+        {
+            result.push_back(c);
+        }
+    }
+    return result;
+}
+
+// string masks are written as hex, 0xff00ff
+static const std::optional<std::string>
+parse_string_mask(const std::string_view mask)
+{
+    if (!mask.starts_with("0x") || mask.size() % 2 != 0)
+    {
+        return std::nullopt;
+    }
+
+    std::string result;
+    for (usize i = 2; i < mask.size(); i += 2)
+    {
+        u32 number = 0;
+        const auto [ptr, ec] = std::from_chars(mask.data() + i, mask.data() + i + 2, number, 16);
+        if (ec != std::errc() || ptr != mask.data() + i + 2)
+        {
+            return std::nullopt;
+        }
+        result.push_back(static_cast<char>(number));
+    }
+    return result;
+}
+
+static const std::optional<std::string>
+encode_number(const std::string_view value, usize width, std::endian order)
+{
+    const std::string number_str{value};
+    char* end = nullptr;
+    const u64 number = std::strtoull(number_str.c_str(), &end, 0);
+    if (end == number_str.c_str() || *end != '\0')
+    {
+        return std::nullopt;
+    }
+
+    std::string bytes(width, '\0');
+    for (const auto i : std::views::iota(0uz, width))
+    {
+        const usize shift = (order == std::endian::big) ? (width - 1 - i) * 8 : i * 8;
+        bytes[i] = static_cast<char>((number >> shift) & 0xff);
+    }
+    return bytes;
+}
+
+MimeOverlay::MimeOverlay(const std::filesystem::path& packages_dir) : packages_dir_(packages_dir)
+{
+}
+
+const std::filesystem::path&
+MimeOverlay::packages_dir()
+{
+    return this->packages_dir_;
+}
+
+const std::optional<MimeOverlay::magic_match>
+MimeOverlay::parse_match(const pugi::xml_node& node)
+{
+    magic_match match;
+
+    if (!parse_offset(node.attribute("offset").value(), &match.offset_start, &match.offset_end))
+    {
+        return std::nullopt;
+    }
+
+    const std::string_view type = node.attribute("type").value();
+    const std::string_view value = node.attribute("value").value();
+    const std::string_view mask = node.attribute("mask").value();
+
+    if (type == "string")
+    {
+        match.value = parse_string_value(value);
+        if (!mask.empty())
+        {
+            const auto mask_bytes = parse_string_mask(mask);
+            if (!mask_bytes || mask_bytes->size() != match.value.size())
+            {
+                return std::nullopt;
+            }
+            match.mask = mask_bytes.value();
+        }
+    }
+    else
+    {
+        usize width = 0;
+        std::endian order = std::endian::native;
+        if (type == "byte")
+        {
+            width = 1;
+        }
+        else if (type == "host16" || type == "big16" || type == "little16")
+        {
+            width = 2;
+        }
+        else if (type == "host32" || type == "big32" || type == "little32")
+        {
+            width = 4;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+
+        if (type.starts_with("big"))
+        {
+            order = std::endian::big;
+        }
+        else if (type.starts_with("little"))
+        {
+            order = std::endian::little;
+        }
+
+        const auto value_bytes = encode_number(value, width, order);
+        if (!value_bytes)
+        {
+            return std::nullopt;
+        }
+        match.value = value_bytes.value();
+
+        if (!mask.empty())
+        {
+            const auto mask_bytes = encode_number(mask, width, order);
+            if (!mask_bytes)
+            {
+                return std::nullopt;
+            }
+            match.mask = mask_bytes.value();
+        }
+    }
+
+    if (match.value.empty())
+    {
+        return std::nullopt;
+    }
+
+    for (const pugi::xml_node child : node.children("match"))
+    {
+        auto child_match = parse_match(child);
+        if (child_match)
+        {
+            match.children.emplace_back(std::move(child_match.value()));
+        }
+    }
+
+    return match;
+}
+
+const std::optional<MimeOverlay::package>
+MimeOverlay::parse_package(const std::filesystem::path& path)
+{
+    pugi::xml_document doc;
+    const pugi::xml_parse_result result = doc.load_file(path.c_str());
+    if (!result)
+    {
+        ztd::logger::error("XML parsing error: {}: {}", path.string(), result.description());
+        return std::nullopt;
+    }
+
+    package package;
+
+    for (const pugi::xml_node type_node : doc.child("mime-info").children("mime-type"))
+    {
+        definition definition;
+        definition.type = type_node.attribute("type").value();
+        if (definition.type.empty())
+        {
+            continue;
+        }
+
+        for (const pugi::xml_node comment_node : type_node.children("comment"))
+        {
+            // the untranslated comment, the first one if all are translated
+            if (definition.comment.empty() || !comment_node.attribute("xml:lang"))
+            {
+                definition.comment = comment_node.child_value();
+            }
+            if (!comment_node.attribute("xml:lang"))
+            {
+                break;
+            }
+        }
+
+        definition.icon = type_node.child("icon").attribute("name").value();
+        if (definition.icon.empty())
+        {
+            definition.icon = type_node.child("generic-icon").attribute("name").value();
+        }
+
+        for (const pugi::xml_node parent_node : type_node.children("sub-class-of"))
+        {
+            definition.parents.emplace_back(parent_node.attribute("type").value());
+        }
+        for (const pugi::xml_node alias_node : type_node.children("alias"))
+        {
+            definition.aliases.emplace_back(alias_node.attribute("type").value());
+        }
+
+        definition.glob_deleteall = !type_node.child("glob-deleteall").empty();
+        definition.magic_deleteall = !type_node.child("magic-deleteall").empty();
+
+        for (const pugi::xml_node glob_node : type_node.children("glob"))
+        {
+            glob glob;
+            glob.type = definition.type;
+            glob.pattern = glob_node.attribute("pattern").value();
+            glob.weight = glob_node.attribute("weight").as_int(50);
+            glob.case_sensitive = glob_node.attribute("case-sensitive").as_bool(false);
+            if (glob.pattern.empty() || glob.pattern == NO_GLOBS_PATTERN)
+            {
+                continue;
+            }
+            if (!glob.case_sensitive)
+            {
+                glob.pattern = ztd::lower(glob.pattern);
+            }
+            definition.globs.emplace_back(std::move(glob));
+        }
+
+        for (const pugi::xml_node magic_node : type_node.children("magic"))
+        {
+            magic magic;
+            magic.type = definition.type;
+            magic.priority = magic_node.attribute("priority").as_int(50);
+            for (const pugi::xml_node match_node : magic_node.children("match"))
+            {
+                auto match = parse_match(match_node);
+                if (match)
+                {
+                    magic.matches.emplace_back(std::move(match.value()));
+                }
+                else
+                {
+                    ztd::logger::warn("invalid magic match for {} in {}",
+                                      definition.type,
+                                      path.string());
+                }
+            }
+            if (!magic.matches.empty())
+            {
+                definition.magics.emplace_back(std::move(magic));
+            }
+        }
+
+        package.definitions.emplace_back(std::move(definition));
+    }
+
+    return package;
+}
+
+const std::vector<std::string>
+MimeOverlay::update()
+{
+    std::vector<std::string> changed;
+    bool modified = false;
+
+    const auto add_changed = [&changed](const package& package)
+    {
+        for (const definition& definition : package.definitions)
+        {
+            changed.emplace_back(definition.type);
+        }
+    };
+
+    std::map<std::string, package> packages;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(this->packages_dir_, ec))
+    {
+        const auto& path = entry.path();
+        if (path.extension() != ".xml" || !entry.is_regular_file(ec))
+        {
+            continue;
+        }
+
+        const std::string name = path.filename();
+        const auto mtime = entry.last_write_time(ec);
+        const u64 size = entry.file_size(ec);
+
+        const auto old = this->packages_.find(name);
+        if (old != this->packages_.cend() && old->second.mtime == mtime &&
+            old->second.size == size)
+        {
+            packages.insert(this->packages_.extract(old));
+            continue;
+        }
+
+        auto parsed = parse_package(path);
+        if (!parsed)
+        {
+            // likely still being written, the old version is kept until it can be parsed
+            if (old != this->packages_.cend())
+            {
+                packages.insert(this->packages_.extract(old));
+            }
+            continue;
+        }
+        parsed->mtime = mtime;
+        parsed->size = size;
+
+        // ztd::logger::debug("MimeOverlay parsed {}", path.string());
+
+        modified = true;
+        if (old != this->packages_.cend())
+        {
+            add_changed(old->second);
+            this->packages_.erase(old);
+        }
+        add_changed(parsed.value());
+        packages.insert({name, std::move(parsed.value())});
+    }
+
+    // whatever is left was deleted
+    for (const auto& package : this->packages_ | std::views::values)
+    {
+        modified = true;
+        add_changed(package);
+    }
+
+    this->packages_ = std::move(packages);
+
+    if (!modified)
+    {
+        return {};
+    }
+
+    this->rebuild();
+
+    std::ranges::sort(changed);
+    const auto [first, last] = std::ranges::unique(changed);
+    changed.erase(first, last);
+    return changed;
+}
+
+void
+MimeOverlay::rebuild()
+{
+    std::unordered_map<std::string, definition> types;
+
+    const auto merge = [&types](const package& package)
+    {
+        for (const definition& definition : package.definitions)
+        {
+            auto& merged = types[definition.type];
+            merged.type = definition.type;
+            if (!definition.comment.empty())
+            {
+                merged.comment = definition.comment;
+            }
+            if (!definition.icon.empty())
+            {
+                merged.icon = definition.icon;
+            }
+            // the deleteall elements also drop what earlier packages defined
+            if (definition.glob_deleteall)
+            {
+                merged.glob_deleteall = true;
+                merged.globs.clear();
+            }
+            if (definition.magic_deleteall)
+            {
+                merged.magic_deleteall = true;
+                merged.magics.clear();
+            }
+            std::ranges::copy(definition.parents, std::back_inserter(merged.parents));
+            std::ranges::copy(definition.aliases, std::back_inserter(merged.aliases));
+            std::ranges::copy(definition.globs, std::back_inserter(merged.globs));
+            std::ranges::copy(definition.magics, std::back_inserter(merged.magics));
+        }
+    };
+
+    for (const auto& [name, package] : this->packages_)
+    {
+        if (name != OVERRIDE_PACKAGE)
+        {
+            merge(package);
+        }
+    }
+    if (this->packages_.contains(OVERRIDE_PACKAGE.data()))
+    {
+        merge(this->packages_.at(OVERRIDE_PACKAGE.data()));
+    }
+
+    std::unordered_map<std::string, std::string> aliases;
+    std::vector<glob> literals;
+    std::vector<glob> globs;
+    std::vector<magic> magics;
+    for (const definition& definition : types | std::views::values)
+    {
+        for (const std::string& alias : definition.aliases)
+        {
+            aliases.insert({alias, definition.type});
+        }
+        for (const glob& glob : definition.globs)
+        {
+            if (is_literal_pattern(glob.pattern))
+            {
+                literals.emplace_back(glob);
+            }
+            else
+            {
+                globs.emplace_back(glob);
+            }
+        }
+        std::ranges::copy(definition.magics, std::back_inserter(magics));
+    }
+
+    std::ranges::sort(globs,
+                      [](const glob& a, const glob& b)
+                      {
+                          if (a.weight != b.weight)
+                          {
+                              return a.weight > b.weight;
+                          }
+                          return a.pattern.size() > b.pattern.size();
+                      });
+    std::ranges::stable_sort(magics,
+                             [](const magic& a, const magic& b)
+                             { return a.priority > b.priority; });
+
+    u32 magic_max_extent = 0;
+    for (const magic& magic : magics)
+    {
+        for (const magic_match& match : magic.matches)
+        {
+            magic_max_extent = std::max(magic_max_extent, magic_match_extent(match));
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(this->lock_);
+    this->types_ = std::move(types);
+    this->aliases_ = std::move(aliases);
+    this->literals_ = std::move(literals);
+    this->globs_ = std::move(globs);
+    this->magics_ = std::move(magics);
+    this->magic_max_extent_ = magic_max_extent;
+}
+
+const std::optional<std::string>
+MimeOverlay::lookup_filename(const std::string_view filename)
+{
+    std::shared_lock<std::shared_mutex> lock(this->lock_);
+
+    if (this->literals_.empty() && this->globs_.empty())
+    {
+        return std::nullopt;
+    }
+
+    const std::string lower_filename = ztd::lower(filename);
+
+    for (const glob& literal : this->literals_)
+    {
+        const std::string_view name = literal.case_sensitive ? filename : lower_filename;
+        if (literal.pattern == name)
+        {
+            return literal.type;
+        }
+    }
+
+    for (const glob& glob : this->globs_)
+    {
+        const std::string_view name = glob.case_sensitive ? filename : lower_filename;
+        if (ztd::fnmatch(glob.pattern, name))
+        {
+            return glob.type;
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool
+MimeOverlay::magic_match_data(const magic_match& match, const std::span<const char8_t> data)
+{
+    const usize size = match.value.size();
+
+    for (usize offset = match.offset_start; offset <= match.offset_end; ++offset)
+    {
+        if (offset + size > data.size())
+        {
+            break;
+        }
+
+        bool matched = true;
+        for (const auto i : std::views::iota(0uz, size))
+        {
+            u8 byte = data[offset + i];
+            u8 value = match.value[i];
+            if (!match.mask.empty())
+            {
+                byte &= static_cast<u8>(match.mask[i]);
+                value &= static_cast<u8>(match.mask[i]);
+            }
+            if (byte != value)
+            {
+                matched = false;
+                break;
+            }
+        }
+        if (!matched)
+        {
+            continue;
+        }
+
+        if (match.children.empty())
+        {
+            return true;
+        }
+        for (const magic_match& child : match.children)
+        {
+            if (magic_match_data(child, data))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+u32
+MimeOverlay::magic_match_extent(const magic_match& match)
+{
+    u32 extent = match.offset_end + static_cast<u32>(match.value.size());
+    for (const magic_match& child : match.children)
+    {
+        extent = std::max(extent, magic_match_extent(child));
+    }
+    return extent;
+}
+
+const std::optional<std::string>
+MimeOverlay::lookup_magic(const std::span<const char8_t> data)
+{
+    std::shared_lock<std::shared_mutex> lock(this->lock_);
+
+    for (const magic& magic : this->magics_)
+    {
+        for (const magic_match& match : magic.matches)
+        {
+            if (magic_match_data(match, data))
+            {
+                return magic.type;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+u32
+MimeOverlay::magic_max_extent()
+{
+    std::shared_lock<std::shared_mutex> lock(this->lock_);
+
+    return this->magic_max_extent_;
+}
+
+const std::vector<std::string>
+MimeOverlay::lookup_parents(const std::string_view mime_type)
+{
+    std::shared_lock<std::shared_mutex> lock(this->lock_);
+
+    const auto it = this->types_.find(mime_type.data());
+    if (it == this->types_.cend())
+    {
+        return {};
+    }
+    return it->second.parents;
+}
+
+const std::optional<std::string>
+MimeOverlay::lookup_alias(const std::string_view mime_type)
+{
+    std::shared_lock<std::shared_mutex> lock(this->lock_);
+
+    const auto it = this->aliases_.find(mime_type.data());
+    if (it == this->aliases_.cend())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const std::optional<std::array<std::string, 2>>
+MimeOverlay::lookup_desc_icon(const std::string_view mime_type)
+{
+    std::shared_lock<std::shared_mutex> lock(this->lock_);
+
+    const auto it = this->types_.find(mime_type.data());
+    if (it == this->types_.cend() || (it->second.comment.empty() && it->second.icon.empty()))
+    {
+        return std::nullopt;
+    }
+    return std::array{it->second.icon, it->second.comment};
+}
+
+bool
+MimeOverlay::is_glob_deleted(const std::string_view mime_type)
+{
+    std::shared_lock<std::shared_mutex> lock(this->lock_);
+
+    const auto it = this->types_.find(mime_type.data());
+    return it != this->types_.cend() && it->second.glob_deleteall;
+}
+
+bool
+MimeOverlay::is_magic_deleted(const std::string_view mime_type)
+{
+    std::shared_lock<std::shared_mutex> lock(this->lock_);
+
+    const auto it = this->types_.find(mime_type.data());
+    return it != this->types_.cend() && it->second.magic_deleteall;
+}
@@ -0,0 +1,145 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <filesystem>
+
+#include <array>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+#include <span>
+
+#include <optional>
+
+#include <memory>
+
+#include <shared_mutex>
+
+#include <ztd/ztd.hxx>
+
+namespace pugi
+{
+    class xml_node;
+}
+
+// In memory replacement for the user mime.cache. The package XML files in
+// ~/.local/share/mime/packages are parsed directly, update() only reparses the
+// files that changed since the last call. Lookups take precedence over the
+// system mime.cache files and are safe to call from any thread.
+class MimeOverlay
+{
+  public:
+    MimeOverlay() = delete;
+    ~MimeOverlay() = default;
+
+    MimeOverlay(const std::filesystem::path& packages_dir);
+
+    // returns the mime types whose definition was added, changed or removed
+    const std::vector<std::string> update();
+
+    const std::optional<std::string> lookup_filename(const std::string_view filename);
+    const std::optional<std::string> lookup_magic(const std::span<const char8_t> data);
+    // how many bytes of a file lookup_magic() may look at
+    u32 magic_max_extent();
+    const std::vector<std::string> lookup_parents(const std::string_view mime_type);
+    const std::optional<std::string> lookup_alias(const std::string_view mime_type);
+    // icon name, comment
+    const std::optional<std::array<std::string, 2>>
+    lookup_desc_icon(const std::string_view mime_type);
+
+    // set by <glob-deleteall/> and <magic-deleteall/>, the system
+    // globs or magic of this type are to be ignored
+    bool is_glob_deleted(const std::string_view mime_type);
+    bool is_magic_deleted(const std::string_view mime_type);
+
+    const std::filesystem::path& packages_dir();
+
+  private:
+    struct glob
+    {
+        std::string pattern{};
+        std::string type{};
+        i32 weight{50};
+        bool case_sensitive{false};
+    };
+
+    struct magic_match
+    {
+        u32 offset_start{0};
+        u32 offset_end{0};
+        std::string value{};
+        std::string mask{}; // empty or the same size as value
+        // any one of the children has to match as well
+        std::vector<magic_match> children{};
+    };
+
+    struct magic
+    {
+        std::string type{};
+        i32 priority{50};
+        std::vector<magic_match> matches{};
+    };
+
+    struct definition
+    {
+        std::string type{};
+        std::string comment{};
+        std::string icon{};
+        std::vector<std::string> parents{};
+        std::vector<std::string> aliases{};
+        std::vector<glob> globs{};
+        std::vector<magic> magics{};
+        bool glob_deleteall{false};
+        bool magic_deleteall{false};
+    };
+
+    struct package
+    {
+        std::filesystem::file_time_type mtime{};
+        u64 size{0};
+        std::vector<definition> definitions{};
+    };
+
+    static const std::optional<package> parse_package(const std::filesystem::path& path);
+    static const std::optional<magic_match> parse_match(const pugi::xml_node& node);
+    static bool magic_match_data(const magic_match& match, const std::span<const char8_t> data);
+    static u32 magic_match_extent(const magic_match& match);
+
+    void rebuild();
+
+  private:
+    std::filesystem::path packages_dir_{};
+
+    // keyed by file name, only used by update()
+    std::map<std::string, package> packages_{};
+
+    std::shared_mutex lock_;
+
+    // merged from all packages
+    std::unordered_map<std::string, definition> types_{};
+    std::unordered_map<std::string, std::string> aliases_{};
+    std::vector<glob> literals_{};
+    std::vector<glob> globs_{};   // highest weight, then longest pattern first
+    std::vector<magic> magics_{}; // highest priority first
+    u32 magic_max_extent_{0};
+};
+
+using mime_overlay_t = std::shared_ptr<MimeOverlay>;
@@ -48,15 +48,21 @@
 
 #include "mime-type/mime-type.hxx"
 #include "mime-type/mime-cache.hxx"
+#include "mime-type/mime-overlay.hxx"
 
 /* max extent used to checking text files */
 inline constexpr i32 TEXT_MAX_EXTENT = 512;
+/* user magic rules can look further into a file, but not without limit */
+inline constexpr u32 USER_MAGIC_MAX_EXTENT = 64 * 1024;
 
 /* Check if the specified mime_type is the subclass of the specified parent type */
 static bool mime_type_is_subclass(const std::string_view type, const std::string_view parent);
 
 static std::vector<mime_cache_t> caches;
 
+/* the user mime database, parsed from ~/.local/share/mime/packages */
+static mime_overlay_t user_overlay = nullptr;
+
 /* max magic extent of all caches */
 static u32 mime_cache_max_extent = 0;
 
@@ -82,6 +88,15 @@ mime_type_get_by_filename(const std::filesystem::path& filename,
         return XDG_MIME_TYPE_DIRECTORY.data();
     }
 
+    if (user_overlay)
+    {
+        const auto user_type = user_overlay->lookup_filename(filename.string());
+        if (user_type)
+        {
+            return user_type.value();
+        }
+    }
+
     for (const mime_cache_t& cache : caches)
     {
         type = cache->lookup_literal(filename.c_str());
@@ -124,6 +139,11 @@ mime_type_get_by_filename(const std::filesystem::path& filename,
         }
     }
 
+    if (type && user_overlay && user_overlay->is_glob_deleted(type))
+    {
+        type = nullptr;
+    }
+
     if (type && *type)
     {
         return type;
@@ -183,18 +203,45 @@ mime_type_get_by_file(const std::filesystem::path& filepath)
         const i32 fd = open(filepath.c_str(), O_RDONLY, 0);
         if (fd != -1)
         {
-            // mime header size
-            std::array<char8_t, 512> data;
+            // mime header size, the system caches keep their 512 bytes, only
+            // the user rules get more, capped so a huge offset cannot make
+            // every lookup read the whole file
+            u32 extent = TEXT_MAX_EXTENT;
+            if (user_overlay)
+            {
+                extent = std::clamp(user_overlay->magic_max_extent(),
+                                    extent,
+                                    USER_MAGIC_MAX_EXTENT);
+            }
+            std::vector<char8_t> buffer(std::min(static_cast<u64>(extent), file_size));
 
-            const auto length = read(fd, data.data(), data.size());
+            const auto length = read(fd, buffer.data(), buffer.size());
             if (length == -1)
             {
+                close(fd);
                 return XDG_MIME_TYPE_UNKNOWN.data();
             }
+            const auto data = std::span(buffer.data(), static_cast<usize>(length));
+
+            if (user_overlay)
+            {
+                const auto user_type = user_overlay->lookup_magic(data);
+                if (user_type)
+                {
+                    close(fd);
+                    return user_type.value();
+                }
+            }
 
+            const auto header =
+                data.first(std::min(data.size(), static_cast<usize>(TEXT_MAX_EXTENT)));
             for (usize i = 0; !type && i < caches.size(); ++i)
             {
-                type = caches.at(i)->lookup_magic(data);
+                type = caches.at(i)->lookup_magic(header);
+                if (type && user_overlay && user_overlay->is_magic_deleted(type))
+                {
+                    type = nullptr;
+                }
             }
 
             /* Check for executable file */
@@ -206,7 +253,7 @@ mime_type_get_by_file(const std::filesystem::path& filepath)
             /* fallback: check for plain text */
             if (!type)
             {
-                if (mime_type_is_data_plain_text(data))
+                if (mime_type_is_data_plain_text(header))
                 {
                     type = XDG_MIME_TYPE_PLAIN_TEXT.data();
                 }
@@ -301,11 +348,10 @@ mime_type_get_desc_icon(const std::string_view type)
      * Since the spec really sucks, we do not follow it here.
      */
 
-    const std::string file_path =
-        fmt::format("{}/mime/{}.xml", vfs::user_dirs->data_dir().string(), type);
-    if (faccessat(0, file_path.data(), F_OK, AT_EACCESS) != -1)
+    // the user types are not compiled into ~/.local/share/mime anymore
+    if (user_overlay)
     {
-        const auto icon_data = mime_type_parse_xml_file(file_path, true);
+        const auto icon_data = user_overlay->lookup_desc_icon(type);
         if (icon_data)
         {
             return icon_data.value();
@@ -332,23 +378,20 @@ void
 mime_type_finalize()
 {
     mime_cache_free_all();
+
+    user_overlay = nullptr;
 }
 
 // load all mime.cache files on the system,
-// including /usr/share/mime/mime.cache,
-// /usr/local/share/mime/mime.cache,
-// and $HOME/.local/share/mime/mime.cache.
+// including /usr/share/mime/mime.cache
+// and /usr/local/share/mime/mime.cache.
+// $HOME/.local/share/mime/mime.cache is replaced by the user overlay,
+// that file is only written by update-mime-database for other programs.
 void
 mime_type_init()
 {
-    const auto user_mime_cache = vfs::user_dirs->data_dir() / "mime/mime.cache";
-    const mime_cache_t cache = std::make_shared<MimeCache>(user_mime_cache);
-    caches.emplace_back(cache);
-
-    if (cache->magic_max_extent() > mime_cache_max_extent)
-    {
-        mime_cache_max_extent = cache->magic_max_extent();
-    }
+    user_overlay = std::make_shared<MimeOverlay>(vfs::user_dirs->data_dir() / "mime/packages");
+    user_overlay->update();
 
     caches.reserve(vfs::user_dirs->system_data_dirs().size());
     for (const std::string_view dir : vfs::user_dirs->system_data_dirs())
@@ -579,16 +622,53 @@ mime_type_is_archive_file(const std::filesystem::path& file_path, const std::str
     return std::ranges::find(archive_mime_types, file_mime_type) != archive_mime_types.cend();
 }
 
+/* the canonical name of an alias, user aliases first */
+static const std::string
+mime_type_unalias(const std::string_view type)
+{
+    if (user_overlay)
+    {
+        const auto alias = user_overlay->lookup_alias(type);
+        if (alias)
+        {
+            return alias.value();
+        }
+    }
+
+    for (const mime_cache_t& cache : caches)
+    {
+        const char* alias = cache->lookup_alias(type);
+        if (alias)
+        {
+            return alias;
+        }
+    }
+    return std::string(type);
+}
+
 /* Check if the specified mime_type is the subclass of the specified parent type */
 static bool
-mime_type_is_subclass(const std::string_view type, const std::string_view parent)
+mime_type_is_subclass(const std::string_view alias_type, const std::string_view alias_parent)
 {
+    // parents are listed under the canonical names
+    const std::string type = mime_type_unalias(alias_type);
+    const std::string parent = mime_type_unalias(alias_parent);
+
     /* special case, the type specified is identical to the parent type. */
     if (type == parent)
     {
         return true;
     }
 
+    if (user_overlay)
+    {
+        const std::vector<std::string> parents = user_overlay->lookup_parents(type);
+        if (std::ranges::find(parents, parent) != parents.cend())
+        {
+            return true;
+        }
+    }
+
     for (const mime_cache_t& cache : caches)
     {
         const std::vector<std::string> parents = cache->lookup_parents(type);
@@ -620,3 +700,26 @@ mime_type_regen_all_caches()
 {
     std::ranges::for_each(caches, mime_cache_reload);
 }
+
+/*
+ * Get the user mime database
+ */
+const mime_overlay_t&
+mime_type_get_user_overlay()
+{
+    return user_overlay;
+}
+
+/*
+ * Reparse the changed user package files,
+ * returns the mime types that changed
+ */
+const std::vector<std::string>
+mime_type_update_user_overlay()
+{
+    if (!user_overlay)
+    {
+        return {};
+    }
+    return user_overlay->update();
+}
@@ -23,9 +23,11 @@
 #include <filesystem>
 
 #include <array>
+#include <vector>
 #include <span>
 
 #include "mime-type/mime-cache.hxx"
+#include "mime-type/mime-overlay.hxx"
 
 inline constexpr std::string_view XDG_MIME_TYPE_UNKNOWN{"application/octet-stream"};
 inline constexpr std::string_view XDG_MIME_TYPE_DIRECTORY{"inode/directory"};
@@ -71,3 +73,13 @@ const std::array<std::string, 2> mime_type_get_desc_icon(const std::string_view
 const std::span<const mime_cache_t> mime_type_get_caches();
 
 void mime_type_regen_all_caches();
+
+/*
+ * Get the user mime database
+ */
+const mime_overlay_t& mime_type_get_user_overlay();
+
+/*
+ * Reparse the changed user package files, returns the mime types that changed
+ */
+const std::vector<std::string> mime_type_update_user_overlay();
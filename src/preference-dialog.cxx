@@ -38,6 +38,9 @@
 
 #include "settings.hxx"
 
+#include "vfs/vfs-dir.hxx"
+#include "vfs/vfs-thumbnail-store.hxx"
+
 #include "xset/xset-lookup.hxx"
 
 #include "ptk/ptk-dialog.hxx"
@@ -579,6 +582,39 @@ namespace preference::hover_selects
     }
 } // namespace preference::hover_selects
 
+namespace preference::dir_cache_size
+{
+    void
+    spinner_cb(GtkSpinButton* spinbutton, void* user_data)
+    {
+        (void)user_data;
+        const double value = gtk_spin_button_get_value(spinbutton);
+
+        // convert size from MiB to B
+        const u64 dir_cache_size = static_cast<u64>(value) * 1024 * 1024;
+
+        if (app_settings.dir_cache_size() != dir_cache_size)
+        {
+            app_settings.dir_cache_size(dir_cache_size);
+            vfs_dir_cache_trim();
+        }
+    }
+
+    GtkSpinButton*
+    create_pref_spinner(double scale, double lower, double upper, double step_incr,
+                        double page_incr, i32 digits)
+    {
+        const double value = app_settings.dir_cache_size() / scale;
+
+        GtkAdjustment* adjustment =
+            gtk_adjustment_new(value, lower, upper, step_incr, page_incr, 0.0);
+        GtkSpinButton* spinner = GTK_SPIN_BUTTON(gtk_spin_button_new(adjustment, 0.0, digits));
+        gtk_widget_set_size_request(GTK_WIDGET(spinner), 80, -1);
+        g_signal_connect(G_OBJECT(spinner), "value-changed", G_CALLBACK(spinner_cb), nullptr);
+        return spinner;
+    }
+} // namespace preference::dir_cache_size
+
 namespace preference::thumbnail_show
 {
     void
@@ -683,6 +719,39 @@ namespace preference::thumbnail_max_size
     }
 } // namespace preference::thumbnail_max_size
 
+namespace preference::thumbnail_cache_size
+{
+    void
+    spinner_cb(GtkSpinButton* spinbutton, void* user_data)
+    {
+        (void)user_data;
+        const double value = gtk_spin_button_get_value(spinbutton);
+
+        // convert size from MiB to B
+        const u64 thumbnail_cache_size = static_cast<u64>(value) * 1024 * 1024;
+
+        if (app_settings.thumbnail_cache_size() != thumbnail_cache_size)
+        {
+            app_settings.thumbnail_cache_size(thumbnail_cache_size);
+            vfs::thumbnail_store::trim();
+        }
+    }
+
+    GtkSpinButton*
+    create_pref_spinner(double scale, double lower, double upper, double step_incr,
+                        double page_incr, i32 digits)
+    {
+        const double value = app_settings.thumbnail_cache_size() / scale;
+
+        GtkAdjustment* adjustment =
+            gtk_adjustment_new(value, lower, upper, step_incr, page_incr, 0.0);
+        GtkSpinButton* spinner = GTK_SPIN_BUTTON(gtk_spin_button_new(adjustment, 0.0, digits));
+        gtk_widget_set_size_request(GTK_WIDGET(spinner), 80, -1);
+        g_signal_connect(G_OBJECT(spinner), "value-changed", G_CALLBACK(spinner_cb), nullptr);
+        return spinner;
+    }
+} // namespace preference::thumbnail_cache_size
+
 /**
  * Interface Tab
  */
@@ -1126,6 +1195,11 @@ init_general_tab()
     page.add_row(
         GTK_WIDGET(preference::hover_selects::create_pref_check_button("Hovering Selects Files")));
 
+    page.add_row(
+        GTK_WIDGET(gtk_label_new("Closed Directory Cache (MiB)")),
+        GTK_WIDGET(
+            preference::dir_cache_size::create_pref_spinner(1024 * 1024, 0, 4096, 16, 64, 0)));
+
     page.new_section("Thumbnails");
 
     page.add_row(
@@ -1139,6 +1213,14 @@ init_general_tab()
         GTK_WIDGET(
             preference::thumbnail_max_size::create_pref_spinner(1024 * 1024, 0, 1024, 1, 10, 0)));
 
+    page.add_row(GTK_WIDGET(gtk_label_new("Thumbnail Memory (MiB)")),
+                 GTK_WIDGET(preference::thumbnail_cache_size::create_pref_spinner(1024 * 1024,
+                                                                                  16,
+                                                                                  4096,
+                                                                                  16,
+                                                                                  64,
+                                                                                  0)));
+
     page.add_row(
         GTK_WIDGET(preference::thumbnailer_api::create_pref_check_button("Thumbnailer use API")));
 
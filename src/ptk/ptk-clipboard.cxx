@@ -23,8 +23,12 @@
 #include <span>
 #include <vector>
 
+#include <optional>
+
 #include <memory>
 
+#include <functional>
+
 #include <glibmm.h>
 
 #include <ztd/ztd.hxx>
@@ -112,14 +116,20 @@ ptk_clipboard_cut_or_copy_file_list(const std::span<const std::string> sel_files
     ztd::logger::debug("TODO - PORT - GdkClipboard");
 }
 
-const std::vector<std::filesystem::path>
-ptk_clipboard_get_file_paths(const std::filesystem::path& cwd, bool* is_cut, i32* missing_targets)
+bool
+ptk_clipboard_has_files() noexcept
+{
+    ztd::logger::debug("TODO - PORT - GdkClipboard");
+    return false;
+}
+
+void
+ptk_clipboard_get_file_paths(const std::filesystem::path& cwd,
+                             const ptk_clipboard_file_paths_callback_t& callback)
 {
     (void)cwd;
-    (void)is_cut;
-    (void)missing_targets;
+    (void)callback;
     ztd::logger::debug("TODO - PORT - GdkClipboard");
-    return {};
 }
 
 #elif (GTK_MAJOR_VERSION == 3)
@@ -127,22 +137,48 @@ ptk_clipboard_get_file_paths(const std::filesystem::path& cwd, bool* is_cut, i32
 static GdkDragAction clipboard_action = GdkDragAction::GDK_ACTION_DEFAULT;
 static std::vector<std::filesystem::path> clipboard_file_list;
 
-static const std::vector<std::string>
-uri_list_extract_uris(const char* uri_list_str)
+/*
+ * Get the next uri from a text/uri-list, as defined in RFC 2483.
+ * Unlike g_uri_list_extract_uris() this does not build the whole
+ * list up front, so very large lists can be consumed in batches.
+ */
+static bool
+uri_list_next_uri(const std::string_view uri_list, usize& offset, std::string_view& uri)
 {
-    std::vector<std::string> uri_list;
+    while (offset < uri_list.size())
+    {
+        auto line_end = uri_list.find('\n', offset);
+        if (line_end == std::string_view::npos)
+        {
+            line_end = uri_list.size();
+        }
 
-    char** c_uri;
-    char** c_uri_list;
-    c_uri = c_uri_list = g_uri_list_extract_uris(uri_list_str);
+        auto line = uri_list.substr(offset, line_end - offset);
+        offset = line_end + 1;
 
-    for (; *c_uri; ++c_uri)
-    {
-        uri_list.emplace_back(*c_uri);
-    }
-    g_strfreev(c_uri_list);
+        // comments
+        if (line.starts_with('#'))
+        {
+            continue;
+        }
+
+        while (!line.empty() && g_ascii_isspace(line.front()))
+        {
+            line.remove_prefix(1);
+        }
+        while (!line.empty() && g_ascii_isspace(line.back()))
+        {
+            line.remove_suffix(1);
+        }
+        if (line.empty() || line.front() == '\0')
+        {
+            continue;
+        }
 
-    return uri_list;
+        uri = line;
+        return true;
+    }
+    return false;
 }
 
 static void
@@ -332,387 +368,431 @@ ptk_clipboard_cut_or_copy_file_list(const std::span<const std::string> sel_files
     clipboard_action = copy ? GdkDragAction::GDK_ACTION_COPY : GdkDragAction::GDK_ACTION_MOVE;
 }
 
-void
-ptk_clipboard_paste_files(GtkWindow* parent_win, const std::filesystem::path& dest_dir,
-                          GtkTreeView* task_view, GFunc callback, GtkWindow* callback_win)
+// Number of uris converted to paths per main loop iteration while pasting
+inline constexpr usize PASTE_BATCH_SIZE = 1024;
+
+struct paste_request
 {
-    GtkClipboard* clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
+    enum class mode
+    {
+        files,
+        links,
+        targets,
+        paths,
+    };
+
+    paste_request(mode req_mode, GtkWindow* parent_win, const std::filesystem::path& dest_dir,
+                  GtkTreeView* task_view, GFunc callback, GtkWindow* callback_win)
+        : req_mode(req_mode), parent_win(parent_win), dest_dir(dest_dir), task_view(task_view),
+          callback(callback), callback_win(callback_win)
+    {
+        // the clipboard owner can take a while to answer, the pointers are
+        // cleared if the widgets are finalized in the meantime
+        this->watch(this->parent_win, WATCH_PARENT_WIN);
+        this->watch(this->task_view, WATCH_TASK_VIEW);
+        this->watch(this->callback_win, WATCH_CALLBACK_WIN);
+    }
+
+    ~paste_request()
+    {
+        this->unwatch(this->parent_win);
+        this->unwatch(this->task_view);
+        this->unwatch(this->callback_win);
+    }
 
-    vfs::file_task::type action;
-    char* uri_list_str;
+    paste_request(const paste_request& other) = delete;
+    paste_request& operator=(const paste_request& other) = delete;
 
-    GdkAtom gnome_target = gdk_atom_intern("x-special/gnome-copied-files", false);
-    GtkSelectionData* sel_data = gtk_clipboard_wait_for_contents(clip, gnome_target);
-    if (sel_data)
+    // a widget that was passed in has been closed, the request is dropped
+    bool
+    widgets_gone() const noexcept
     {
-        if (gtk_selection_data_get_length(sel_data) <= 0 ||
-            gtk_selection_data_get_format(sel_data) != 8)
-        {
-            gtk_selection_data_free(sel_data);
-            return;
-        }
+        const auto gone = [this](void* widget, u8 flag)
+        {
+            return (this->watched & flag) &&
+                   (widget == nullptr || gtk_widget_in_destruction(GTK_WIDGET(widget)));
+        };
+        return gone(this->parent_win, WATCH_PARENT_WIN) ||
+               gone(this->task_view, WATCH_TASK_VIEW) ||
+               gone(this->callback_win, WATCH_CALLBACK_WIN);
+    }
 
-        uri_list_str = (char*)gtk_selection_data_get_data(sel_data);
-        if (ztd::startswith((const char*)gtk_selection_data_get_data(sel_data), "cut"))
-        {
-            action = vfs::file_task::type::move;
-        }
-        else
-        {
-            action = vfs::file_task::type::copy;
-        }
+    static constexpr u8 WATCH_PARENT_WIN = 0b001;
+    static constexpr u8 WATCH_TASK_VIEW = 0b010;
+    static constexpr u8 WATCH_CALLBACK_WIN = 0b100;
 
-        if (uri_list_str)
+    template<typename T>
+    void
+    watch(T*& widget, u8 flag) noexcept
+    {
+        if (widget)
         {
-            while (*uri_list_str && *uri_list_str != '\n')
-            {
-                ++uri_list_str;
-            }
+            g_object_add_weak_pointer(G_OBJECT(widget), (void**)&widget);
+            this->watched |= flag;
         }
     }
-    else
+
+    template<typename T>
+    static void
+    unwatch(T*& widget) noexcept
     {
-        GdkAtom uri_list_target = gdk_atom_intern("text/uri-list", false);
-        sel_data = gtk_clipboard_wait_for_contents(clip, uri_list_target);
-        if (!sel_data)
+        if (widget)
         {
-            return;
-        }
-        if (gtk_selection_data_get_length(sel_data) <= 0 ||
-            gtk_selection_data_get_format(sel_data) != 8)
-        {
-            gtk_selection_data_free(sel_data);
-            return;
+            g_object_remove_weak_pointer(G_OBJECT(widget), (void**)&widget);
         }
-        uri_list_str = (char*)gtk_selection_data_get_data(sel_data);
+    }
+
+    u8 watched{0};
+
+    mode req_mode;
+    GtkWindow* parent_win{nullptr};
+    std::filesystem::path dest_dir{};
+    GtkTreeView* task_view{nullptr};
+    GFunc callback{nullptr};
+    GtkWindow* callback_win{nullptr};
+
+    // mode::paths
+    ptk_clipboard_file_paths_callback_t paths_callback{nullptr};
+    std::vector<std::filesystem::path> paths{};
+
+    bool is_gnome_target{true};
+    bool is_cut{false};
+    vfs::file_task::type action{vfs::file_task::type::copy};
+
+    std::string uri_list{};
+    usize offset{0};
+    i32 missing_targets{0};
+
+    std::shared_ptr<vfs::file_task> task{nullptr};
+};
+
+static void paste_request_send(paste_request* req);
 
-        if (clipboard_action == GdkDragAction::GDK_ACTION_MOVE)
+/*
+ * Convert the next batch of uris into paths and start, or feed, the file task.
+ * Returns true once the whole uri list has been consumed.
+ */
+static bool
+paste_request_run_batch(paste_request* req)
+{
+    std::vector<std::filesystem::path> file_list;
+    file_list.reserve(PASTE_BATCH_SIZE);
+
+    std::string_view uri;
+    bool done = true;
+    while (uri_list_next_uri(req->uri_list, req->offset, uri))
+    {
+        std::filesystem::path file_path;
+        try
         {
-            action = vfs::file_task::type::move;
+            file_path = Glib::filename_from_uri(std::string(uri));
         }
-        else
+        catch (const Glib::ConvertError& e)
         {
-            action = vfs::file_task::type::copy;
+            continue;
         }
-    }
 
-    if (uri_list_str)
-    {
-        const std::vector<std::string> uri_list = uri_list_extract_uris(uri_list_str);
-        std::vector<std::filesystem::path> file_list;
-        file_list.reserve(uri_list.size());
-        for (const std::string_view uri : uri_list)
+        if (req->req_mode == paste_request::mode::targets)
         {
-            std::filesystem::path file_path;
-            try
-            {
-                file_path = Glib::filename_from_uri(uri.data());
+            if (std::filesystem::is_symlink(file_path))
+            { // canonicalize target
+                file_path = std::filesystem::read_symlink(file_path);
+            }
+
+            const auto file_stat = ztd::statx(file_path, ztd::statx::symlink::no_follow);
+            if (!file_stat)
+            { // need to see broken symlinks
+                req->missing_targets++;
+                continue;
             }
-            catch (const Glib::ConvertError& e)
+        }
+        else if (req->req_mode == paste_request::mode::paths)
+        {
+            if (!std::filesystem::exists(file_path))
             {
+                req->missing_targets++;
                 continue;
             }
-
-            file_list.emplace_back(file_path);
         }
 
-        /*
-         * If only one item is selected and the item is a
-         * directory, paste the files in that directory;
-         * otherwise, paste the file in current directory.
-         */
-
-        PtkFileTask* ptask = ptk_file_task_new(action,
-                                               file_list,
-                                               dest_dir,
-                                               parent_win ? GTK_WINDOW(parent_win) : nullptr,
-                                               GTK_WIDGET(task_view));
-        if (callback && callback_win)
+        file_list.emplace_back(file_path);
+        if (file_list.size() >= PASTE_BATCH_SIZE)
         {
-            ptk_file_task_set_complete_notify(ptask, callback, (void*)callback_win);
+            done = false;
+            break;
         }
-        ptk_file_task_run(ptask);
     }
-    gtk_selection_data_free(sel_data);
-}
-
-void
-ptk_clipboard_paste_links(GtkWindow* parent_win, const std::filesystem::path& dest_dir,
-                          GtkTreeView* task_view, GFunc callback, GtkWindow* callback_win)
-{
-    GtkClipboard* clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
 
-    vfs::file_task::type action;
-    char* uri_list_str;
+    if (req->req_mode == paste_request::mode::paths)
+    {
+        req->paths.insert(req->paths.end(), file_list.begin(), file_list.end());
+        return done;
+    }
 
-    GdkAtom gnome_target = gdk_atom_intern("x-special/gnome-copied-files", false);
-    GtkSelectionData* sel_data = gtk_clipboard_wait_for_contents(clip, gnome_target);
-    if (sel_data)
+    if (!req->task && !file_list.empty())
     {
-        if (gtk_selection_data_get_length(sel_data) <= 0 ||
-            gtk_selection_data_get_format(sel_data) != 8)
+        if (req->widgets_gone())
         {
-            gtk_selection_data_free(sel_data);
-            return;
+            // closed before the clipboard owner answered
+            return true;
         }
 
-        uri_list_str = (char*)gtk_selection_data_get_data(sel_data);
-        action = vfs::file_task::type::link;
-        if (uri_list_str)
-        {
-            while (*uri_list_str && *uri_list_str != '\n')
-            {
-                ++uri_list_str;
-            }
-        }
-    }
-    else
-    {
-        GdkAtom uri_list_target = gdk_atom_intern("text/uri-list", false);
-        sel_data = gtk_clipboard_wait_for_contents(clip, uri_list_target);
-        if (!sel_data)
+        PtkFileTask* ptask = ptk_file_task_new(req->action,
+                                               file_list,
+                                               req->dest_dir,
+                                               req->parent_win,
+                                               req->task_view ? GTK_WIDGET(req->task_view)
+                                                              : nullptr);
+        if (req->callback && req->callback_win)
         {
-            return;
+            ptk_file_task_set_complete_notify(ptask, req->callback, (void*)req->callback_win);
         }
-        if (gtk_selection_data_get_length(sel_data) <= 0 ||
-            gtk_selection_data_get_format(sel_data) != 8)
+        if (!done)
         {
-            gtk_selection_data_free(sel_data);
-            return;
+            // start working on the first batch while the rest is converted
+            ptask->task->set_src_paths_complete(false);
         }
-        uri_list_str = (char*)gtk_selection_data_get_data(sel_data);
-        action = vfs::file_task::type::link;
+        req->task = ptask->task;
+        ptk_file_task_run(ptask);
+    }
+    else if (req->task && !file_list.empty())
+    {
+        req->task->add_src_paths(file_list);
     }
 
-    if (uri_list_str)
+    if (done && req->task)
     {
-        const std::vector<std::string> uri_list = uri_list_extract_uris(uri_list_str);
-        std::vector<std::filesystem::path> file_list;
-        file_list.reserve(uri_list.size());
-        for (const std::string_view uri : uri_list)
-        {
-            std::filesystem::path file_path;
-            try
-            {
-                file_path = Glib::filename_from_uri(uri.data());
-            }
-            catch (const Glib::ConvertError& e)
-            {
-                continue;
-            }
+        req->task->set_src_paths_complete(true);
+    }
 
-            file_list.emplace_back(file_path);
-        }
+    return done;
+}
 
-        PtkFileTask* ptask = ptk_file_task_new(action,
-                                               file_list,
-                                               dest_dir,
-                                               parent_win ? GTK_WINDOW(parent_win) : nullptr,
-                                               task_view ? GTK_WIDGET(task_view) : nullptr);
-        if (callback && callback_win)
+static void
+paste_request_finish(paste_request* req)
+{
+    if (req->req_mode == paste_request::mode::paths)
+    {
+        if (req->paths_callback)
         {
-            ptk_file_task_set_complete_notify(ptask, callback, (void*)callback_win);
+            req->paths_callback(req->paths, req->is_cut, req->missing_targets);
         }
-        ptk_file_task_run(ptask);
     }
-    gtk_selection_data_free(sel_data);
+    else if (req->req_mode == paste_request::mode::targets && req->missing_targets > 0 &&
+             !req->widgets_gone())
+    {
+        ptk_show_error(req->parent_win,
+                       "Error",
+                       fmt::format("{} target{} missing",
+                                   req->missing_targets,
+                                   req->missing_targets > 1 ? "s are" : " is"));
+    }
+
+    delete req;
 }
 
-void
-ptk_clipboard_paste_targets(GtkWindow* parent_win, const std::filesystem::path& dest_dir,
-                            GtkTreeView* task_view, GFunc callback, GtkWindow* callback_win)
+static bool
+on_paste_request_idle(paste_request* req)
 {
-    GtkClipboard* clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
+    if (req->task && req->task->abort)
+    {
+        // the rest of the list is not converted for a cancelled task
+        req->task->set_src_paths_complete(true);
+        delete req;
+        return false;
+    }
 
-    vfs::file_task::type action;
-    char* uri_list_str;
+    if (!paste_request_run_batch(req))
+    {
+        return true;
+    }
 
-    GdkAtom gnome_target = gdk_atom_intern("x-special/gnome-copied-files", false);
-    GtkSelectionData* sel_data = gtk_clipboard_wait_for_contents(clip, gnome_target);
-    if (sel_data)
+    paste_request_finish(req);
+    return false;
+}
+
+static void
+on_paste_request_received(GtkClipboard* clipboard, GtkSelectionData* sel_data, void* user_data)
+{
+    (void)clipboard;
+    auto* req = static_cast<paste_request*>(user_data);
+
+    if (!sel_data || gtk_selection_data_get_length(sel_data) <= 0 ||
+        gtk_selection_data_get_format(sel_data) != 8)
     {
-        if (gtk_selection_data_get_length(sel_data) <= 0 ||
-            gtk_selection_data_get_format(sel_data) != 8)
+        if (req->is_gnome_target)
         {
-            gtk_selection_data_free(sel_data);
+            // owner does not provide gnome-copied-files, try text/uri-list
+            req->is_gnome_target = false;
+            paste_request_send(req);
             return;
         }
+        paste_request_finish(req);
+        return;
+    }
 
-        uri_list_str = (char*)gtk_selection_data_get_data(sel_data);
-        action = vfs::file_task::type::copy;
-        if (uri_list_str)
-        {
-            while (*uri_list_str && *uri_list_str != '\n')
-            {
-                ++uri_list_str;
-            }
-        }
+    const auto* data = (const char*)gtk_selection_data_get_data(sel_data);
+    req->uri_list = std::string(data, gtk_selection_data_get_length(sel_data));
+    req->offset = 0;
+
+    if (req->is_gnome_target)
+    {
+        req->is_cut = req->uri_list.starts_with("cut");
+
+        // skip the action line
+        const auto action_end = req->uri_list.find('\n');
+        req->offset = action_end == std::string::npos ? req->uri_list.size() : action_end + 1;
     }
     else
     {
-        GdkAtom uri_list_target = gdk_atom_intern("text/uri-list", false);
-        sel_data = gtk_clipboard_wait_for_contents(clip, uri_list_target);
-        if (!sel_data)
-        {
-            return;
-        }
-        if (gtk_selection_data_get_length(sel_data) <= 0 ||
-            gtk_selection_data_get_format(sel_data) != 8)
-        {
-            gtk_selection_data_free(sel_data);
-            return;
-        }
-
-        uri_list_str = (char*)gtk_selection_data_get_data(sel_data);
-        action = vfs::file_task::type::copy;
+        req->is_cut = (clipboard_action == GdkDragAction::GDK_ACTION_MOVE);
     }
 
-    if (uri_list_str)
+    switch (req->req_mode)
     {
-        i32 missing_targets = 0;
-
-        const std::vector<std::string> uri_list = uri_list_extract_uris(uri_list_str);
-        std::vector<std::filesystem::path> file_list;
-        file_list.reserve(uri_list.size());
-
-        for (const std::string_view uri : uri_list)
-        {
-            std::filesystem::path file_path;
-            try
-            {
-                file_path = Glib::filename_from_uri(uri.data());
-            }
-            catch (const Glib::ConvertError& e)
-            {
-                continue;
-            }
+        case paste_request::mode::files:
+            req->action = req->is_cut ? vfs::file_task::type::move : vfs::file_task::type::copy;
+            break;
+        case paste_request::mode::links:
+            req->action = vfs::file_task::type::link;
+            break;
+        case paste_request::mode::targets:
+        case paste_request::mode::paths:
+            req->action = vfs::file_task::type::copy;
+            break;
+    }
 
-            if (std::filesystem::is_symlink(file_path))
-            { // canonicalize target
-                file_path = std::filesystem::read_symlink(file_path);
-            }
+    if (paste_request_run_batch(req))
+    {
+        paste_request_finish(req);
+        return;
+    }
 
-            const auto file_stat = ztd::statx(file_path, ztd::statx::symlink::no_follow);
-            if (file_stat)
-            { // need to see broken symlinks
-                file_list.emplace_back(file_path);
-            }
-            else
-            {
-                missing_targets++;
-            }
-        }
+    // remaining batches are converted without blocking the main loop
+    g_idle_add((GSourceFunc)on_paste_request_idle, req);
+}
 
-        PtkFileTask* ptask = ptk_file_task_new(action,
-                                               file_list,
-                                               dest_dir,
-                                               parent_win ? GTK_WINDOW(parent_win) : nullptr,
-                                               GTK_WIDGET(task_view));
-        if (callback && callback_win)
-        {
-            ptk_file_task_set_complete_notify(ptask, callback, (void*)callback_win);
-        }
-        ptk_file_task_run(ptask);
+static void
+paste_request_send(paste_request* req)
+{
+    GtkClipboard* clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
 
-        if (missing_targets > 0)
-        {
-            ptk_show_error(parent_win ? GTK_WINDOW(parent_win) : nullptr,
-                           "Error",
-                           fmt::format("{} target{} missing",
-                                       missing_targets,
-                                       missing_targets > 1 ? "s are" : " is"));
-        }
+    GdkAtom target;
+    if (req->is_gnome_target)
+    {
+        target = gdk_atom_intern("x-special/gnome-copied-files", false);
+    }
+    else
+    {
+        target = gdk_atom_intern("text/uri-list", false);
     }
-    gtk_selection_data_free(sel_data);
+
+    gtk_clipboard_request_contents(clip, target, on_paste_request_received, req);
 }
 
-const std::vector<std::filesystem::path>
-ptk_clipboard_get_file_paths(const std::filesystem::path& cwd, bool* is_cut, i32* missing_targets)
+void
+ptk_clipboard_paste_files(GtkWindow* parent_win, const std::filesystem::path& dest_dir,
+                          GtkTreeView* task_view, GFunc callback, GtkWindow* callback_win)
 {
-    (void)cwd;
+    /*
+     * If only one item is selected and the item is a
+     * directory, paste the files in that directory;
+     * otherwise, paste the file in current directory.
+     */
+
+    auto* req = new paste_request(paste_request::mode::files,
+                                  parent_win,
+                                  dest_dir,
+                                  task_view,
+                                  callback,
+                                  callback_win);
+    paste_request_send(req);
+}
 
-    GtkClipboard* clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
+void
+ptk_clipboard_paste_links(GtkWindow* parent_win, const std::filesystem::path& dest_dir,
+                          GtkTreeView* task_view, GFunc callback, GtkWindow* callback_win)
+{
+    auto* req = new paste_request(paste_request::mode::links,
+                                  parent_win,
+                                  dest_dir,
+                                  task_view,
+                                  callback,
+                                  callback_win);
+    paste_request_send(req);
+}
 
-    char* uri_list_str;
-    std::vector<std::filesystem::path> file_list;
+void
+ptk_clipboard_paste_targets(GtkWindow* parent_win, const std::filesystem::path& dest_dir,
+                            GtkTreeView* task_view, GFunc callback, GtkWindow* callback_win)
+{
+    auto* req = new paste_request(paste_request::mode::targets,
+                                  parent_win,
+                                  dest_dir,
+                                  task_view,
+                                  callback,
+                                  callback_win);
+    paste_request_send(req);
+}
 
-    *is_cut = false;
-    *missing_targets = 0;
+// unknown until the owner answers, Paste stays enabled meanwhile,
+// pasting a clipboard without files does nothing
+static std::optional<bool> clipboard_has_files{std::nullopt};
+static bool clipboard_watched = false;
 
-    // get files from clip
-    GdkAtom gnome_target = gdk_atom_intern("x-special/gnome-copied-files", false);
-    GtkSelectionData* sel_data = gtk_clipboard_wait_for_contents(clip, gnome_target);
-    if (sel_data)
-    {
-        if (gtk_selection_data_get_length(sel_data) <= 0 ||
-            gtk_selection_data_get_format(sel_data) != 8)
-        {
-            gtk_selection_data_free(sel_data);
-            return file_list;
-        }
+static void
+on_clipboard_targets(GtkClipboard* clipboard, GdkAtom* atoms, i32 n_atoms, void* user_data)
+{
+    (void)clipboard;
+    (void)user_data;
 
-        uri_list_str = (char*)gtk_selection_data_get_data(sel_data);
-        *is_cut = (ztd::startswith((const char*)gtk_selection_data_get_data(sel_data), "cut"));
+    const GdkAtom gnome_target = gdk_atom_intern("x-special/gnome-copied-files", false);
+    const GdkAtom uri_target = gdk_atom_intern("text/uri-list", false);
 
-        if (uri_list_str)
-        {
-            while (*uri_list_str && *uri_list_str != '\n')
-            {
-                ++uri_list_str;
-            }
-        }
-    }
-    else
+    clipboard_has_files = false;
+    for (const GdkAtom atom : std::span(atoms, atoms ? n_atoms : 0))
     {
-        GdkAtom uri_list_target = gdk_atom_intern("text/uri-list", false);
-        sel_data = gtk_clipboard_wait_for_contents(clip, uri_list_target);
-        if (!sel_data)
-        {
-            return file_list;
-        }
-        if (gtk_selection_data_get_length(sel_data) <= 0 ||
-            gtk_selection_data_get_format(sel_data) != 8)
+        if (atom == gnome_target || atom == uri_target)
         {
-            gtk_selection_data_free(sel_data);
-            return file_list;
+            clipboard_has_files = true;
+            break;
         }
-        uri_list_str = (char*)gtk_selection_data_get_data(sel_data);
     }
+}
 
-    if (!uri_list_str)
-    {
-        gtk_selection_data_free(sel_data);
-        return file_list;
-    }
+static void
+on_clipboard_owner_change(GtkClipboard* clipboard, GdkEvent* event, void* user_data)
+{
+    (void)event;
+    (void)user_data;
+    clipboard_has_files = std::nullopt;
+    gtk_clipboard_request_targets(clipboard, on_clipboard_targets, nullptr);
+}
 
-    // create file list
-    const std::vector<std::string> uri_list = uri_list_extract_uris(uri_list_str);
-    file_list.reserve(uri_list.size());
-    for (const std::string_view uri : uri_list)
+bool
+ptk_clipboard_has_files() noexcept
+{
+    if (!clipboard_watched)
     {
-        std::string file_path;
-        try
-        {
-            file_path = Glib::filename_from_uri(uri.data());
-        }
-        catch (const Glib::ConvertError& e)
-        {
-            continue;
-        }
-
-        if (std::filesystem::exists(file_path))
-        {
-            file_list.emplace_back(file_path);
-        }
-        else
-        { // no *missing_targets++ here to avoid -Wunused-value compiler warning
-            *missing_targets = *missing_targets + 1;
-        }
+        // first call, the answer arrives asynchronously
+        clipboard_watched = true;
+        GtkClipboard* clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
+        // clang-format off
+        g_signal_connect(G_OBJECT(clip), "owner-change", G_CALLBACK(on_clipboard_owner_change), nullptr);
+        // clang-format on
+        gtk_clipboard_request_targets(clip, on_clipboard_targets, nullptr);
     }
+    return clipboard_has_files.value_or(true);
+}
 
-    gtk_selection_data_free(sel_data);
-
-    return file_list;
+void
+ptk_clipboard_get_file_paths(const std::filesystem::path& cwd,
+                             const ptk_clipboard_file_paths_callback_t& callback)
+{
+    auto* req =
+        new paste_request(paste_request::mode::paths, nullptr, cwd, nullptr, nullptr, nullptr);
+    req->paths_callback = callback;
+    paste_request_send(req);
 }
 
 #endif
@@ -26,6 +26,8 @@
 
 #include <memory>
 
+#include <functional>
+
 #include <gtkmm.h>
 #include <glibmm.h>
 
@@ -51,5 +53,15 @@ void ptk_clipboard_copy_text(const std::string_view text);
 
 void ptk_clipboard_cut_or_copy_file_list(const std::span<const std::string> sel_files, bool copy);
 
-const std::vector<std::filesystem::path>
-ptk_clipboard_get_file_paths(const std::filesystem::path& cwd, bool* is_cut, i32* missing_targets);
+using ptk_clipboard_file_paths_callback_t =
+    std::function<void(const std::vector<std::filesystem::path>& file_list, bool is_cut,
+                       i32 missing_targets)>;
+
+// Whether the clipboard holds files, from the targets last announced by the
+// clipboard owner. Never blocks, the state is refreshed on owner changes and
+// is true while the owner has not answered yet.
+bool ptk_clipboard_has_files() noexcept;
+
+// Asynchronous, callback is run once the clipboard owner has sent the file list
+void ptk_clipboard_get_file_paths(const std::filesystem::path& cwd,
+                                  const ptk_clipboard_file_paths_callback_t& callback);
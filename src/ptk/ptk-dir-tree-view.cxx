@@ -20,6 +20,8 @@
 
 #include <filesystem>
 
+#include <vector>
+
 #include <memory>
 
 #include <ztd/ztd.hxx>
@@ -44,6 +46,11 @@ static void on_dir_tree_view_row_expanded(GtkTreeView* treeview, GtkTreeIter* it
 static void on_dir_tree_view_row_collapsed(GtkTreeView* treeview, GtkTreeIter* iter,
                                            GtkTreePath* path, void* user_data);
 
+static void on_dir_tree_view_vadjustment_notify(GtkTreeView* treeview, GParamSpec* pspec,
+                                                void* user_data);
+
+static void queue_show_visible_rows(GtkTreeView* treeview);
+
 static bool on_dir_tree_view_button_press(GtkWidget* view, GdkEvent* event,
                                           PtkFileBrowser* browser);
 
@@ -180,6 +187,8 @@ ptk_dir_tree_view_new(PtkFileBrowser* browser, bool show_hidden)
 
     g_signal_connect_data(G_OBJECT(dir_tree_view), "row-collapsed", G_CALLBACK(on_dir_tree_view_row_collapsed), model, nullptr, G_CONNECT_AFTER);
 
+    g_signal_connect(G_OBJECT(dir_tree_view), "notify::vadjustment", G_CALLBACK(on_dir_tree_view_vadjustment_notify), nullptr);
+
     g_signal_connect(G_OBJECT(dir_tree_view), "button-press-event", G_CALLBACK(on_dir_tree_view_button_press), browser);
     g_signal_connect(G_OBJECT(dir_tree_view), "button-press-event", G_CALLBACK(on_dir_tree_view_button_press), browser);
     g_signal_connect(G_OBJECT(dir_tree_view), "key-press-event", G_CALLBACK(on_dir_tree_view_key_press), browser);
@@ -376,6 +385,9 @@ on_dir_tree_view_row_expanded(GtkTreeView* treeview, GtkTreeIter* iter, GtkTreeP
         gtk_tree_model_filter_convert_path_to_child_path(GTK_TREE_MODEL_FILTER(filter), path);
     ptk_dir_tree_expand_row(tree, &real_it, real_path);
     gtk_tree_path_free(real_path);
+
+    // the rows below moved, some may be offscreen now
+    queue_show_visible_rows(treeview);
 }
 
 static void
@@ -390,6 +402,113 @@ on_dir_tree_view_row_collapsed(GtkTreeView* treeview, GtkTreeIter* iter, GtkTree
         gtk_tree_model_filter_convert_path_to_child_path(GTK_TREE_MODEL_FILTER(filter), path);
     ptk_dir_tree_collapse_row(tree, &real_it, real_path);
     gtk_tree_path_free(real_path);
+
+    queue_show_visible_rows(treeview);
+}
+
+static bool
+next_visible_row(GtkTreeView* treeview, GtkTreeModel* model, GtkTreePath* path)
+{
+    GtkTreeIter it;
+    if (gtk_tree_view_row_expanded(treeview, path))
+    {
+        gtk_tree_path_down(path);
+        return gtk_tree_model_get_iter(model, &it, path);
+    }
+    while (true)
+    {
+        gtk_tree_path_next(path);
+        if (gtk_tree_model_get_iter(model, &it, path))
+        {
+            return true;
+        }
+        if (!gtk_tree_path_up(path) || gtk_tree_path_get_depth(path) == 0)
+        {
+            return false;
+        }
+    }
+}
+
+static void
+show_visible_rows(GtkTreeView* treeview)
+{
+    GtkTreePath* start;
+    GtkTreePath* end;
+    if (!gtk_tree_view_get_visible_range(treeview, &start, &end))
+    {
+        return;
+    }
+
+    GtkTreeModel* filter = gtk_tree_view_get_model(treeview);
+    PtkDirTree* tree =
+        PTK_DIR_TREE(gtk_tree_model_filter_get_model(GTK_TREE_MODEL_FILTER(filter)));
+
+    std::vector<GtkTreeIter> rows;
+    GtkTreePath* path = start;
+    do
+    {
+        GtkTreeIter it;
+        if (!gtk_tree_model_get_iter(filter, &it, path))
+        {
+            break;
+        }
+        GtkTreeIter real_it;
+        gtk_tree_model_filter_convert_iter_to_child_iter(GTK_TREE_MODEL_FILTER(filter),
+                                                         &real_it,
+                                                         &it);
+        rows.emplace_back(real_it);
+    } while (gtk_tree_path_compare(path, end) < 0 && next_visible_row(treeview, filter, path));
+
+    gtk_tree_path_free(start);
+    gtk_tree_path_free(end);
+
+    // keeps the directories on screen watched, so the others are dropped first
+    ptk_dir_tree_show_rows(tree, rows);
+}
+
+static void
+queue_show_visible_rows(GtkTreeView* treeview)
+{
+    if (g_object_get_data(G_OBJECT(treeview), "show_rows_pending"))
+    {
+        return;
+    }
+    g_object_set_data(G_OBJECT(treeview), "show_rows_pending", GINT_TO_POINTER(1));
+
+    // removed in on_destroy
+    g_timeout_add(
+        250,
+        [](void* user_data) -> gboolean
+        {
+            GtkTreeView* treeview = GTK_TREE_VIEW(user_data);
+            g_object_set_data(G_OBJECT(treeview), "show_rows_pending", nullptr);
+            show_visible_rows(treeview);
+            return G_SOURCE_REMOVE;
+        },
+        treeview);
+}
+
+static void
+on_dir_tree_view_scrolled(GtkAdjustment* adjustment, GtkTreeView* treeview)
+{
+    (void)adjustment;
+    queue_show_visible_rows(treeview);
+}
+
+static void
+on_dir_tree_view_vadjustment_notify(GtkTreeView* treeview, GParamSpec* pspec, void* user_data)
+{
+    (void)pspec;
+    (void)user_data;
+    GtkAdjustment* adjustment = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(treeview));
+    if (adjustment)
+    {
+        g_signal_connect_object(G_OBJECT(adjustment),
+                                "value-changed",
+                                G_CALLBACK(on_dir_tree_view_scrolled),
+                                treeview,
+                                GConnectFlags(0));
+    }
 }
 
 static bool
@@ -16,11 +16,14 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <string>
 #include <string_view>
 
 #include <filesystem>
 
 #include <map>
+#include <vector>
+#include <unordered_set>
 
 #include <ranges>
 #include <algorithm>
@@ -69,6 +72,13 @@ struct PtkDirTreeNode
     PtkDirTreeNode* children{nullptr};
     i32 n_children{0};
     std::shared_ptr<vfs::monitor> monitor{nullptr};
+    // directory mtime when the children were last read
+    i64 mtime{0};
+    u32 mtime_nsec{0};
+    // watch_clock value when the node was last expanded or shown
+    u64 last_used{0};
+    // tree->show_pass when the node was last expanded or shown
+    u64 shown_pass{0};
     i32 n_expand{0};
     PtkDirTreeNode* parent{nullptr};
     PtkDirTreeNode* next{nullptr};
@@ -79,10 +89,31 @@ struct PtkDirTreeNode
     void on_monitor_event(const vfs::monitor::event event, const std::filesystem::path& path);
 };
 
+// Only this many directories are watched. Among the nodes that are not on screen,
+// the one that was expanded or shown least recently loses its monitor first.
+// Expanded nodes on screen keep their monitor even past the limit, their number is
+// bounded by the height of the view. Collapsing a node releases the monitors of
+// its whole subtree. A node without a monitor is revalidated with a single mtime
+// check when it is expanded or shown again.
+inline constexpr usize MAX_WATCHED_NODES = 32;
+static std::vector<PtkDirTreeNode*> watched_nodes;
+static u64 watch_clock = 0;
+
+static void
+ptk_dir_tree_node_unwatch(PtkDirTreeNode* node)
+{
+    if (!node->monitor)
+    {
+        return;
+    }
+    node->monitor = nullptr;
+    std::erase(watched_nodes, node);
+}
+
 PtkDirTreeNode::~PtkDirTreeNode()
 {
     this->file = nullptr;
-    this->monitor = nullptr;
+    ptk_dir_tree_node_unwatch(this);
 
     std::vector<PtkDirTreeNode*> childs;
     for (PtkDirTreeNode* child = this->children; child; child = child->next)
@@ -784,6 +815,123 @@ ptk_dir_tree_delete_child(PtkDirTree* tree, PtkDirTreeNode* child)
     }
 }
 
+static void
+ptk_dir_tree_node_watch(PtkDirTreeNode* node, const std::filesystem::path& path)
+{
+    node->last_used = ++watch_clock;
+    node->shown_pass = node->tree->show_pass;
+    if (node->monitor)
+    {
+        return;
+    }
+
+    const auto is_offscreen = [](const PtkDirTreeNode* watched)
+    { return watched->shown_pass != watched->tree->show_pass; };
+    while (watched_nodes.size() >= MAX_WATCHED_NODES)
+    {
+        auto offscreen = watched_nodes | std::views::filter(is_offscreen);
+        const auto oldest = std::ranges::min_element(offscreen, {}, &PtkDirTreeNode::last_used);
+        if (oldest == offscreen.end())
+        {
+            break;
+        }
+        ptk_dir_tree_node_unwatch(*oldest);
+    }
+
+    node->monitor = vfs::monitor::create(path,
+                                         std::bind(&PtkDirTreeNode::on_monitor_event,
+                                                   node,
+                                                   std::placeholders::_1,
+                                                   std::placeholders::_2));
+    watched_nodes.emplace_back(node);
+}
+
+static void
+ptk_dir_tree_node_unwatch_all(PtkDirTreeNode* node)
+{
+    ptk_dir_tree_node_unwatch(node);
+    for (PtkDirTreeNode* child = node->children; child; child = child->next)
+    {
+        ptk_dir_tree_node_unwatch_all(child);
+    }
+}
+
+static bool
+ptk_dir_tree_node_update_mtime(PtkDirTreeNode* node, const std::filesystem::path& path)
+{
+    const auto stat = ztd::statx(path);
+    if (!stat)
+    {
+        return false;
+    }
+    const auto mtime = stat.mtime();
+    const bool changed = node->mtime != mtime.tv_sec || node->mtime_nsec != mtime.tv_nsec;
+    node->mtime = mtime.tv_sec;
+    node->mtime_nsec = mtime.tv_nsec;
+    return changed;
+}
+
+static void
+ptk_dir_tree_node_revalidate(PtkDirTree* tree, PtkDirTreeNode* node,
+                             const std::filesystem::path& path)
+{
+    // the directory was not watched, re-read it only if its entries changed
+    if (!ptk_dir_tree_node_update_mtime(node, path))
+    {
+        return;
+    }
+
+    std::unordered_set<std::string> names;
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(path, ec))
+    {
+        if (file.is_directory(ec))
+        {
+            names.insert(file.path().filename().string());
+        }
+    }
+
+    PtkDirTreeNode* next;
+    for (PtkDirTreeNode* child = node->children; child; child = next)
+    {
+        next = child->next;
+        if (child->file && !names.erase(child->file->name().data()))
+        {
+            ptk_dir_tree_delete_child(tree, child);
+        }
+    }
+
+    PtkDirTreeNode* place_holder =
+        (node->n_children == 1 && !node->children->file) ? node->children : nullptr;
+    for (const auto& name : names)
+    {
+        ptk_dir_tree_insert_child(tree, node, path / name, name);
+    }
+    if (place_holder && node->n_children > 1)
+    {
+        ptk_dir_tree_delete_child(tree, place_holder);
+    }
+}
+
+static void
+ptk_dir_tree_node_show(PtkDirTree* tree, PtkDirTreeNode* node)
+{
+    if (node->monitor)
+    {
+        node->last_used = ++watch_clock;
+        node->shown_pass = tree->show_pass;
+        return;
+    }
+
+    char* path = dir_path_from_tree_node(tree, node);
+    if (path && std::filesystem::is_directory(path))
+    {
+        ptk_dir_tree_node_revalidate(tree, node, path);
+        ptk_dir_tree_node_watch(node, path);
+    }
+    std::free(path);
+}
+
 void
 ptk_dir_tree_expand_row(PtkDirTree* tree, GtkTreeIter* iter, GtkTreePath* tree_path)
 {
@@ -793,6 +941,8 @@ ptk_dir_tree_expand_row(PtkDirTree* tree, GtkTreeIter* iter, GtkTreePath* tree_p
     ++node->n_expand;
     if (node->n_expand > 1 || node->n_children > 1)
     {
+        // children are still loaded, the monitor may be gone
+        ptk_dir_tree_node_show(tree, node);
         return;
     }
 
@@ -801,14 +951,8 @@ ptk_dir_tree_expand_row(PtkDirTree* tree, GtkTreeIter* iter, GtkTreePath* tree_p
 
     if (std::filesystem::is_directory(path))
     {
-        if (!node->monitor)
-        {
-            node->monitor = vfs::monitor::create(path,
-                                                 std::bind(&PtkDirTreeNode::on_monitor_event,
-                                                           node,
-                                                           std::placeholders::_1,
-                                                           std::placeholders::_2));
-        }
+        ptk_dir_tree_node_update_mtime(node, path);
+        ptk_dir_tree_node_watch(node, path);
 
         for (const auto& file : std::filesystem::directory_iterator(path))
         {
@@ -836,10 +980,18 @@ ptk_dir_tree_collapse_row(PtkDirTree* tree, GtkTreeIter* iter, GtkTreePath* path
     assert(node != nullptr);
     --node->n_expand;
 
+    if (node->n_expand > 0)
+    {
+        return;
+    }
+
+    // nothing in this subtree is visible any more
+    ptk_dir_tree_node_unwatch_all(node);
+
     /* cache nodes containing more than 128 children */
     /* FIXME: Is this useful? The nodes containing childrens
               with 128+ children are still not cached. */
-    if (node->n_children > 128 || node->n_expand > 0)
+    if (node->n_children > 128)
     {
         return;
     }
@@ -851,10 +1003,6 @@ ptk_dir_tree_collapse_row(PtkDirTree* tree, GtkTreeIter* iter, GtkTreePath* path
         {
             return;
         }
-        if (node->monitor)
-        {
-            node->monitor = nullptr;
-        }
         PtkDirTreeNode* child;
         PtkDirTreeNode* next;
         for (child = node->children; child; child = next)
@@ -865,6 +1013,37 @@ ptk_dir_tree_collapse_row(PtkDirTree* tree, GtkTreeIter* iter, GtkTreePath* path
     }
 }
 
+void
+ptk_dir_tree_show_rows(PtkDirTree* tree, const std::span<GtkTreeIter> iters)
+{
+    // a row is visible, so is the listing of its parent directory
+    std::vector<PtkDirTreeNode*> shown;
+    for (const GtkTreeIter& iter : iters)
+    {
+        PtkDirTreeNode* node = PTK_DIR_TREE_NODE(iter.user_data);
+        assert(node != nullptr);
+
+        PtkDirTreeNode* parent = node->parent;
+        if (parent && parent != tree->root && parent->n_expand > 0 &&
+            std::ranges::find(shown, parent) == shown.cend())
+        {
+            shown.emplace_back(parent);
+        }
+    }
+
+    // all of them are marked before any is watched, so watching one
+    // cannot take the monitor of another that is on screen
+    tree->show_pass += 1;
+    for (PtkDirTreeNode* node : shown)
+    {
+        node->shown_pass = tree->show_pass;
+    }
+    for (PtkDirTreeNode* node : shown)
+    {
+        ptk_dir_tree_node_show(tree, node);
+    }
+}
+
 char*
 ptk_dir_tree_get_dir_path(PtkDirTree* tree, GtkTreeIter* iter)
 {
@@ -889,6 +1068,13 @@ find_node(PtkDirTreeNode* parent, const std::string_view name)
 void
 PtkDirTreeNode::on_monitor_event(const vfs::monitor::event event, const std::filesystem::path& path)
 {
+    if (event == vfs::monitor::event::rescan)
+    {
+        // events were lost, the mtime still tells whether entries changed
+        ptk_dir_tree_node_revalidate(this->tree, this, path);
+        return;
+    }
+
     PtkDirTreeNode* child = find_node(this, path.filename().string());
 
     if (event == vfs::monitor::event::created)
@@ -906,7 +1092,7 @@ PtkDirTreeNode::on_monitor_event(const vfs::monitor::event event, const std::fil
             }
             if (std::filesystem::is_directory(path))
             {
-                ptk_dir_tree_insert_child(this->tree, this, path.parent_path(), path.filename());
+                ptk_dir_tree_insert_child(this->tree, this, path, path.filename());
                 if (child)
                 {
                     ptk_dir_tree_delete_child(this->tree, child);
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <span>
+
 #include <gtkmm.h>
 #include <glibmm.h>
 
@@ -47,6 +49,8 @@ struct PtkDirTree
     /* GtkSortType sort_order; */ /* I do not want to support this :-( */
     /* Random integer to check whether an iter belongs to our model */
     const i32 stamp{std::rand()};
+    // bumped by ptk_dir_tree_show_rows(), see ptk_dir_tree_node_watch()
+    u64 show_pass{0};
 };
 
 GType ptk_dir_tree_get_type();
@@ -57,4 +61,8 @@ void ptk_dir_tree_expand_row(PtkDirTree* tree, GtkTreeIter* iter, GtkTreePath* p
 
 void ptk_dir_tree_collapse_row(PtkDirTree* tree, GtkTreeIter* iter, GtkTreePath* path);
 
+// all rows on screen, keeps their directories watched or revalidates them.
+// directories that are not listed in any of them count as offscreen
+void ptk_dir_tree_show_rows(PtkDirTree* tree, const std::span<GtkTreeIter> iters);
+
 char* ptk_dir_tree_get_dir_path(PtkDirTree* tree, GtkTreeIter* iter);
@@ -0,0 +1,471 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <string_view>
+
+#include <fmt/core.h>
+
+#include <filesystem>
+
+#include <span>
+#include <array>
+#include <map>
+#include <vector>
+
+#include <memory>
+
+#include <gtkmm.h>
+
+#include <magic_enum.hpp>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "compat/gtk4-porting.hxx"
+
+#include "vfs/vfs-file.hxx"
+#include "vfs/vfs-bulk-rename.hxx"
+
+#include "ptk/ptk-dialog.hxx"
+#include "ptk/ptk-file-task.hxx"
+
+#include "ptk/ptk-file-actions-bulk-rename.hxx"
+
+enum class bulk_rename_column
+{
+    old_name,
+    new_name,
+    status,
+};
+
+struct BulkRenameDialog
+{
+    std::vector<std::filesystem::path> files{};
+    vfs::bulk_rename::plan plan{};
+
+    GtkWidget* dialog{nullptr};
+    GtkWidget* button_rename{nullptr};
+
+    GtkWidget* entry_find{nullptr};
+    GtkWidget* entry_replace{nullptr};
+    GtkWidget* check_regex{nullptr};
+    GtkWidget* check_ignore_case{nullptr};
+    GtkWidget* check_replace_ext{nullptr};
+
+    GtkWidget* combo_case{nullptr};
+    GtkWidget* check_case_ext{nullptr};
+
+    GtkWidget* check_counter{nullptr};
+    GtkWidget* entry_counter{nullptr};
+    GtkWidget* spin_start{nullptr};
+    GtkWidget* spin_step{nullptr};
+    GtkWidget* spin_width{nullptr};
+
+    GtkWidget* entry_ext_map{nullptr};
+    GtkWidget* check_ext_lower{nullptr};
+
+    GtkListStore* list_store{nullptr};
+    GtkLabel* label_status{nullptr};
+};
+
+static const std::string
+get_entry_text(GtkWidget* entry) noexcept
+{
+#if (GTK_MAJOR_VERSION == 4)
+    return gtk_editable_get_text(GTK_EDITABLE(entry));
+#elif (GTK_MAJOR_VERSION == 3)
+    return gtk_entry_get_text(GTK_ENTRY(entry));
+#endif
+}
+
+static bool
+get_check_active(GtkWidget* check) noexcept
+{
+    return gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(check));
+}
+
+// "jpeg=jpg, tiff=tif"
+static const std::map<std::string, std::string>
+parse_extension_map(const std::string_view text) noexcept
+{
+    std::map<std::string, std::string> mapping;
+    for (const auto& item : ztd::split(text, ","))
+    {
+        const auto pos = item.find('=');
+        if (pos == std::string::npos)
+        {
+            continue;
+        }
+
+        auto old_ext = ztd::strip(item.substr(0, pos));
+        auto new_ext = ztd::strip(item.substr(pos + 1));
+        if (old_ext.starts_with('.'))
+        {
+            old_ext = old_ext.substr(1);
+        }
+        if (new_ext.starts_with('.'))
+        {
+            new_ext = new_ext.substr(1);
+        }
+        if (!old_ext.empty() && !new_ext.empty())
+        {
+            mapping[old_ext] = new_ext;
+        }
+    }
+    return mapping;
+}
+
+static const std::vector<vfs::bulk_rename::rule>
+get_rules(BulkRenameDialog* data) noexcept
+{
+    std::vector<vfs::bulk_rename::rule> rules;
+
+    const auto find = get_entry_text(data->entry_find);
+    if (!find.empty())
+    {
+        rules.emplace_back(vfs::bulk_rename::replace_rule{
+            find,
+            get_entry_text(data->entry_replace),
+            get_check_active(data->check_regex),
+            get_check_active(data->check_ignore_case),
+            get_check_active(data->check_replace_ext),
+        });
+    }
+
+    const auto case_mode = gtk_combo_box_get_active(GTK_COMBO_BOX(data->combo_case));
+    if (case_mode > 0)
+    {
+        const auto mode = magic_enum::enum_cast<vfs::bulk_rename::case_rule::mode>(case_mode - 1);
+        if (mode.has_value())
+        {
+            rules.emplace_back(vfs::bulk_rename::case_rule{
+                mode.value(),
+                get_check_active(data->check_case_ext),
+            });
+        }
+    }
+
+    if (get_check_active(data->check_counter))
+    {
+        rules.emplace_back(vfs::bulk_rename::counter_rule{
+            get_entry_text(data->entry_counter),
+            u64(gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(data->spin_start))),
+            u64(gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(data->spin_step))),
+            u32(gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(data->spin_width))),
+        });
+    }
+
+    const auto mapping = parse_extension_map(get_entry_text(data->entry_ext_map));
+    const bool ext_lower = get_check_active(data->check_ext_lower);
+    if (!mapping.empty() || ext_lower)
+    {
+        rules.emplace_back(vfs::bulk_rename::extension_rule{mapping, ext_lower});
+    }
+
+    return rules;
+}
+
+static void
+on_rule_changed(GtkWidget* widget, BulkRenameDialog* data) noexcept
+{
+    (void)widget;
+
+    const auto rules = get_rules(data);
+    data->plan = vfs::bulk_rename::create_plan(data->files, rules);
+
+    gtk_list_store_clear(data->list_store);
+    usize changed = 0;
+    for (const auto& entry : data->plan.entries)
+    {
+        std::string_view status;
+        switch (entry.state)
+        {
+            case vfs::bulk_rename::entry::status::ok:
+                status = "";
+                changed += 1;
+                break;
+            case vfs::bulk_rename::entry::status::unchanged:
+                status = "Unchanged";
+                break;
+            case vfs::bulk_rename::entry::status::collision:
+                status = "Name collision";
+                break;
+            case vfs::bulk_rename::entry::status::invalid:
+                status = "Invalid name";
+                break;
+        }
+
+        GtkTreeIter iter;
+        gtk_list_store_append(data->list_store, &iter);
+        gtk_list_store_set(data->list_store,
+                           &iter,
+                           bulk_rename_column::old_name,
+                           entry.src.filename().c_str(),
+                           bulk_rename_column::new_name,
+                           entry.dest.filename().c_str(),
+                           bulk_rename_column::status,
+                           status.data(),
+                           -1);
+    }
+
+    std::string status;
+    if (data->plan.errors != 0)
+    {
+        status = fmt::format("{} of {} files cannot be renamed",
+                             data->plan.errors,
+                             data->plan.entries.size());
+    }
+    else
+    {
+        status = fmt::format("{} of {} files will be renamed", changed, data->plan.entries.size());
+    }
+    gtk_label_set_text(data->label_status, status.data());
+
+    gtk_widget_set_sensitive(data->button_rename,
+                             data->plan.is_valid() && data->plan.has_changes());
+}
+
+static GtkWidget*
+add_entry(GtkGrid* grid, const std::string_view label, i32 row, BulkRenameDialog* data) noexcept
+{
+    GtkWidget* label_widget = gtk_label_new_with_mnemonic(label.data());
+    gtk_widget_set_halign(label_widget, GtkAlign::GTK_ALIGN_START);
+    GtkWidget* entry = gtk_entry_new();
+    gtk_widget_set_hexpand(entry, true);
+    gtk_label_set_mnemonic_widget(GTK_LABEL(label_widget), entry);
+    gtk_grid_attach(grid, label_widget, 0, row, 1, 1);
+    gtk_grid_attach(grid, entry, 1, row, 4, 1);
+    g_signal_connect(G_OBJECT(entry), "changed", G_CALLBACK(on_rule_changed), data);
+    return entry;
+}
+
+static GtkWidget*
+add_check(GtkGrid* grid, const std::string_view label, i32 column, i32 row,
+          BulkRenameDialog* data) noexcept
+{
+    GtkWidget* check = gtk_check_button_new_with_mnemonic(label.data());
+    gtk_grid_attach(grid, check, column, row, 1, 1);
+    g_signal_connect(G_OBJECT(check), "toggled", G_CALLBACK(on_rule_changed), data);
+    return check;
+}
+
+static GtkWidget*
+add_spin(GtkGrid* grid, const std::string_view label, f64 min, f64 max, f64 value, i32 column,
+         i32 row, BulkRenameDialog* data) noexcept
+{
+    GtkWidget* box = gtk_box_new(GtkOrientation::GTK_ORIENTATION_HORIZONTAL, 5);
+    GtkWidget* spin = gtk_spin_button_new_with_range(min, max, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(spin), value);
+    gtk_box_pack_start(GTK_BOX(box), gtk_label_new(label.data()), false, false, 0);
+    gtk_box_pack_start(GTK_BOX(box), spin, false, false, 0);
+    gtk_grid_attach(grid, box, column, row, 1, 1);
+    g_signal_connect(G_OBJECT(spin), "value-changed", G_CALLBACK(on_rule_changed), data);
+    return spin;
+}
+
+void
+ptk_bulk_rename_files(PtkFileBrowser* file_browser, const std::filesystem::path& cwd,
+                      const std::span<const std::shared_ptr<vfs::file>> selected_files)
+{
+    if (selected_files.empty())
+    {
+        ztd::logger::warn("Trying to rename an empty file list");
+        return;
+    }
+
+    GtkWidget* parent = nullptr;
+    GtkWidget* task_view = nullptr;
+    if (file_browser)
+    {
+#if (GTK_MAJOR_VERSION == 4)
+        parent = GTK_WIDGET(gtk_widget_get_root(GTK_WIDGET(file_browser)));
+#elif (GTK_MAJOR_VERSION == 3)
+        parent = gtk_widget_get_toplevel(GTK_WIDGET(file_browser));
+#endif
+        task_view = file_browser->task_view();
+    }
+
+    const auto data = std::make_unique<BulkRenameDialog>();
+    data->files.reserve(selected_files.size());
+    for (const auto& file : selected_files)
+    {
+        data->files.emplace_back(file->path());
+    }
+
+    data->dialog =
+        gtk_dialog_new_with_buttons("Rename Files",
+                                    parent ? GTK_WINDOW(parent) : nullptr,
+                                    GtkDialogFlags(GtkDialogFlags::GTK_DIALOG_MODAL |
+                                                   GtkDialogFlags::GTK_DIALOG_DESTROY_WITH_PARENT),
+                                    "Cancel",
+                                    GtkResponseType::GTK_RESPONSE_CANCEL,
+                                    nullptr);
+    data->button_rename = gtk_dialog_add_button(GTK_DIALOG(data->dialog),
+                                                "_Rename",
+                                                GtkResponseType::GTK_RESPONSE_ACCEPT);
+    gtk_dialog_set_default_response(GTK_DIALOG(data->dialog),
+                                    GtkResponseType::GTK_RESPONSE_ACCEPT);
+
+    gtk_widget_set_size_request(GTK_WIDGET(data->dialog), 800, 600);
+    gtk_window_set_resizable(GTK_WINDOW(data->dialog), true);
+#if (GTK_MAJOR_VERSION == 3)
+    gtk_window_set_type_hint(GTK_WINDOW(data->dialog),
+                             GdkWindowTypeHint::GDK_WINDOW_TYPE_HINT_DIALOG);
+#endif
+
+    GtkBox* content_area = GTK_BOX(gtk_dialog_get_content_area(GTK_DIALOG(data->dialog)));
+    GtkBox* box = GTK_BOX(gtk_box_new(GtkOrientation::GTK_ORIENTATION_VERTICAL, 5));
+    gtk_widget_set_margin_start(GTK_WIDGET(box), 5);
+    gtk_widget_set_margin_end(GTK_WIDGET(box), 5);
+    gtk_widget_set_margin_top(GTK_WIDGET(box), 5);
+    gtk_widget_set_margin_bottom(GTK_WIDGET(box), 5);
+#if (GTK_MAJOR_VERSION == 4)
+    gtk_box_prepend(GTK_BOX(content_area), GTK_WIDGET(box));
+#elif (GTK_MAJOR_VERSION == 3)
+    gtk_container_add(GTK_CONTAINER(content_area), GTK_WIDGET(box));
+#endif
+
+    GtkGrid* grid = GTK_GRID(gtk_grid_new());
+    gtk_grid_set_row_spacing(grid, 5);
+    gtk_grid_set_column_spacing(grid, 5);
+
+    // Replace
+    data->entry_find = add_entry(grid, "_Find:", 0, data.get());
+    data->entry_replace = add_entry(grid, "Re_place:", 1, data.get());
+    data->check_regex = add_check(grid, "Regular e_xpression", 1, 2, data.get());
+    data->check_ignore_case = add_check(grid, "_Ignore case", 2, 2, data.get());
+    data->check_replace_ext = add_check(grid, "Include _extension", 3, 2, data.get());
+
+    // Case
+    GtkWidget* label_case = gtk_label_new_with_mnemonic("_Case:");
+    gtk_widget_set_halign(label_case, GtkAlign::GTK_ALIGN_START);
+    data->combo_case = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(data->combo_case), "Unchanged");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(data->combo_case), "lowercase");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(data->combo_case), "UPPERCASE");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(data->combo_case), "Title Case");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(data->combo_case), 0);
+    gtk_label_set_mnemonic_widget(GTK_LABEL(label_case), data->combo_case);
+    gtk_grid_attach(grid, label_case, 0, 3, 1, 1);
+    gtk_grid_attach(grid, data->combo_case, 1, 3, 1, 1);
+    // clang-format off
+    g_signal_connect(G_OBJECT(data->combo_case), "changed", G_CALLBACK(on_rule_changed), data.get());
+    // clang-format on
+    data->check_case_ext = add_check(grid, "Inclu_de extension", 2, 3, data.get());
+
+    // Counter, '*' is the name and '#' the counter
+    data->check_counter = add_check(grid, "_Number:", 0, 4, data.get());
+    data->entry_counter = gtk_entry_new();
+#if (GTK_MAJOR_VERSION == 4)
+    gtk_editable_set_text(GTK_EDITABLE(data->entry_counter), "*_#");
+#elif (GTK_MAJOR_VERSION == 3)
+    gtk_entry_set_text(GTK_ENTRY(data->entry_counter), "*_#");
+#endif
+    gtk_widget_set_tooltip_text(data->entry_counter,
+                                "'*' is replaced by the name, '#' by the number");
+    gtk_grid_attach(grid, data->entry_counter, 1, 4, 1, 1);
+    // clang-format off
+    g_signal_connect(G_OBJECT(data->entry_counter), "changed", G_CALLBACK(on_rule_changed), data.get());
+    // clang-format on
+    data->spin_start = add_spin(grid, "Start:", 0, 999999999, 1, 2, 4, data.get());
+    data->spin_step = add_spin(grid, "Step:", 1, 999999, 1, 3, 4, data.get());
+    data->spin_width = add_spin(grid, "Digits:", 1, 12, 1, 4, 4, data.get());
+
+    // Extension
+    data->entry_ext_map = add_entry(grid, "Ex_tensions:", 5, data.get());
+    gtk_widget_set_tooltip_text(data->entry_ext_map, "Map extensions, e.g. jpeg=jpg, tiff=tif");
+    data->check_ext_lower = add_check(grid, "_Lowercase extensions", 1, 6, data.get());
+
+    gtk_box_pack_start(box, GTK_WIDGET(grid), false, false, 0);
+
+    // Preview
+    data->list_store = gtk_list_store_new(magic_enum::enum_count<bulk_rename_column>(),
+                                          G_TYPE_STRING,
+                                          G_TYPE_STRING,
+                                          G_TYPE_STRING);
+
+    GtkWidget* tree_view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(data->list_store));
+    GtkTreeSelection* selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(tree_view));
+    gtk_tree_selection_set_mode(selection, GtkSelectionMode::GTK_SELECTION_NONE);
+
+    const std::array<std::pair<bulk_rename_column, std::string_view>, 3> columns{{
+        {bulk_rename_column::old_name, "Name"},
+        {bulk_rename_column::new_name, "New Name"},
+        {bulk_rename_column::status, "Status"},
+    }};
+    for (const auto& [col, title] : columns)
+    {
+        GtkCellRenderer* cell_renderer = gtk_cell_renderer_text_new();
+        GtkTreeViewColumn* column =
+            gtk_tree_view_column_new_with_attributes(title.data(),
+                                                     cell_renderer,
+                                                     "text",
+                                                     magic_enum::enum_integer(col),
+                                                     nullptr);
+        gtk_tree_view_column_set_resizable(column, true);
+        gtk_tree_view_column_set_expand(column, col != bulk_rename_column::status);
+        gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view), column);
+    }
+
+    GtkScrolledWindow* scrolled_window =
+        GTK_SCROLLED_WINDOW(gtk_scrolled_window_new(nullptr, nullptr));
+    gtk_scrolled_window_set_policy(scrolled_window, GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_widget_set_hexpand(GTK_WIDGET(scrolled_window), true);
+    gtk_widget_set_vexpand(GTK_WIDGET(scrolled_window), true);
+    gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled_window), GTK_WIDGET(tree_view));
+    gtk_box_pack_start(box, GTK_WIDGET(scrolled_window), true, true, 0);
+
+    data->label_status = GTK_LABEL(gtk_label_new(nullptr));
+    gtk_widget_set_halign(GTK_WIDGET(data->label_status), GtkAlign::GTK_ALIGN_START);
+    gtk_box_pack_start(box, GTK_WIDGET(data->label_status), false, false, 0);
+
+    on_rule_changed(nullptr, data.get());
+
+    gtk_widget_show_all(GTK_WIDGET(data->dialog));
+    gtk_widget_grab_focus(data->entry_find);
+
+    const auto response = gtk4_dialog_run(GTK_DIALOG(data->dialog));
+    if (response == GtkResponseType::GTK_RESPONSE_ACCEPT)
+    {
+        // the filesystem may have changed while the dialog was open
+        on_rule_changed(nullptr, data.get());
+    }
+    gtk_widget_destroy(data->dialog);
+    g_object_unref(data->list_store);
+
+    if (response != GtkResponseType::GTK_RESPONSE_ACCEPT || !data->plan.has_changes())
+    {
+        return;
+    }
+
+    if (!data->plan.is_valid())
+    {
+        ptk_show_error(parent ? GTK_WINDOW(parent) : nullptr,
+                       "Rename Error",
+                       fmt::format("{} files cannot be renamed, nothing was changed",
+                                   data->plan.errors));
+        return;
+    }
+
+    // all selected files are in cwd, the task uses it as the destination directory
+    PtkFileTask* ptask = ptk_file_task_new(vfs::file_task::type::rename,
+                                           data->plan.src_paths,
+                                           cwd,
+                                           parent ? GTK_WINDOW(parent) : nullptr,
+                                           task_view);
+    ptask->task->rename_dest_paths = data->plan.dest_paths;
+    ptk_file_task_run(ptask);
+}
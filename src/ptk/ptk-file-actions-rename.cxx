@@ -53,6 +53,7 @@
 #include "vfs/vfs-file.hxx"
 #include "vfs/vfs-user-dirs.hxx"
 #include "vfs/vfs-utils.hxx"
+#include "vfs/vfs-unique-name.hxx"
 
 #include "settings.hxx"
 
@@ -2115,37 +2116,8 @@ on_label_button_press(GtkWidget* widget, GdkEvent* event, const std::shared_ptr<
 static const std::filesystem::path
 get_unique_name(const std::filesystem::path& dir, const std::string_view ext = "")
 {
-    const std::string base = "new";
-
-    std::filesystem::path path;
-
-    if (ext.empty())
-    {
-        path = dir / base;
-    }
-    else
-    {
-        const std::string name = fmt::format("{}.{}", base, ext);
-        path = dir / name;
-    }
-
-    u32 n = 1;
-    while (ztd::statx(path, ztd::statx::symlink::no_follow)) // need to see broken symlinks
-    {
-        std::string name;
-        if (ext.empty())
-        {
-            name = fmt::format("{}{}", base, ++n);
-        }
-        else
-        {
-            name = fmt::format("{}{}.{}", base, ++n, ext);
-        }
-
-        path = dir / name;
-    }
-
-    return path;
+    // only a suggestion, the user can still change it
+    return vfs::unique_name::get(dir, "new", ext, vfs::unique_name::style::number, false);
 }
 
 static const std::optional<std::filesystem::path>
@@ -3367,46 +3339,74 @@ ptk_file_misc_paste_as(PtkFileBrowser* file_browser, const std::filesystem::path
                        GFunc callback)
 {
     (void)callback;
-    bool is_cut = false;
-    i32 missing_targets;
 
-    const std::vector<std::filesystem::path> files =
-        ptk_clipboard_get_file_paths(cwd, &is_cut, &missing_targets);
+    // the clipboard owner can take a while to answer, the tab can be closed meanwhile
+    const bool has_browser = file_browser != nullptr;
+    const std::shared_ptr<GWeakRef> browser_ref(new GWeakRef,
+                                                [](GWeakRef* ref)
+                                                {
+                                                    g_weak_ref_clear(ref);
+                                                    delete ref;
+                                                });
+    g_weak_ref_init(browser_ref.get(), file_browser);
 
-    for (const auto& file_path : files)
+    const auto on_file_paths = [has_browser, browser_ref, cwd](
+                                   const std::vector<std::filesystem::path>& files,
+                                   bool is_cut,
+                                   i32 missing_targets)
     {
-        const auto file = vfs::file::create(file_path);
-        const std::string file_dir = std::filesystem::path(file_path).parent_path();
+        auto* file_browser = static_cast<PtkFileBrowser*>(g_weak_ref_get(browser_ref.get()));
+        if (has_browser && (!file_browser || gtk_widget_in_destruction(GTK_WIDGET(file_browser))))
+        {
+            if (file_browser)
+            {
+                g_object_unref(file_browser);
+            }
+            return;
+        }
 
-        if (!ptk_rename_file(file_browser,
-                             file_dir.data(),
-                             file,
-                             cwd.c_str(),
-                             !is_cut,
-                             ptk::rename_mode::rename,
-                             nullptr))
+        for (const auto& file_path : files)
         {
-            missing_targets = 0;
-            break;
+            const auto file = vfs::file::create(file_path);
+            const std::string file_dir = std::filesystem::path(file_path).parent_path();
+
+            if (!ptk_rename_file(file_browser,
+                                 file_dir.data(),
+                                 file,
+                                 cwd.c_str(),
+                                 !is_cut,
+                                 ptk::rename_mode::rename,
+                                 nullptr))
+            {
+                missing_targets = 0;
+                break;
+            }
         }
-    }
 
-    if (missing_targets > 0)
-    {
-        GtkWidget* parent = nullptr;
-        if (file_browser)
+        if (missing_targets > 0)
         {
+            GtkWidget* parent = nullptr;
+            if (file_browser)
+            {
 #if (GTK_MAJOR_VERSION == 4)
-            parent = GTK_WIDGET(gtk_widget_get_root(GTK_WIDGET(file_browser)));
+                parent = GTK_WIDGET(gtk_widget_get_root(GTK_WIDGET(file_browser)));
 #elif (GTK_MAJOR_VERSION == 3)
-            parent = gtk_widget_get_toplevel(GTK_WIDGET(file_browser));
+                parent = gtk_widget_get_toplevel(GTK_WIDGET(file_browser));
 #endif
+            }
+
+            ptk_show_error(GTK_WINDOW(parent),
+                           "Error",
+                           fmt::format("{} target{} missing",
+                                       missing_targets,
+                                       missing_targets > 1 ? "s are" : " is"));
         }
 
-        ptk_show_error(GTK_WINDOW(parent),
-                       "Error",
-                       fmt::format("{} target{} missing",
-                                   missing_targets,
-                                   missing_targets > 1 ? "s are" : " is"));
-    }
+        if (file_browser)
+        {
+            g_object_unref(file_browser);
+        }
+    };
+
+    ptk_clipboard_get_file_paths(cwd, on_file_paths);
 }
@@ -35,8 +35,6 @@
 
 #include <cassert>
 
-#include <malloc.h>
-
 #include <fmt/format.h>
 
 #include <gtkmm.h>
@@ -58,6 +56,7 @@
 #include "ptk/ptk-dialog.hxx"
 
 #include "ptk/ptk-file-actions-open.hxx"
+#include "ptk/ptk-file-actions-bulk-rename.hxx"
 #include "ptk/ptk-file-actions-rename.hxx"
 
 #include "ptk/ptk-bookmark-view.hxx"
@@ -77,7 +76,11 @@
 
 #include "vfs/vfs-user-dirs.hxx"
 #include "vfs/vfs-dir.hxx"
+#include "vfs/vfs-dir-compare.hxx"
+#include "vfs/vfs-dir-prefetch.hxx"
 #include "vfs/vfs-file.hxx"
+#include "vfs/vfs-name-filter.hxx"
+#include "vfs/vfs-thumbnail-store.hxx"
 
 #include "settings/app.hxx"
 
@@ -170,6 +173,9 @@ static void rebuild_side_toolbox(GtkWidget* widget, PtkFileBrowser* file_browser
 static u32 folder_view_auto_scroll_timer = 0;
 static GtkDirectionType folder_view_auto_scroll_direction = GtkDirectionType::GTK_DIR_TAB_FORWARD;
 
+// browser whose dirs are queued in vfs::dir_prefetch
+static const PtkFileBrowser* prefetch_owner = nullptr;
+
 /*  Drag & Drop/Clipboard targets  */
 static GtkTargetEntry drag_targets[] = {{ztd::strdup("text/uri-list"), 0, 0}};
 
@@ -922,12 +928,101 @@ on_status_bar_popup(GtkWidget* widget, GtkWidget* menu, PtkFileBrowser* file_bro
     gtk_widget_show_all(GTK_WIDGET(menu));
 }
 
+static void
+on_filter_bar_changed(GtkEditable* editable, PtkFileBrowser* file_browser)
+{
+#if (GTK_MAJOR_VERSION == 4)
+    const std::string text = gtk_editable_get_text(editable);
+#elif (GTK_MAJOR_VERSION == 3)
+    const std::string text = gtk_entry_get_text(GTK_ENTRY(editable));
+#endif
+
+    file_browser->set_filter(text);
+}
+
+static void
+on_filter_bar_activate(GtkEntry* entry, PtkFileBrowser* file_browser)
+{
+    (void)entry;
+    file_browser->focus_folder_view();
+}
+
+static void
+on_filter_bar_stop(GtkSearchEntry* entry, PtkFileBrowser* file_browser)
+{
+    (void)entry;
+    file_browser->hide_filter_bar();
+}
+
+static void
+on_file_browser_map(GtkWidget* widget, PtkFileBrowser* file_browser)
+{
+    (void)widget;
+    // a notebook only maps its current page, this is the first time a deferred tab is shown
+    file_browser->materialize();
+}
+
+static void
+touch_visible_thumbnails(PtkFileBrowser* file_browser) noexcept
+{
+    if (!file_browser->folder_view_ || !file_browser->file_list_)
+    {
+        return;
+    }
+
+    GtkTreePath* start = nullptr;
+    GtkTreePath* end = nullptr;
+    bool visible = false;
+    switch (file_browser->view_mode_)
+    {
+        case ptk::file_browser::view_mode::icon_view:
+        case ptk::file_browser::view_mode::compact_view:
+            visible = exo_icon_view_get_visible_range(EXO_ICON_VIEW(file_browser->folder_view_),
+                                                      &start,
+                                                      &end);
+            break;
+        case ptk::file_browser::view_mode::list_view:
+            visible = gtk_tree_view_get_visible_range(GTK_TREE_VIEW(file_browser->folder_view_),
+                                                      &start,
+                                                      &end);
+            break;
+    }
+    if (!visible)
+    {
+        return;
+    }
+
+    // the file list is flat, so the rows in between are reached with iter_next
+    GtkTreeModel* model = file_browser->file_list_;
+    const i32 count = gtk_tree_path_get_indices(end)[0] - gtk_tree_path_get_indices(start)[0];
+    GtkTreeIter it;
+    bool valid = gtk_tree_model_get_iter(model, &it, start);
+    for (i32 row = 0; valid && row <= count; ++row)
+    {
+        std::shared_ptr<vfs::file> file;
+        gtk_tree_model_get(model, &it, ptk::file_list::column::info, &file, -1);
+        if (file)
+        {
+            vfs::thumbnail_store::touch(file.get(), true);
+            vfs::thumbnail_store::touch(file.get(), false);
+        }
+        valid = gtk_tree_model_iter_next(model, &it);
+    }
+    gtk_tree_path_free(start);
+    gtk_tree_path_free(end);
+}
+
 static void
 ptk_file_browser_init(PtkFileBrowser* file_browser)
 {
     gtk_orientable_set_orientation(GTK_ORIENTABLE(file_browser),
                                    GtkOrientation::GTK_ORIENTATION_VERTICAL);
 
+    // rows on screen keep their thumbnails when the thumbnail store trims
+    vfs::thumbnail_store::add_visible_callback(
+        file_browser,
+        [file_browser] { touch_visible_thumbnails(file_browser); });
+
     file_browser->panel_ = 0; // do not load font yet in ptk_path_entry_new
     file_browser->path_bar_ = ptk_path_entry_new(file_browser);
 
@@ -941,6 +1036,21 @@ ptk_file_browser_init(PtkFileBrowser* file_browser)
     file_browser->toolbox_ = GTK_BOX(gtk_box_new(GtkOrientation::GTK_ORIENTATION_HORIZONTAL, 0));
     gtk_box_pack_start(GTK_BOX(file_browser), GTK_WIDGET(file_browser->toolbox_), false, false, 0);
 
+    // quick filter, hidden until used
+    file_browser->filter_bar_ = GTK_ENTRY(gtk_search_entry_new());
+    gtk_entry_set_placeholder_text(file_browser->filter_bar_, "Filter");
+    gtk_widget_set_no_show_all(GTK_WIDGET(file_browser->filter_bar_), true);
+    gtk_box_pack_start(GTK_BOX(file_browser), GTK_WIDGET(file_browser->filter_bar_), false, false, 0);
+
+    // clang-format off
+    g_signal_connect(G_OBJECT(file_browser->filter_bar_), "changed", G_CALLBACK(on_filter_bar_changed), file_browser);
+    g_signal_connect(G_OBJECT(file_browser->filter_bar_), "activate", G_CALLBACK(on_filter_bar_activate), file_browser);
+    g_signal_connect(G_OBJECT(file_browser->filter_bar_), "stop-search", G_CALLBACK(on_filter_bar_stop), file_browser);
+    // clang-format on
+
+    // start tracking clipboard targets so the file menu can check them without blocking
+    (void)ptk_clipboard_has_files();
+
     // lists area
     file_browser->hpane = GTK_PANED(gtk_paned_new(GtkOrientation::GTK_ORIENTATION_HORIZONTAL));
     file_browser->side_vbox = GTK_BOX(gtk_box_new(GtkOrientation::GTK_ORIENTATION_VERTICAL, 0));
@@ -948,7 +1058,58 @@ ptk_file_browser_init(PtkFileBrowser* file_browser)
     file_browser->folder_view_scroll_ =
         GTK_SCROLLED_WINDOW(gtk_scrolled_window_new(nullptr, nullptr));
     gtk_paned_pack1(file_browser->hpane, GTK_WIDGET(file_browser->side_vbox), false, false);
-    gtk_paned_pack2(file_browser->hpane, GTK_WIDGET(file_browser->folder_view_scroll_), true, true);
+
+    // preview, hidden unless enabled
+    file_browser->preview_pane_ =
+        GTK_PANED(gtk_paned_new(GtkOrientation::GTK_ORIENTATION_HORIZONTAL));
+    file_browser->preview_box_ = GTK_BOX(gtk_box_new(GtkOrientation::GTK_ORIENTATION_VERTICAL, 4));
+    gtk_widget_set_size_request(GTK_WIDGET(file_browser->preview_box_), 200, -1);
+    gtk_widget_set_no_show_all(GTK_WIDGET(file_browser->preview_box_), true);
+    file_browser->preview_image_ = GTK_IMAGE(gtk_image_new());
+    file_browser->preview_label_ = GTK_LABEL(gtk_label_new(nullptr));
+#if (GTK_MAJOR_VERSION == 4)
+    gtk_label_set_wrap(file_browser->preview_label_, true);
+#elif (GTK_MAJOR_VERSION == 3)
+    gtk_label_set_line_wrap(file_browser->preview_label_, true);
+#endif
+    gtk_label_set_selectable(file_browser->preview_label_, true);
+    gtk_label_set_xalign(file_browser->preview_label_, 0.0);
+    file_browser->preview_text_ = GTK_TEXT_VIEW(gtk_text_view_new());
+    gtk_text_view_set_editable(file_browser->preview_text_, false);
+    gtk_text_view_set_cursor_visible(file_browser->preview_text_, false);
+    gtk_text_view_set_monospace(file_browser->preview_text_, true);
+    gtk_text_view_set_wrap_mode(file_browser->preview_text_, GtkWrapMode::GTK_WRAP_CHAR);
+    file_browser->preview_text_scroll_ =
+        GTK_SCROLLED_WINDOW(gtk_scrolled_window_new(nullptr, nullptr));
+    gtk_scrolled_window_set_child(file_browser->preview_text_scroll_,
+                                  GTK_WIDGET(file_browser->preview_text_));
+    gtk_box_pack_start(file_browser->preview_box_,
+                       GTK_WIDGET(file_browser->preview_image_),
+                       false,
+                       false,
+                       0);
+    gtk_box_pack_start(file_browser->preview_box_,
+                       GTK_WIDGET(file_browser->preview_label_),
+                       false,
+                       false,
+                       0);
+    gtk_box_pack_start(file_browser->preview_box_,
+                       GTK_WIDGET(file_browser->preview_text_scroll_),
+                       true,
+                       true,
+                       0);
+    gtk_widget_show(GTK_WIDGET(file_browser->preview_label_));
+    gtk_widget_show(GTK_WIDGET(file_browser->preview_text_));
+    gtk_paned_pack1(file_browser->preview_pane_,
+                    GTK_WIDGET(file_browser->folder_view_scroll_),
+                    true,
+                    true);
+    gtk_paned_pack2(file_browser->preview_pane_,
+                    GTK_WIDGET(file_browser->preview_box_),
+                    false,
+                    true);
+    gtk_paned_pack2(file_browser->hpane, GTK_WIDGET(file_browser->preview_pane_), true, true);
+    file_browser->show_preview(xset_get_b(xset::name::view_preview));
 
     // fill side
     file_browser->side_toolbox =
@@ -1032,6 +1193,7 @@ ptk_file_browser_init(PtkFileBrowser* file_browser)
     g_signal_connect(G_OBJECT(file_browser->hpane), "button-release-event", G_CALLBACK(ptk_file_browser_slider_release), file_browser);
     g_signal_connect(G_OBJECT(file_browser->side_vpane_top), "button-release-event", G_CALLBACK(ptk_file_browser_slider_release), file_browser);
     g_signal_connect(G_OBJECT(file_browser->side_vpane_bottom), "button-release-event", G_CALLBACK(ptk_file_browser_slider_release), file_browser);
+    g_signal_connect(G_OBJECT(file_browser), "map", G_CALLBACK(on_file_browser_map), file_browser);
     // clang-format on
 
     file_browser->selection_history = std::make_shared<selection_history_data>();
@@ -1044,7 +1206,18 @@ ptk_file_browser_finalize(GObject* obj)
     PtkFileBrowser* file_browser = PTK_FILE_BROWSER_REINTERPRET(obj);
     // ztd::logger::info("ptk_file_browser_finalize");
 
+    vfs::thumbnail_store::remove_visible_callback(file_browser);
+
     file_browser->dir_ = nullptr;
+    file_browser->compare_ = nullptr;
+    // joins the decoder, results still queued for the main loop are dropped
+    file_browser->preview_ = nullptr;
+
+    if (prefetch_owner == file_browser)
+    {
+        vfs::dir_prefetch::cancel();
+        prefetch_owner = nullptr;
+    }
 
     /* Remove all idle handlers which are not called yet. */
     do
@@ -1063,6 +1236,9 @@ ptk_file_browser_finalize(GObject* obj)
         g_object_unref(G_OBJECT(file_browser->file_list_));
     }
 
+    // the dir of this tab is closed now, it stays cached without its monitor
+    vfs_dir_cache_trim();
+
     for (auto& toolbar_widget : file_browser->toolbar_widgets)
     {
         g_slist_free(toolbar_widget);
@@ -1070,12 +1246,6 @@ ptk_file_browser_finalize(GObject* obj)
     }
 
     G_OBJECT_CLASS(parent_class)->finalize(obj);
-
-    /* Ensuring free space at the end of the heap is freed to the OS,
-     * mainly to deal with the possibility that killing the browser results in
-     * thousands of large thumbnails being freed, but the memory not actually
-     * released by SpaceFM */
-    malloc_trim(0);
 }
 
 static void
@@ -1232,6 +1402,11 @@ PtkFileBrowser::on_folder_content_changed(const std::shared_ptr<vfs::file>& file
             // current directory does not exist - was renamed
             this->close_tab();
         }
+        else if (this->dir_)
+        {
+            // permissions may have changed, checked off the GTK thread
+            ptk_file_menu_check_writable(this->dir_);
+        }
     }
     else
     {
@@ -1254,6 +1429,35 @@ PtkFileBrowser::on_folder_content_deleted(const std::shared_ptr<vfs::file>& file
     }
 }
 
+static void
+on_file_list_rows_changed(GtkTreeModel* model, GtkTreePath* tree_path, PtkFileBrowser* file_browser)
+{
+    (void)model;
+    (void)tree_path;
+
+    // row indices have shifted, rebuilt on the next lookup
+    file_browser->compare_rows_.clear();
+}
+
+static void
+on_file_list_row_inserted(GtkTreeModel* model, GtkTreePath* tree_path, GtkTreeIter* it,
+                          PtkFileBrowser* file_browser)
+{
+    (void)it;
+
+    on_file_list_rows_changed(model, tree_path, file_browser);
+}
+
+static void
+on_file_list_rows_reordered(GtkTreeModel* model, GtkTreePath* tree_path, GtkTreeIter* it,
+                            void* new_order, PtkFileBrowser* file_browser)
+{
+    (void)it;
+    (void)new_order;
+
+    on_file_list_rows_changed(model, tree_path, file_browser);
+}
+
 static void
 on_sort_col_changed(GtkTreeSortable* sortable, PtkFileBrowser* file_browser)
 {
@@ -1320,11 +1524,19 @@ on_sort_col_changed(GtkTreeSortable* sortable, PtkFileBrowser* file_browser)
 void
 PtkFileBrowser::update_model() noexcept
 {
-    PtkFileList* list = ptk_file_list_new(this->dir_, this->show_hidden_files_);
+    PtkFileList* list = ptk_file_list_new(this->dir_, this->show_hidden_files_, this->filter_);
     GtkTreeModel* old_list = this->file_list_;
     this->file_list_ = GTK_TREE_MODEL(list);
+    this->compare_rows_.clear();
     if (old_list)
     {
+        g_signal_handlers_disconnect_matched(old_list,
+                                             GSignalMatchType::G_SIGNAL_MATCH_DATA,
+                                             0,
+                                             0,
+                                             nullptr,
+                                             nullptr,
+                                             this);
         g_object_unref(G_OBJECT(old_list));
     }
 
@@ -1337,6 +1549,9 @@ PtkFileBrowser::update_model() noexcept
 
     // clang-format off
     g_signal_connect(G_OBJECT(list), "sort-column-changed", G_CALLBACK(on_sort_col_changed), this);
+    g_signal_connect(G_OBJECT(list), "row-inserted", G_CALLBACK(on_file_list_row_inserted), this);
+    g_signal_connect(G_OBJECT(list), "row-deleted", G_CALLBACK(on_file_list_rows_changed), this);
+    g_signal_connect(G_OBJECT(list), "rows-reordered", G_CALLBACK(on_file_list_rows_reordered), this);
     // clang-format on
 
     switch (this->view_mode_)
@@ -1377,11 +1592,11 @@ PtkFileBrowser::on_dir_file_listed(bool is_cancelled)
     this->update_model();
     this->busy_ = false;
 
-    /* Ensuring free space at the end of the heap is freed to the OS,
-     * mainly to deal with the possibility that changing the directory results in
-     * thousands of large thumbnails being freed, but the memory not actually
-     * released by SpaceFM */
-    malloc_trim(0);
+    if (!is_cancelled)
+    {
+        vfs::dir_prefetch::visited(this->cwd());
+        this->prefetch_dirs();
+    }
 
     this->run_event<spacefm::signal::chdir_after>();
     this->run_event<spacefm::signal::change_content>();
@@ -1445,6 +1660,7 @@ on_folder_view_item_sel_change_idle(PtkFileBrowser* file_browser)
     GtkTreeModel* model;
     GList* selected_files = file_browser->selected_items(&model);
 
+    std::optional<std::filesystem::path> sel_dir = std::nullopt;
     for (GList* sel = selected_files; sel; sel = g_list_next(sel))
     {
         GtkTreeIter it;
@@ -1456,17 +1672,29 @@ on_folder_view_item_sel_change_idle(PtkFileBrowser* file_browser)
             {
                 file_browser->sel_size_ += file->size();
                 file_browser->sel_disk_size_ += file->size_on_disk();
+                if (file->is_directory())
+                {
+                    sel_dir = file->path();
+                }
             }
         }
     }
 
     file_browser->n_sel_files_ = g_list_length(selected_files);
 
+    if (file_browser->n_sel_files_ == 1 && sel_dir)
+    {
+        // likely to be opened next
+        file_browser->prefetch_dirs(sel_dir);
+    }
+
     g_list_foreach(selected_files, (GFunc)gtk_tree_path_free, nullptr);
     g_list_free(selected_files);
 
     file_browser->run_event<spacefm::signal::change_sel>();
     file_browser->sel_change_idle_ = 0;
+
+    file_browser->update_preview();
     return false;
 }
 
@@ -1868,7 +2096,6 @@ folder_view_search_equal(GtkTreeModel* model, i32 col, const char* c_key, GtkTre
                          void* search_data)
 {
     (void)search_data;
-    bool no_match;
 
     const auto column = ptk::file_list::column(col);
     if (column != ptk::file_list::column::name)
@@ -1876,61 +2103,43 @@ folder_view_search_equal(GtkTreeModel* model, i32 col, const char* c_key, GtkTre
         return true;
     }
 
-    char* c_name;
-
-    gtk_tree_model_get(model, it, col, &c_name, -1);
-    if (!c_name || !c_key)
+    if (!c_key)
     {
         return true;
     }
 
-    std::string key = c_key;
-    std::string name = c_name;
-
-    if (ztd::lower(key) == key)
+    // called for every row, compile the key once
+    static std::string last_key;
+    static std::shared_ptr<vfs::name_filter> filter = nullptr;
+    if (!filter || last_key != c_key)
     {
-        // key is all lowercase so do icase search
-        name = ztd::lower(name);
+        last_key = c_key;
+        std::string key = c_key;
+        const bool anchored = key.starts_with('^') || key.ends_with('$');
+        const bool glob = key.find_first_of("*?[") != std::string::npos;
+        if (!anchored && !glob && !key.starts_with('/') && key.size() < 3)
+        {
+            // short keys only match the start of a name
+            key = fmt::format("^{}", key);
+        }
+        filter = vfs::name_filter::create(key);
     }
 
-    if (key.contains("*") || key.contains('?'))
+    vfs::file* file = nullptr;
+    gtk_tree_model_get(model, it, ptk::file_list::column::info, &file, -1);
+    if (file)
     {
-        const std::string key2 = fmt::format("*{}*", key);
-        no_match = !ztd::fnmatch(key2, name);
+        return !filter->match(file->shared_from_this()); // return false for match
     }
-    else
+
+    char* c_name = nullptr;
+    gtk_tree_model_get(model, it, col, &c_name, -1);
+    if (!c_name)
     {
-        const bool end = ztd::endswith(key, "$");
-        bool start = !end && (key.size() < 3);
-        char* key2 = ztd::strdup(key);
-        char* keyp = key2;
-        if (key[0] == '^')
-        {
-            keyp++;
-            start = true;
-        }
-        if (end)
-        {
-            key2[std::strlen(key2) - 1] = '\0';
-        }
-        if (start && end)
-        {
-            no_match = !name.contains(keyp);
-        }
-        else if (start)
-        {
-            no_match = !name.starts_with(keyp);
-        }
-        else if (end)
-        {
-            no_match = !name.ends_with(keyp);
-        }
-        else
-        {
-            no_match = !name.contains(key);
-        }
-        std::free(key2);
+        return true;
     }
+    const bool no_match = !filter->match(c_name);
+    std::free(c_name);
     return no_match; // return false for match
 }
 
@@ -3078,6 +3287,22 @@ PtkFileBrowser::chdir(const std::filesystem::path& new_path,
             break;
     }
 
+    // results would be selected in the wrong dir
+    this->compare_ = nullptr;
+
+    this->deferred_path_ = std::nullopt;
+
+    // the filter belongs to the old dir
+    if (this->filter_)
+    {
+        this->filter_ = nullptr;
+        this->hide_filter_bar();
+    }
+
+    // warming the old candidates would compete with loading the new dir,
+    // on_dir_file_listed() queues the candidates of the new dir
+    vfs::dir_prefetch::cancel();
+
     // load new dir
 
     this->signal_file_listed.disconnect();
@@ -3088,6 +3313,8 @@ PtkFileBrowser::chdir(const std::filesystem::path& new_path,
 
     if (this->dir_->is_file_listed())
     {
+        // cached, the loader did not check write access this time
+        ptk_file_menu_check_writable(this->dir_);
         this->on_dir_file_listed(false);
         this->busy_ = false;
     }
@@ -3116,6 +3343,48 @@ PtkFileBrowser::chdir(const std::filesystem::path& new_path,
     return true;
 }
 
+void
+PtkFileBrowser::chdir_deferred(const std::filesystem::path& path) noexcept
+{
+    // only enough to show the path, the dir is loaded by materialize()
+    this->deferred_path_ = path;
+    this->navigation_history->new_forward(path);
+
+    this->update_tab_label();
+#if (GTK_MAJOR_VERSION == 4)
+    gtk_editable_set_text(GTK_EDITABLE(this->path_bar_), path.c_str());
+#elif (GTK_MAJOR_VERSION == 3)
+    gtk_entry_set_text(GTK_ENTRY(this->path_bar_), path.c_str());
+#endif
+
+    if (gtk_widget_get_mapped(GTK_WIDGET(this)))
+    {
+        this->materialize();
+    }
+}
+
+bool
+PtkFileBrowser::is_deferred() const noexcept
+{
+    return this->deferred_path_.has_value();
+}
+
+void
+PtkFileBrowser::materialize() noexcept
+{
+    if (!this->deferred_path_)
+    {
+        return;
+    }
+
+    // chdir() clears deferred_path_
+    const auto path = this->deferred_path_.value();
+    if (!this->chdir(path))
+    {
+        this->chdir("/");
+    }
+}
+
 const std::filesystem::path&
 PtkFileBrowser::cwd() const noexcept
 {
@@ -3299,6 +3568,12 @@ PtkFileBrowser::refresh(const bool update_selected_files) noexcept
         return;
     }
 
+    if (this->is_deferred())
+    {
+        // not loaded yet, nothing to refresh
+        return;
+    }
+
     if (update_selected_files)
     {
         this->update_selection_history();
@@ -3307,11 +3582,6 @@ PtkFileBrowser::refresh(const bool update_selected_files) noexcept
     // destroy file list and create new one
     this->update_model();
 
-    /* Ensuring free space at the end of the heap is freed to the OS,
-     * mainly to deal with the possibility thousands of large thumbnails
-     * have been freed but the memory not actually released by SpaceFM */
-    malloc_trim(0);
-
     // begin reload dir
     this->busy_ = true;
 
@@ -3353,6 +3623,208 @@ PtkFileBrowser::show_hidden_files(bool show) noexcept
     this->update_toolbar_widgets(xset::tool::show_hidden);
 }
 
+void
+PtkFileBrowser::prefetch_dirs(const std::optional<std::filesystem::path>& selected) noexcept
+{
+    std::vector<std::filesystem::path> paths;
+    if (selected)
+    {
+        paths.emplace_back(selected.value());
+    }
+
+    const auto& cwd = this->cwd();
+    if (cwd.has_parent_path() && cwd.parent_path() != cwd)
+    {
+        paths.emplace_back(cwd.parent_path());
+    }
+    if (this->navigation_history->has_back())
+    {
+        paths.emplace_back(this->navigation_history->get_back().back());
+    }
+    if (this->navigation_history->has_forward())
+    {
+        paths.emplace_back(this->navigation_history->get_forward().back());
+    }
+    for (const auto& path : vfs::dir_prefetch::frequent())
+    {
+        paths.emplace_back(path);
+    }
+
+    std::erase(paths, cwd);
+    vfs::dir_prefetch::request(paths);
+    prefetch_owner = this;
+}
+
+void
+PtkFileBrowser::set_filter(const std::string_view pattern) noexcept
+{
+    const auto old_filter = this->filter_;
+    this->filter_ = pattern.empty() ? nullptr : vfs::name_filter::create(pattern);
+
+    if (!this->file_list_ || this->busy_ || (!this->filter_ && !old_filter))
+    {
+        // used by update_model() once the dir is listed
+        return;
+    }
+
+    if (this->filter_ && old_filter && this->filter_->refines(*old_filter))
+    {
+        // narrowing, only drop rows from the current result
+        ptk_file_list_refine_filter(PTK_FILE_LIST(this->file_list_), this->filter_);
+    }
+    else
+    {
+        this->update_model();
+    }
+
+    this->run_event<spacefm::signal::change_content>();
+}
+
+void
+PtkFileBrowser::show_filter_bar() noexcept
+{
+    gtk_widget_show(GTK_WIDGET(this->filter_bar_));
+    gtk_widget_grab_focus(GTK_WIDGET(this->filter_bar_));
+}
+
+void
+PtkFileBrowser::hide_filter_bar() noexcept
+{
+    // clearing the text also clears the filter
+#if (GTK_MAJOR_VERSION == 4)
+    gtk_editable_set_text(GTK_EDITABLE(this->filter_bar_), "");
+#elif (GTK_MAJOR_VERSION == 3)
+    gtk_entry_set_text(GTK_ENTRY(this->filter_bar_), "");
+#endif
+    gtk_widget_hide(GTK_WIDGET(this->filter_bar_));
+
+    if (gtk_widget_get_visible(GTK_WIDGET(this->folder_view_)))
+    {
+        this->focus_folder_view();
+    }
+}
+
+static void
+preview_clear(PtkFileBrowser* file_browser, const std::string& msg = "")
+{
+    gtk_image_clear(file_browser->preview_image_);
+    gtk_widget_hide(GTK_WIDGET(file_browser->preview_image_));
+    gtk_text_buffer_set_text(gtk_text_view_get_buffer(file_browser->preview_text_), "", 0);
+    gtk_widget_hide(GTK_WIDGET(file_browser->preview_text_scroll_));
+    gtk_label_set_text(file_browser->preview_label_, msg.data());
+}
+
+static void
+on_preview_result(PtkFileBrowser* file_browser, const vfs::preview::result& result)
+{
+    if (result.pixbuf)
+    {
+        gtk_image_set_from_pixbuf(file_browser->preview_image_, result.pixbuf);
+        gtk_widget_show(GTK_WIDGET(file_browser->preview_image_));
+    }
+
+    if (!result.text.empty())
+    {
+        const auto text = result.truncated ? fmt::format("{}\n…", result.text) : result.text;
+        gtk_text_buffer_set_text(gtk_text_view_get_buffer(file_browser->preview_text_),
+                                 text.data(),
+                                 static_cast<i32>(text.size()));
+        gtk_widget_show(GTK_WIDGET(file_browser->preview_text_scroll_));
+    }
+
+    if (!result.info.empty())
+    {
+        const auto label = fmt::format("{}\n{}",
+                                       gtk_label_get_text(file_browser->preview_label_),
+                                       result.info);
+        gtk_label_set_text(file_browser->preview_label_, label.data());
+    }
+}
+
+static bool
+on_preview_timer(PtkFileBrowser* file_browser)
+{
+    file_browser->preview_timer_ = 0;
+
+    if (!GTK_IS_WIDGET(file_browser) || !file_browser->folder_view_ ||
+        !gtk_widget_get_visible(GTK_WIDGET(file_browser->preview_box_)))
+    {
+        return false;
+    }
+
+    const auto selected_files = file_browser->selected_files();
+    if (selected_files.size() != 1)
+    {
+        if (file_browser->preview_)
+        {
+            file_browser->preview_->cancel();
+        }
+        preview_clear(file_browser,
+                      selected_files.empty()
+                          ? std::string()
+                          : fmt::format("{} items selected", selected_files.size()));
+        return false;
+    }
+
+    const auto& file = selected_files.front();
+
+    // the cheap part is shown at once, the decoder fills in the rest
+    preview_clear(file_browser,
+                  fmt::format("{}\n{}\n{}\n{}",
+                              file->name(),
+                              file->mime_type()->description(),
+                              file->display_size(),
+                              file->display_mtime()));
+
+    if (file->is_directory())
+    {
+        if (file_browser->preview_)
+        {
+            file_browser->preview_->cancel();
+        }
+        return false;
+    }
+
+    if (!file_browser->preview_)
+    {
+        file_browser->preview_ = vfs::preview::create(
+            [file_browser](const vfs::preview::result& result)
+            { on_preview_result(file_browser, result); });
+    }
+    file_browser->preview_->request(file, 256);
+
+    return false;
+}
+
+void
+PtkFileBrowser::show_preview(bool show) noexcept
+{
+    if (show)
+    {
+        gtk_widget_show(GTK_WIDGET(this->preview_box_));
+        this->update_preview();
+    }
+    else
+    {
+        gtk_widget_hide(GTK_WIDGET(this->preview_box_));
+        // the decoder thread is only kept while the pane is shown
+        this->preview_ = nullptr;
+        preview_clear(this);
+    }
+}
+
+void
+PtkFileBrowser::update_preview() noexcept
+{
+    if (!gtk_widget_get_visible(GTK_WIDGET(this->preview_box_)) || this->preview_timer_)
+    {
+        return;
+    }
+
+    // holding a cursor key down decodes at most one row per interval
+    this->preview_timer_ = g_timeout_add(150, (GSourceFunc)on_preview_timer, this);
+}
+
 void
 PtkFileBrowser::set_single_click(bool single_click) noexcept
 {
@@ -3615,6 +4087,12 @@ PtkFileBrowser::rename_selected_files(
 
     gtk_widget_grab_focus(this->folder_view_);
 
+    if (selected_files.size() > 1)
+    {
+        ptk_bulk_rename_files(this, cwd, selected_files);
+        return;
+    }
+
     for (const auto& file : selected_files)
     {
         if (!ptk_rename_file(this,
@@ -3936,6 +4414,103 @@ PtkFileBrowser::copycmd(const std::span<const std::shared_ptr<vfs::file>> sel_fi
     }
 }
 
+void
+PtkFileBrowser::synccmd(const std::span<const std::shared_ptr<vfs::file>> sel_files,
+                        const std::filesystem::path& cwd, xset::name setname) noexcept
+{
+    vfs::file_task::sync_mode mode;
+    if (setname == xset::name::sync_panel_mirror)
+    {
+        mode = vfs::file_task::sync_mode::one_way_delete;
+    }
+    else if (setname == xset::name::sync_panel_both)
+    {
+        mode = vfs::file_task::sync_mode::two_way;
+    }
+    else
+    {
+        mode = vfs::file_task::sync_mode::one_way;
+    }
+
+    const auto dest_dir = main_window_get_panel_cwd(this, panel_control_code_next);
+    if (!dest_dir || sel_files.empty() || std::filesystem::equivalent(dest_dir.value(), cwd))
+    {
+        ptk_show_message(GTK_WINDOW(this),
+                         GtkMessageType::GTK_MESSAGE_ERROR,
+                         "Invalid Destination",
+                         GtkButtonsType::GTK_BUTTONS_OK,
+                         "Select the files to sync and open the destination in the next panel");
+        return;
+    }
+
+    if (mode == vfs::file_task::sync_mode::one_way_delete)
+    {
+        const auto response = ptk_show_message(
+            GTK_WINDOW(this),
+            GtkMessageType::GTK_MESSAGE_WARNING,
+            "Mirror To Next Panel",
+            GtkButtonsType::GTK_BUTTONS_OK_CANCEL,
+            fmt::format("Files inside the selected directories that are not in this panel will "
+                        "be deleted from\n\n{}",
+                        dest_dir.value().string()));
+        if (response != GtkResponseType::GTK_RESPONSE_OK)
+        {
+            return;
+        }
+    }
+
+    std::vector<std::filesystem::path> file_list;
+    file_list.reserve(sel_files.size());
+    for (const auto& file : sel_files)
+    {
+        file_list.emplace_back(file->path());
+    }
+
+#if (GTK_MAJOR_VERSION == 4)
+    GtkWidget* parent_win = GTK_WIDGET(gtk_widget_get_root(GTK_WIDGET(this)));
+#elif (GTK_MAJOR_VERSION == 3)
+    GtkWidget* parent_win = gtk_widget_get_toplevel(GTK_WIDGET(this));
+#endif
+
+    PtkFileTask* ptask = ptk_file_task_new(vfs::file_task::type::sync,
+                                           file_list,
+                                           dest_dir.value(),
+                                           GTK_WINDOW(parent_win),
+                                           this->task_view_);
+    ptk_file_task_set_sync(ptask, mode, xset_get_b(xset::name::sync_content));
+    ptk_file_task_run(ptask);
+}
+
+void
+PtkFileBrowser::find_dups(const std::span<const std::shared_ptr<vfs::file>> sel_files,
+                          const std::filesystem::path& cwd) noexcept
+{
+    std::vector<std::filesystem::path> file_list;
+    file_list.reserve(sel_files.size());
+    for (const auto& file : sel_files)
+    {
+        file_list.emplace_back(file->path());
+    }
+    if (file_list.empty())
+    {
+        file_list.emplace_back(cwd);
+    }
+
+#if (GTK_MAJOR_VERSION == 4)
+    GtkWidget* parent_win = GTK_WIDGET(gtk_widget_get_root(GTK_WIDGET(this)));
+#elif (GTK_MAJOR_VERSION == 3)
+    GtkWidget* parent_win = gtk_widget_get_toplevel(GTK_WIDGET(this));
+#endif
+
+    PtkFileTask* ptask = ptk_file_task_new(vfs::file_task::type::find_dups,
+                                           file_list,
+                                           GTK_WINDOW(parent_win),
+                                           this->task_view_);
+    // the results are listed in the task log, keep it open once done
+    ptask->task->exec_popup = true;
+    ptk_file_task_run(ptask);
+}
+
 void
 PtkFileBrowser::set_sort_order(ptk::file_browser::sort_order order) noexcept
 {
@@ -5065,6 +5640,159 @@ PtkFileBrowser::select_file(const std::filesystem::path& filename,
     }
 }
 
+void
+PtkFileBrowser::select_file_names(const std::unordered_set<std::string_view>& names) noexcept
+{
+    if (names.empty())
+    {
+        return;
+    }
+
+    GtkTreeSelection* tree_sel = nullptr;
+    GtkTreeModel* model = nullptr;
+    switch (this->view_mode_)
+    {
+        case ptk::file_browser::view_mode::icon_view:
+        case ptk::file_browser::view_mode::compact_view:
+            model = exo_icon_view_get_model(EXO_ICON_VIEW(this->folder_view_));
+            break;
+        case ptk::file_browser::view_mode::list_view:
+            model = gtk_tree_view_get_model(GTK_TREE_VIEW(this->folder_view_));
+            tree_sel = gtk_tree_view_get_selection(GTK_TREE_VIEW(this->folder_view_));
+            break;
+    }
+    if (!model)
+    {
+        return;
+    }
+
+    // one pass over the list per compare, dropped by the row signals
+    if (this->compare_rows_.empty())
+    {
+        GtkTreeIter it;
+        if (!gtk_tree_model_get_iter_first(model, &it))
+        {
+            return;
+        }
+        this->compare_rows_.reserve(
+            static_cast<usize>(gtk_tree_model_iter_n_children(model, nullptr)));
+        i32 index = 0;
+        do
+        {
+            vfs::file* file = nullptr;
+            gtk_tree_model_get(model, &it, ptk::file_list::column::info, &file, -1);
+            if (file)
+            {
+                this->compare_rows_.insert_or_assign(std::string(file->name()), index);
+            }
+            ++index;
+        } while (gtk_tree_model_iter_next(model, &it));
+    }
+
+    for (const std::string_view name : names)
+    {
+        const auto row = this->compare_rows_.find(std::string(name));
+        if (row == this->compare_rows_.cend())
+        {
+            continue;
+        }
+
+        // a path from the index, the list model finds paths by a linear scan
+        GtkTreePath* tree_path = gtk_tree_path_new_from_indices(row->second, -1);
+        if (tree_sel)
+        {
+            gtk_tree_selection_select_path(tree_sel, tree_path);
+        }
+        else
+        {
+            exo_icon_view_select_path(EXO_ICON_VIEW(this->folder_view_), tree_path);
+        }
+        gtk_tree_path_free(tree_path);
+    }
+}
+
+void
+PtkFileBrowser::compare_panels(bool content) noexcept
+{
+    PtkFileBrowser* other = main_window_get_panel_file_browser(this, panel_control_code_next);
+    if (!other || other == this || !this->dir_ || !other->dir_ || this->busy_ || other->busy_)
+    {
+        ptk_show_error(GTK_WINDOW(this->main_window_),
+                       "Compare Panels",
+                       "Comparing needs a second visible panel with a loaded directory.");
+        return;
+    }
+
+    this->unselect_all();
+    other->unselect_all();
+    this->compare_rows_.clear();
+    other->compare_rows_.clear();
+
+    // the other panel is looked up again for each batch, it may have changed
+    const panel_t other_panel = other->panel();
+    const std::filesystem::path other_cwd = other->cwd();
+
+    const auto on_batch = [this, other_panel, other_cwd](
+                              const std::span<const vfs::dir_compare::entry> entries)
+    {
+        std::unordered_set<std::string_view> left;
+        std::unordered_set<std::string_view> right;
+        for (const auto& entry : entries)
+        {
+            switch (entry.result)
+            {
+                case vfs::dir_compare::result::only_left:
+                case vfs::dir_compare::result::newer_left:
+                    left.insert(entry.name);
+                    break;
+                case vfs::dir_compare::result::only_right:
+                case vfs::dir_compare::result::newer_right:
+                    right.insert(entry.name);
+                    break;
+                case vfs::dir_compare::result::differs:
+                    left.insert(entry.name);
+                    right.insert(entry.name);
+                    break;
+            }
+        }
+
+        this->select_file_names(left);
+
+        PtkFileBrowser* other = main_window_get_panel_file_browser(this, other_panel);
+        if (other && other->cwd() == other_cwd)
+        {
+            other->select_file_names(right);
+        }
+    };
+
+    const auto on_finish = [this, other_panel](u64 differences)
+    {
+        this->compare_rows_.clear();
+        PtkFileBrowser* other = main_window_get_panel_file_browser(this, other_panel);
+        if (other)
+        {
+            other->compare_rows_.clear();
+        }
+
+        if (differences == 0)
+        {
+            ptk_show_message(GTK_WINDOW(this->main_window_),
+                             GtkMessageType::GTK_MESSAGE_INFO,
+                             "Compare Panels",
+                             GtkButtonsType::GTK_BUTTONS_OK,
+                             "The panels have the same contents.");
+        }
+        this->compare_ = nullptr;
+    };
+
+    this->compare_ = vfs::dir_compare::create(this->dir_->files(),
+                                              other->dir_->files(),
+                                              content,
+                                              on_batch,
+                                              on_finish);
+    this->compare_->start();
+}
+
 void
 PtkFileBrowser::select_files(const std::span<std::filesystem::path> select_filenames) noexcept
 {
@@ -5889,6 +6617,18 @@ PtkFileBrowser::on_action(const xset::name setname) noexcept
         {
             this->select_pattern();
         }
+        else if (set->xset_name == xset::name::select_filter)
+        {
+            this->show_filter_bar();
+        }
+        else if (set->xset_name == xset::name::select_compare)
+        {
+            this->compare_panels(false);
+        }
+        else if (set->xset_name == xset::name::select_compare_content)
+        {
+            this->compare_panels(true);
+        }
     }
     else // all the rest require ptkfilemenu data
     {
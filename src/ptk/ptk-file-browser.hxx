@@ -15,11 +15,14 @@
 
 #pragma once
 
+#include <string>
 #include <string_view>
 
 #include <filesystem>
 
 #include <span>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <optional>
 
@@ -31,6 +34,9 @@
 #include <xset/xset.hxx>
 
 #include "vfs/vfs-dir.hxx"
+#include "vfs/vfs-dir-compare.hxx"
+#include "vfs/vfs-name-filter.hxx"
+#include "vfs/vfs-preview.hxx"
 
 #include "types.hxx"
 
@@ -122,11 +128,19 @@ struct PtkFileBrowser
     /* <private> */
     std::shared_ptr<vfs::dir> dir_{nullptr};
     GtkTreeModel* file_list_{nullptr};
+    std::shared_ptr<vfs::name_filter> filter_{nullptr};
+    std::shared_ptr<vfs::dir_compare> compare_{nullptr};
+    // name -> row index for compare selection, dropped when the rows change
+    std::unordered_map<std::string, i32> compare_rows_;
+    // restored tab that was never shown, its dir is only loaded once the tab is mapped
+    std::optional<std::filesystem::path> deferred_path_{std::nullopt};
     i32 max_thumbnail_{0};
     u64 n_sel_files_{0};
     u64 sel_size_{0};
     u64 sel_disk_size_{0};
     u32 sel_change_idle_{0};
+    std::shared_ptr<vfs::preview> preview_{nullptr};
+    u32 preview_timer_{0};
 
     // path bar auto seek
     bool inhibit_focus_{false};
@@ -165,7 +179,14 @@ struct PtkFileBrowser
     GtkWidget* task_view_{nullptr};
     GtkBox* toolbox_{nullptr};
     GtkEntry* path_bar_{nullptr};
+    GtkEntry* filter_bar_{nullptr};
     GtkPaned* hpane{nullptr};
+    GtkPaned* preview_pane_{nullptr};
+    GtkBox* preview_box_{nullptr};
+    GtkImage* preview_image_{nullptr};
+    GtkLabel* preview_label_{nullptr};
+    GtkScrolledWindow* preview_text_scroll_{nullptr};
+    GtkTextView* preview_text_{nullptr};
     GtkBox* side_vbox{nullptr};
     GtkBox* side_toolbox{nullptr};
     GtkPaned* side_vpane_top{nullptr};
@@ -191,6 +212,11 @@ struct PtkFileBrowser
         const std::filesystem::path& new_path,
         const ptk::file_browser::chdir_mode mode = ptk::file_browser::chdir_mode::normal) noexcept;
 
+    // set the path without loading the dir, see materialize()
+    void chdir_deferred(const std::filesystem::path& path) noexcept;
+    bool is_deferred() const noexcept;
+    void materialize() noexcept;
+
     const std::filesystem::path& cwd() const noexcept;
     void canon(const std::filesystem::path& path) noexcept;
 
@@ -207,6 +233,19 @@ struct PtkFileBrowser
     void refresh(const bool update_selected_files = true) noexcept;
 
     void show_hidden_files(bool show) noexcept;
+
+    // warm the dirs likely to be opened next, see vfs::dir_prefetch
+    void prefetch_dirs(
+        const std::optional<std::filesystem::path>& selected = std::nullopt) noexcept;
+
+    // quick filter, hides rows not matching pattern. see vfs::name_filter
+    void set_filter(const std::string_view pattern) noexcept;
+    void show_filter_bar() noexcept;
+    void hide_filter_bar() noexcept;
+
+    // preview pane beside the file list, decoded by vfs::preview
+    void show_preview(bool show) noexcept;
+    void update_preview() noexcept;
     void set_single_click(bool single_click) noexcept;
 
     void new_tab() noexcept;
@@ -228,6 +267,10 @@ struct PtkFileBrowser
 
     void copycmd(const std::span<const std::shared_ptr<vfs::file>> selected_files,
                  const std::filesystem::path& cwd, xset::name setname) noexcept;
+    void synccmd(const std::span<const std::shared_ptr<vfs::file>> selected_files,
+                 const std::filesystem::path& cwd, xset::name setname) noexcept;
+    void find_dups(const std::span<const std::shared_ptr<vfs::file>> selected_files,
+                   const std::filesystem::path& cwd) noexcept;
 
     void set_sort_order(ptk::file_browser::sort_order order) noexcept;
     void set_sort_type(GtkSortType order) noexcept;
@@ -249,6 +292,10 @@ struct PtkFileBrowser
     void unselect_file(const std::filesystem::path& filename,
                        const bool unselect_others = true) noexcept;
     void select_pattern(const std::string_view search_key = "") noexcept;
+    // adds to the selection, looked up in compare_rows_
+    void select_file_names(const std::unordered_set<std::string_view>& names) noexcept;
+    // select what differs between this panel and the next visible one
+    void compare_panels(bool content) noexcept;
     void invert_selection() noexcept;
 
     void view_as_icons() noexcept;
@@ -97,6 +97,7 @@ static void ptk_file_list_set_default_sort_func(GtkTreeSortable* sortable,
 
 /* signal handlers */
 
+static bool ptk_file_list_is_visible(PtkFileList* list, const std::shared_ptr<vfs::file>& file);
 static void ptk_file_list_file_created(const std::shared_ptr<vfs::file>& file, PtkFileList* list);
 static void ptk_file_list_file_changed(const std::shared_ptr<vfs::file>& file, PtkFileList* list);
 
@@ -245,10 +246,12 @@ ptk_file_list_finalize(GObject* object)
 }
 
 PtkFileList*
-ptk_file_list_new(const std::shared_ptr<vfs::dir>& dir, bool show_hidden)
+ptk_file_list_new(const std::shared_ptr<vfs::dir>& dir, bool show_hidden,
+                  const std::shared_ptr<vfs::name_filter>& filter)
 {
     PtkFileList* list = PTK_FILE_LIST(g_object_new(PTK_TYPE_FILE_LIST, nullptr));
     list->show_hidden = show_hidden;
+    list->filter = filter;
     ptk_file_list_set_dir(list, dir);
     return list;
 }
@@ -332,7 +335,7 @@ ptk_file_list_set_dir(PtkFileList* list, const std::shared_ptr<vfs::dir>& dir)
 
     for (const auto& file : dir->files())
     {
-        if (list->show_hidden || !file->is_hidden())
+        if (ptk_file_list_is_visible(list, file))
         {
             list->files = g_list_prepend(list->files, file.get());
             ++list->n_files;
@@ -414,6 +417,17 @@ ptk_file_list_get_path(GtkTreeModel* tree_model, GtkTreeIter* iter)
     return path;
 }
 
+static void
+ptk_file_list_reload_evicted_thumbnail(PtkFileList* list, const std::shared_ptr<vfs::file>& file,
+                                       bool big) noexcept
+{
+    if (list->dir && list->max_thumbnail != 0 && list->big_thumbnail == big &&
+        file->is_thumbnail_evicted(big))
+    {
+        list->dir->load_thumbnail(file, big);
+    }
+}
+
 static void
 ptk_file_list_get_value(GtkTreeModel* tree_model, GtkTreeIter* iter, i32 column, GValue* value)
 {
@@ -439,6 +453,11 @@ ptk_file_list_get_value(GtkTreeModel* tree_model, GtkTreeIter* iter, i32 column,
                  (list->max_thumbnail != 0 && file->is_video())))
             {
                 icon = file->big_thumbnail();
+                if (!icon)
+                {
+                    // shown again, load from the on-disk thumbnail cache
+                    ptk_file_list_reload_evicted_thumbnail(list, file, true);
+                }
             }
 
             if (!icon)
@@ -457,6 +476,11 @@ ptk_file_list_get_value(GtkTreeModel* tree_model, GtkTreeIter* iter, i32 column,
                          (list->max_thumbnail != 0 && file->is_video())))
             {
                 icon = file->small_thumbnail();
+                if (!icon)
+                {
+                    // shown again, load from the on-disk thumbnail cache
+                    ptk_file_list_reload_evicted_thumbnail(list, file, false);
+                }
             }
             if (!icon)
             {
@@ -878,10 +902,55 @@ ptk_file_list_find_iter(PtkFileList* list, GtkTreeIter* it, const std::shared_pt
     return false;
 }
 
+static bool
+ptk_file_list_is_visible(PtkFileList* list, const std::shared_ptr<vfs::file>& file)
+{
+    if (!list->show_hidden && file->is_hidden())
+    {
+        return false;
+    }
+    return !list->filter || list->filter->match(file);
+}
+
+void
+ptk_file_list_refine_filter(PtkFileList* list, const std::shared_ptr<vfs::name_filter>& filter)
+{
+    list->filter = filter;
+    if (!filter)
+    {
+        return;
+    }
+
+    // only rows that already passed the previous filter need to be tested
+    i32 index = 0;
+    GList* l = list->files;
+    while (l)
+    {
+        GList* next = g_list_next(l);
+
+        const auto file = static_cast<vfs::file*>(l->data)->shared_from_this();
+        if (filter->match(file))
+        {
+            index += 1;
+        }
+        else
+        {
+            list->files = g_list_delete_link(list->files, l);
+            --list->n_files;
+
+            GtkTreePath* path = gtk_tree_path_new_from_indices(index, -1);
+            gtk_tree_model_row_deleted(GTK_TREE_MODEL(list), path);
+            gtk_tree_path_free(path);
+        }
+
+        l = next;
+    }
+}
+
 static void
 ptk_file_list_file_created(const std::shared_ptr<vfs::file>& file, PtkFileList* list)
 {
-    if (!list->show_hidden && file->is_hidden())
+    if (!ptk_file_list_is_visible(list, file))
     {
         return;
     }
@@ -924,7 +993,7 @@ PtkFileList::on_file_list_file_deleted(const std::shared_ptr<vfs::file>& file)
         return;
     }
 
-    if (!this->show_hidden && file->is_hidden())
+    if (!ptk_file_list_is_visible(this, file))
     {
         return;
     }
@@ -946,7 +1015,7 @@ PtkFileList::on_file_list_file_deleted(const std::shared_ptr<vfs::file>& file)
 void
 ptk_file_list_file_changed(const std::shared_ptr<vfs::file>& file, PtkFileList* list)
 {
-    if (!list->show_hidden && file->is_hidden())
+    if (!ptk_file_list_is_visible(list, file))
     {
         return;
     }
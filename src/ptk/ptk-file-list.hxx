@@ -24,6 +24,7 @@
 #include <ztd/ztd.hxx>
 
 #include "vfs/vfs-dir.hxx"
+#include "vfs/vfs-name-filter.hxx"
 
 #define PTK_FILE_LIST(obj)             (static_cast<PtkFileList*>(obj))
 #define PTK_FILE_LIST_REINTERPRET(obj) (reinterpret_cast<PtkFileList*>(obj))
@@ -69,6 +70,8 @@ struct PtkFileList
     u32 n_files{0};
 
     bool show_hidden{true};
+    // rows not matching are left out of the model
+    std::shared_ptr<vfs::name_filter> filter{nullptr};
     bool big_thumbnail{true};
     u64 max_thumbnail{0};
 
@@ -109,12 +112,17 @@ struct PtkFileListClass
 
 GType ptk_file_list_get_type();
 
-PtkFileList* ptk_file_list_new(const std::shared_ptr<vfs::dir>& dir, bool show_hidden);
+PtkFileList* ptk_file_list_new(const std::shared_ptr<vfs::dir>& dir, bool show_hidden,
+                               const std::shared_ptr<vfs::name_filter>& filter = nullptr);
 
 void ptk_file_list_set_dir(PtkFileList* list, const std::shared_ptr<vfs::dir>& dir);
 
 bool ptk_file_list_find_iter(PtkFileList* list, GtkTreeIter* it,
                              const std::shared_ptr<vfs::file>& file);
 
+// filter must refine the current filter, only removes rows
+void ptk_file_list_refine_filter(PtkFileList* list,
+                                 const std::shared_ptr<vfs::name_filter>& filter);
+
 void ptk_file_list_show_thumbnails(PtkFileList* list, bool is_big, u64 max_file_size);
 void ptk_file_list_sort(PtkFileList* list); // sfm
@@ -29,7 +29,14 @@
 
 #include <memory>
 
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+
 #include <fcntl.h>
+#include <unistd.h>
 
 #include <glibmm.h>
 
@@ -42,6 +49,9 @@
 
 #include "xset/xset.hxx"
 
+#include "mime-type/mime-action.hxx"
+#include "mime-type/mime-type.hxx"
+
 #include "write.hxx"
 
 #include "vfs/vfs-app-desktop.hxx"
@@ -250,6 +260,31 @@ on_copycmd(GtkMenuItem* menuitem, PtkFileMenu* data, const xset_t& set2)
     }
 }
 
+static void
+on_synccmd(GtkMenuItem* menuitem, PtkFileMenu* data)
+{
+    const xset_t set =
+        xset_get(static_cast<const char*>(g_object_get_data(G_OBJECT(menuitem), "set")));
+    if (!set)
+    {
+        return;
+    }
+    if (data->browser)
+    {
+        data->browser->synccmd(data->sel_files, data->cwd, set->xset_name);
+    }
+}
+
+static void
+on_find_dups(GtkMenuItem* menuitem, PtkFileMenu* data)
+{
+    (void)menuitem;
+    if (data->browser)
+    {
+        data->browser->find_dups(data->sel_files, data->cwd);
+    }
+}
+
 static void
 on_popup_select_pattern(GtkMenuItem* menuitem, PtkFileMenu* data)
 {
@@ -260,6 +295,36 @@ on_popup_select_pattern(GtkMenuItem* menuitem, PtkFileMenu* data)
     }
 }
 
+static void
+on_popup_select_filter(GtkMenuItem* menuitem, PtkFileMenu* data)
+{
+    (void)menuitem;
+    if (data->browser)
+    {
+        data->browser->show_filter_bar();
+    }
+}
+
+static void
+on_popup_select_compare(GtkMenuItem* menuitem, PtkFileMenu* data)
+{
+    (void)menuitem;
+    if (data->browser)
+    {
+        data->browser->compare_panels(false);
+    }
+}
+
+static void
+on_popup_select_compare_content(GtkMenuItem* menuitem, PtkFileMenu* data)
+{
+    (void)menuitem;
+    if (data->browser)
+    {
+        data->browser->compare_panels(true);
+    }
+}
+
 static void
 on_open_in_tab(GtkMenuItem* menuitem, PtkFileMenu* data)
 {
@@ -645,6 +710,9 @@ ptk_file_menu_add_panel_view_menu(PtkFileBrowser* browser, GtkWidget* menu,
         xset_set(xset::name::rubberband, xset::var::disable, "1");
     }
 
+    set = xset_get(xset::name::view_preview);
+    xset_set_cb(set, (GFunc)main_window_preview_all, nullptr);
+
     set = xset_get(xset::name::view_thumb);
     xset_set_cb(set, (GFunc)main_window_toggle_thumbnails_all_windows, nullptr);
     set->b = app_settings.show_thumbnail() ? xset::b::xtrue : xset::b::unset;
@@ -918,6 +986,7 @@ ptk_file_menu_add_panel_view_menu(PtkFileBrowser* browser, GtkWidget* menu,
             xset::name::panel1_show_sidebar,
             xset::name::panel1_show_devmon,
             xset::name::panel1_show_dirtree,
+            xset::name::view_preview,
             xset::name::separator,
             xset::name::panel1_show_hidden,
             xset::name::view_list_style,
@@ -934,6 +1003,7 @@ ptk_file_menu_add_panel_view_menu(PtkFileBrowser* browser, GtkWidget* menu,
             xset::name::panel2_show_sidebar,
             xset::name::panel2_show_devmon,
             xset::name::panel2_show_dirtree,
+            xset::name::view_preview,
             xset::name::separator,
             xset::name::panel2_show_hidden,
             xset::name::view_list_style,
@@ -950,6 +1020,7 @@ ptk_file_menu_add_panel_view_menu(PtkFileBrowser* browser, GtkWidget* menu,
             xset::name::panel3_show_sidebar,
             xset::name::panel3_show_devmon,
             xset::name::panel3_show_dirtree,
+            xset::name::view_preview,
             xset::name::separator,
             xset::name::panel3_show_hidden,
             xset::name::view_list_style,
@@ -966,6 +1037,7 @@ ptk_file_menu_add_panel_view_menu(PtkFileBrowser* browser, GtkWidget* menu,
             xset::name::panel4_show_sidebar,
             xset::name::panel4_show_devmon,
             xset::name::panel4_show_dirtree,
+            xset::name::view_preview,
             xset::name::separator,
             xset::name::panel4_show_hidden,
             xset::name::view_list_style,
@@ -980,6 +1052,254 @@ ptk_file_menu_add_panel_view_menu(PtkFileBrowser* browser, GtkWidget* menu,
     xset_add_menuitem(browser, menu, accel_group, set);
 }
 
+namespace ptk::file_menu
+{
+    // The Open submenu entries that need to read the file or the mime
+    // databases, looked up on a worker thread so the menu shows at once.
+    struct open_with_job
+    {
+        PtkFileMenu* data{nullptr};
+        GtkWidget* submenu{nullptr};
+        GtkWidget* anchor{nullptr}; // results are inserted before this
+#if (GTK_MAJOR_VERSION == 4)
+        GtkEventController* accel_group{nullptr};
+#elif (GTK_MAJOR_VERSION == 3)
+        GtkAccelGroup* accel_group{nullptr};
+#endif
+        bool add_edit{false};
+    };
+} // namespace ptk::file_menu
+
+struct open_with_request
+{
+    u64 generation{0};
+    std::filesystem::path path{};
+    std::string type{};
+    std::weak_ptr<ptk::file_menu::open_with_job> job;
+};
+
+struct open_with_result
+{
+    u64 generation{0};
+    std::weak_ptr<ptk::file_menu::open_with_job> job;
+    bool is_text{false};
+    std::vector<std::string> apps{};
+};
+
+struct writable_result
+{
+    std::weak_ptr<vfs::dir> dir;
+    bool writable{false};
+};
+
+// One worker serves every popup. A lookup can hang on an unresponsive network
+// filesystem, so a new popup replaces the waiting request instead of starting
+// another thread, and only the result of the latest request is used.
+// Write access checks of changed dirs can hang the same way and share it.
+static std::mutex open_with_lock;
+static std::condition_variable_any open_with_cond;
+static std::optional<open_with_request> open_with_pending{std::nullopt};
+static std::vector<std::pair<std::filesystem::path, std::weak_ptr<vfs::dir>>> writable_pending;
+static std::atomic<u64> open_with_generation{0};
+static std::jthread open_with_worker;
+
+static bool
+open_with_is_current(u64 generation, const std::weak_ptr<ptk::file_menu::open_with_job>& job)
+{
+    // the job is gone once its menu was closed
+    return generation == open_with_generation && !job.expired();
+}
+
+static GtkWidget*
+app_menuitem_new(GtkWidget* submenu, const std::string_view app, PtkFileMenu* data)
+{
+    const auto desktop = vfs::desktop::create(app);
+    const auto app_name = desktop->display_name();
+
+    GtkWidget* app_menu_item =
+        gtk_menu_item_new_with_label(!app_name.empty() ? app_name.data() : app.data());
+
+    // clang-format off
+    g_object_set_data(G_OBJECT(app_menu_item), "menu", submenu);
+    g_object_set_data_full(G_OBJECT(app_menu_item), "desktop_file", ztd::strdup(app.data()), free);
+
+    g_signal_connect(G_OBJECT(app_menu_item), "activate", G_CALLBACK(on_popup_run_app), (void*)data);
+    g_signal_connect(G_OBJECT(app_menu_item), "button-press-event", G_CALLBACK(on_app_button_press), (void*)data);
+    g_signal_connect(G_OBJECT(app_menu_item), "button-release-event", G_CALLBACK(on_app_button_press), (void*)data);
+    // clang-format on
+
+    return app_menu_item;
+}
+
+static gboolean
+on_open_with_ready(void* user_data)
+{
+    const std::unique_ptr<open_with_result> result(static_cast<open_with_result*>(user_data));
+    const auto job = result->job.lock();
+    if (!job || result->generation != open_with_generation)
+    {
+        // menu was closed or another one was opened
+        return G_SOURCE_REMOVE;
+    }
+
+    GList* children = gtk_container_get_children(GTK_CONTAINER(job->submenu));
+    i32 pos = g_list_index(children, job->anchor);
+    g_list_free(children);
+
+    for (const std::string_view app : result->apps)
+    {
+        GtkWidget* item = app_menuitem_new(job->submenu, app, job->data);
+        gtk_menu_shell_insert(GTK_MENU_SHELL(job->submenu), item, pos++);
+        gtk_widget_show(item);
+    }
+
+    if (result->is_text && job->add_edit)
+    {
+        GtkWidget* item = gtk_separator_menu_item_new();
+        gtk_menu_shell_insert(GTK_MENU_SHELL(job->submenu), item, pos++);
+        gtk_widget_show(item);
+
+        const auto set = xset_get(xset::name::open_edit);
+        xset_set_cb(set, (GFunc)on_file_edit, job->data);
+        item = xset_add_menuitem(job->data->browser, job->submenu, job->accel_group, set);
+        gtk_menu_reorder_child(GTK_MENU(job->submenu), item, pos++);
+        gtk_widget_show_all(item);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+on_writable_ready(void* user_data)
+{
+    const std::unique_ptr<writable_result> result(static_cast<writable_result*>(user_data));
+    const auto dir = result->dir.lock();
+    if (dir)
+    {
+        dir->set_writable(result->writable);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+static void
+open_with_thread(const std::stop_token& stop_token)
+{
+    while (!stop_token.stop_requested())
+    {
+        std::optional<open_with_request> pending;
+        std::vector<std::pair<std::filesystem::path, std::weak_ptr<vfs::dir>>> writable_checks;
+        {
+            std::unique_lock<std::mutex> lock(open_with_lock);
+            const auto has_request = []
+            {
+                return open_with_pending.has_value() || !writable_pending.empty();
+            };
+            if (!open_with_cond.wait(lock, stop_token, has_request))
+            {
+                break;
+            }
+            pending = std::move(open_with_pending);
+            open_with_pending = std::nullopt;
+            writable_checks = std::move(writable_pending);
+            writable_pending.clear();
+        }
+
+        // the dir is only touched on the GTK thread, the worker never holds a reference
+        for (const auto& [path, dir] : writable_checks)
+        {
+            auto result = std::make_unique<writable_result>();
+            result->dir = dir;
+            // Note: network filesystems may become unresponsive here
+            result->writable = faccessat(0, path.c_str(), W_OK, AT_EACCESS) == 0;
+            g_idle_add(on_writable_ready, result.release());
+        }
+
+        if (!pending)
+        {
+            continue;
+        }
+        const open_with_request request = std::move(*pending);
+
+        if (!open_with_is_current(request.generation, request.job))
+        {
+            continue;
+        }
+
+        auto result = std::make_unique<open_with_result>();
+        result->generation = request.generation;
+        result->job = request.job;
+
+        // Note: network filesystems may become unresponsive here
+        result->is_text = mime_type_is_text_file(request.path, request.type);
+        result->apps = mime_type_get_actions(request.type);
+        if (result->is_text)
+        {
+            const std::vector<std::string> txt_apps =
+                mime_type_get_actions(XDG_MIME_TYPE_PLAIN_TEXT);
+            if (!txt_apps.empty())
+            {
+                result->apps = ztd::merge(result->apps, txt_apps);
+            }
+        }
+
+        if (!open_with_is_current(request.generation, request.job))
+        {
+            continue;
+        }
+
+        g_idle_add(on_open_with_ready, result.release());
+    }
+}
+
+static void
+open_with_start_worker()
+{
+    if (!open_with_worker.joinable())
+    {
+        open_with_worker = std::jthread(open_with_thread);
+    }
+}
+
+static void
+open_with_request_apps(const std::filesystem::path& path, const std::string_view type,
+                       const std::shared_ptr<ptk::file_menu::open_with_job>& job)
+{
+    open_with_start_worker();
+
+    open_with_request request;
+    // a lookup still running for an older popup is discarded when it finishes
+    request.generation = open_with_generation.fetch_add(1) + 1;
+    request.path = path;
+    request.type = type;
+    request.job = job;
+
+    {
+        const std::scoped_lock<std::mutex> lock(open_with_lock);
+        open_with_pending = std::move(request);
+    }
+    open_with_cond.notify_one();
+}
+
+void
+ptk_file_menu_check_writable(const std::shared_ptr<vfs::dir>& dir)
+{
+    open_with_start_worker();
+
+    {
+        const std::scoped_lock<std::mutex> lock(open_with_lock);
+        for (const auto& pending : writable_pending)
+        {
+            if (pending.first == dir->path())
+            {
+                // a burst of changes needs one check
+                return;
+            }
+        }
+        writable_pending.emplace_back(dir->path(), dir);
+    }
+    open_with_cond.notify_one();
+}
+
 static void
 ptk_file_menu_free(PtkFileMenu* data)
 {
@@ -1036,32 +1356,12 @@ ptk_file_menu_new(PtkFileBrowser* browser,
     // clang-format on
 
     const bool is_dir = (file && file->is_directory());
-    // Note: network filesystems may become unresponsive here
-    const bool is_text = file && file->is_text();
 
-    // test R/W access to cwd instead of selected file
-    // Note: network filesystems may become unresponsive here
-    // const i32 no_read_access = faccessat(0, cwd, R_OK, AT_EACCESS);
-    const i32 no_write_access = faccessat(0, cwd.c_str(), W_OK, AT_EACCESS);
+    // test write access to cwd instead of selected file, cached by the dir
+    const bool no_write_access = browser->dir_ && !browser->dir_->is_writable();
 
-#if (GTK_MAJOR_VERSION == 4)
-    ztd::logger::debug("TODO - PORT - GdkClipboard");
-    bool is_clip = false;
-#elif (GTK_MAJOR_VERSION == 3)
-    GtkClipboard* clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
-    bool is_clip;
-    if (!gtk_clipboard_wait_is_target_available(
-            clip,
-            gdk_atom_intern("x-special/gnome-copied-files", false)) &&
-        !gtk_clipboard_wait_is_target_available(clip, gdk_atom_intern("text/uri-list", false)))
-    {
-        is_clip = false;
-    }
-    else
-    {
-        is_clip = true;
-    }
-#endif
+    // targets announced by the clipboard owner, no round-trip
+    const bool is_clip = ptk_clipboard_has_files();
 
     const panel_t p = browser->panel();
 
@@ -1070,13 +1370,11 @@ ptk_file_menu_new(PtkFileBrowser* browser,
     const tab_t tab_count = counts.tab_count;
     const tab_t tab_num = counts.tab_num;
 
-    // Get mime type and apps
+    // Get mime type, apps are looked up by open_with_thread()
     std::shared_ptr<vfs::mime_type> mime_type = nullptr;
-    std::vector<std::string> apps{};
     if (file)
     {
         mime_type = file->mime_type();
-        apps = mime_type->actions();
     }
 
     xset_t set_radio;
@@ -1195,108 +1493,68 @@ ptk_file_menu_new(PtkFileBrowser* browser,
             }
         }
 
-        GtkWidget* app_menu_item;
-
-        i32 icon_w;
-        i32 icon_h;
+        // apps and Edit are inserted before this once found, see on_open_with_ready()
+        GtkWidget* anchor = gtk_separator_menu_item_new();
+        gtk_widget_set_no_show_all(anchor, true);
+        gtk_menu_shell_append(GTK_MENU_SHELL(submenu), anchor);
 
-        // add apps
-        gtk_icon_size_lookup(GtkIconSize::GTK_ICON_SIZE_MENU, &icon_w, &icon_h);
-        if (is_text)
-        {
-            const auto txt_type = vfs_mime_type_get_from_type(XDG_MIME_TYPE_PLAIN_TEXT);
-            const std::vector<std::string> txt_apps = txt_type->actions();
-            if (!txt_apps.empty())
-            {
-                apps = ztd::merge(apps, txt_apps);
-            }
-        }
-        if (!apps.empty())
-        {
-            for (const std::string_view app : apps)
-            {
-                const auto desktop = vfs::desktop::create(app);
-                const auto app_name = desktop->display_name();
-                if (!app_name.empty())
-                {
-                    app_menu_item = gtk_menu_item_new_with_label(app_name.data());
-                }
-                else
-                {
-                    app_menu_item = gtk_menu_item_new_with_label(app.data());
-                }
-
-                gtk_container_add(GTK_CONTAINER(submenu), app_menu_item);
-
-                // clang-format off
-                g_object_set_data(G_OBJECT(app_menu_item), "menu", submenu);
-                g_object_set_data_full(G_OBJECT(app_menu_item), "desktop_file", ztd::strdup(app.data()), free);
+        data->open_with = std::make_shared<ptk::file_menu::open_with_job>();
+        data->open_with->data = data;
+        data->open_with->submenu = submenu;
+        data->open_with->anchor = anchor;
+        data->open_with->accel_group = accel_group;
+        data->open_with->add_edit = !is_dir && sel_files.size() == 1;
 
-                g_signal_connect(G_OBJECT(app_menu_item), "activate", G_CALLBACK(on_popup_run_app), (void*)data);
-                g_signal_connect(G_OBJECT(app_menu_item), "button-press-event", G_CALLBACK(on_app_button_press), (void*)data);
-                g_signal_connect(G_OBJECT(app_menu_item), "button-release-event", G_CALLBACK(on_app_button_press), (void*)data);
-                // clang-format off
-            }
-        }
+        open_with_request_apps(file->path(), mime_type->type(), data->open_with);
 
-        // Edit / Dir
-        if ((is_dir && browser) || (is_text && sel_files.size() == 1))
+        // Dir
+        if (is_dir && browser)
         {
             item = GTK_MENU_ITEM(gtk_separator_menu_item_new());
             gtk_menu_shell_append(GTK_MENU_SHELL(submenu), GTK_WIDGET(item));
 
-            if (is_text)
+            // Open Dir
+            set = xset_get(xset::name::opentab_prev);
+            xset_set_cb(set, (GFunc)on_open_in_tab, data);
+            xset_set_ob1_int(set, "tab", tab_control_code_prev);
+            set->disable = (tab_num == 1);
+            set = xset_get(xset::name::opentab_next);
+            xset_set_cb(set, (GFunc)on_open_in_tab, data);
+            xset_set_ob1_int(set, "tab", tab_control_code_next);
+            set->disable = (tab_num == tab_count);
+            set = xset_get(xset::name::opentab_new);
+            xset_set_cb(set, (GFunc)on_popup_open_in_new_tab_activate, data);
+            for (tab_t tab : TABS)
             {
-                // Edit
-                set = xset_get(xset::name::open_edit);
-                xset_set_cb(set, (GFunc)on_file_edit, data);
-                xset_add_menuitem(browser, submenu, accel_group, set);
-            }
-            else if (browser && is_dir)
-            {
-                // Open Dir
-                set = xset_get(xset::name::opentab_prev);
-                xset_set_cb(set, (GFunc)on_open_in_tab, data);
-                xset_set_ob1_int(set, "tab", tab_control_code_prev);
-                set->disable = (tab_num == 1);
-                set = xset_get(xset::name::opentab_next);
+                const std::string name = fmt::format("opentab_{}", tab);
+                set = xset_get(name);
                 xset_set_cb(set, (GFunc)on_open_in_tab, data);
-                xset_set_ob1_int(set, "tab", tab_control_code_next);
-                set->disable = (tab_num == tab_count);
-                set = xset_get(xset::name::opentab_new);
-                xset_set_cb(set, (GFunc)on_popup_open_in_new_tab_activate, data);
-                for (tab_t tab : TABS)
-                {
-                    const std::string name = fmt::format("opentab_{}", tab);
-                    set = xset_get(name);
-                    xset_set_cb(set, (GFunc)on_open_in_tab, data);
-                    xset_set_ob1_int(set, "tab", tab);
-                    set->disable = (tab > tab_count) || (tab == tab_num);
-                }
+                xset_set_ob1_int(set, "tab", tab);
+                set->disable = (tab > tab_count) || (tab == tab_num);
+            }
 
-                set = xset_get(xset::name::open_in_panel_prev);
-                xset_set_cb(set, (GFunc)on_open_in_panel, data);
-                xset_set_ob1_int(set, "panel", panel_control_code_prev);
-                set->disable = (panel_count == 1);
-                set = xset_get(xset::name::open_in_panel_next);
-                xset_set_cb(set, (GFunc)on_open_in_panel, data);
-                xset_set_ob1_int(set, "panel", panel_control_code_next);
-                set->disable = (panel_count == 1);
+            set = xset_get(xset::name::open_in_panel_prev);
+            xset_set_cb(set, (GFunc)on_open_in_panel, data);
+            xset_set_ob1_int(set, "panel", panel_control_code_prev);
+            set->disable = (panel_count == 1);
+            set = xset_get(xset::name::open_in_panel_next);
+            xset_set_cb(set, (GFunc)on_open_in_panel, data);
+            xset_set_ob1_int(set, "panel", panel_control_code_next);
+            set->disable = (panel_count == 1);
 
-                for (panel_t panel : PANELS)
-                {
-                    const std::string name = fmt::format("open_in_panel{}", panel);
-                    set = xset_get(name);
-                    xset_set_cb(set, (GFunc)on_open_in_panel, data);
-                    xset_set_ob1_int(set, "panel", panel);
-                    // set->disable = ( p == i );
-                }
-
-                set = xset_get(xset::name::open_in_tab);
-                xset_add_menuitem(browser, submenu, accel_group, set);
-                set = xset_get(xset::name::open_in_panel);
-                xset_add_menuitem(browser, submenu, accel_group, set);
+            for (panel_t panel : PANELS)
+            {
+                const std::string name = fmt::format("open_in_panel{}", panel);
+                set = xset_get(name);
+                xset_set_cb(set, (GFunc)on_open_in_panel, data);
+                xset_set_ob1_int(set, "panel", panel);
+                // set->disable = ( p == i );
             }
+
+            set = xset_get(xset::name::open_in_tab);
+            xset_add_menuitem(browser, submenu, accel_group, set);
+            set = xset_get(xset::name::open_in_panel);
+            xset_add_menuitem(browser, submenu, accel_group, set);
         }
 
         if (set_archive_extract)
@@ -1463,6 +1721,11 @@ ptk_file_menu_new(PtkFileBrowser* browser,
         set->disable = set_disable;
         xset_set_cb(xset::name::select_invert, (GFunc)ptk_file_browser_invert_selection, browser);
         xset_set_cb(xset::name::select_patt, (GFunc)on_popup_select_pattern, data);
+        xset_set_cb(xset::name::select_filter, (GFunc)on_popup_select_filter, data);
+        xset_set_cb(xset::name::select_compare, (GFunc)on_popup_select_compare, data);
+        xset_set_cb(xset::name::select_compare_content,
+                    (GFunc)on_popup_select_compare_content,
+                    data);
 
         static constexpr std::array<xset::name, 40> copycmds{
             xset::name::copy_loc,        xset::name::copy_loc_last,   xset::name::copy_tab_prev,
@@ -1488,6 +1751,21 @@ ptk_file_menu_new(PtkFileBrowser* browser,
             xset_set_ob1(set, "set", set->name.data());
         }
 
+        for (const xset::name synccmd : {xset::name::sync_panel_next,
+                                         xset::name::sync_panel_mirror,
+                                         xset::name::sync_panel_both})
+        {
+            set = xset_get(synccmd);
+            xset_set_cb(set, (GFunc)on_synccmd, data);
+            xset_set_ob1(set, "set", set->name.data());
+            set->disable = set_disable || (panel_count < 2);
+        }
+
+        // without a selection the current dir is searched
+        set = xset_get(xset::name::find_dups);
+        xset_set_cb(set, (GFunc)on_find_dups, data);
+        set->disable = !browser;
+
         // enables
         set = xset_get(xset::name::copy_loc_last);
         set2 = xset_get(xset::name::move_loc_last);
@@ -1893,8 +2171,8 @@ app_job(GtkWidget* item, GtkWidget* app_item)
                     "<!-- This file was generated by SpaceFM to allow you to change the name or icon\n"
                     "     of the above mime type and to change the filename or magic patterns that\n"
                     "     define this type.\n\n"
-                    "     IMPORTANT:  After saving this file, restart SpaceFM. You may need to run:\n"
-                    "     update-mime-database ~/.local/share/mime\n\n"
+                    "     Changes apply in SpaceFM as soon as this file is saved. Other programs\n"
+                    "     only see them after running:  update-mime-database ~/.local/share/mime\n\n"
                     "     Delete this file from ~/.local/share/mime/packages/ to revert to default.\n\n"
                     "     To make this definition file apply to all users, copy this file to\n"
                     "     /usr/share/mime/packages/ and:  sudo update-mime-database /usr/share/mime\n\n"
@@ -31,6 +31,7 @@
 
 #include "ptk/ptk-file-browser.hxx"
 
+#include "vfs/vfs-dir.hxx"
 #include "vfs/vfs-file.hxx"
 
 /* sel_files is a list containing vfs::file structures
@@ -38,6 +39,11 @@
  * free the list after calling this function.
  */
 
+namespace ptk::file_menu
+{
+    struct open_with_job;
+}
+
 struct PtkFileMenu
 {
     PtkFileMenu() = default;
@@ -48,6 +54,8 @@ struct PtkFileMenu
     std::filesystem::path file_path{};
     std::shared_ptr<vfs::file> file{nullptr};
     std::vector<std::shared_ptr<vfs::file>> sel_files;
+    // pending Open submenu lookup, released with the menu
+    std::shared_ptr<ptk::file_menu::open_with_job> open_with{nullptr};
 #if (GTK_MAJOR_VERSION == 4)
     GtkEventController* accel_group{nullptr};
 #elif (GTK_MAJOR_VERSION == 3)
@@ -66,6 +74,9 @@ struct AutoOpenCreate : public std::enable_shared_from_this<AutoOpenCreate>
 };
 
 GtkWidget* ptk_file_menu_new(PtkFileBrowser* browser);
+
+// checks write access to dir on the Open submenu worker, the answer is cached by the dir
+void ptk_file_menu_check_writable(const std::shared_ptr<vfs::dir>& dir);
 GtkWidget* ptk_file_menu_new(PtkFileBrowser* browser,
                              const std::span<const std::shared_ptr<vfs::file>> sel_files);
 
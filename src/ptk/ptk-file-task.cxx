@@ -49,6 +49,7 @@
 
 #include "vfs/vfs-time.hxx"
 #include "vfs/vfs-utils.hxx"
+#include "vfs/vfs-unique-name.hxx"
 
 #include "ptk/ptk-task-view.hxx"
 
@@ -102,6 +103,8 @@ PtkFileTask::PtkFileTask(const vfs::file_task::type type,
     this->log_end = gtk_text_mark_new(nullptr, false);
     gtk_text_buffer_get_end_iter(this->log_buf, &iter);
     gtk_text_buffer_add_mark(this->log_buf, this->log_end, &iter);
+    // vfs::task_log::level::error records
+    gtk_text_buffer_create_tag(this->log_buf, "error", "foreground", "red", nullptr);
     this->log_appended = false;
     this->restart_timeout = false;
 
@@ -162,25 +165,18 @@ PtkFileTask::~PtkFileTask()
     }
     if (this->task->type_ == vfs::file_task::type::exec)
     {
-        // ztd::logger::info("    g_io_channel_shutdown");
-        // channel shutdowns are needed to stop channel reads after task ends.
+        // stopping the output reader is needed to stop pipe reads after task ends.
         // Cannot be placed in cb_exec_child_watch because it causes single
         // line output to be lost
-        if (this->task->exec_channel_out)
+        if (this->task->exec_output)
         {
-            g_io_channel_shutdown(this->task->exec_channel_out, true, nullptr);
+            this->task->exec_output->stop();
         }
-        if (this->task->exec_channel_err)
-        {
-            g_io_channel_shutdown(this->task->exec_channel_err, true, nullptr);
-        }
-        this->task->exec_channel_out = this->task->exec_channel_err = nullptr;
         if (this->task->child_watch)
         {
             g_source_remove(this->task->child_watch);
             this->task->child_watch = 0;
         }
-        // ztd::logger::info("    g_io_channel_shutdown DONE");
     }
 
     gtk_text_buffer_set_text(this->log_buf, "", -1);
@@ -743,7 +739,9 @@ set_progress_icon(PtkFileTask* ptask)
     else if (task->type_ == vfs::file_task::type::move ||
              task->type_ == vfs::file_task::type::copy ||
              task->type_ == vfs::file_task::type::link ||
-             task->type_ == vfs::file_task::type::trash)
+             task->type_ == vfs::file_task::type::trash ||
+             task->type_ == vfs::file_task::type::rename ||
+             task->type_ == vfs::file_task::type::sync)
     {
         icon = "stock_copy";
     }
@@ -795,6 +793,9 @@ ptk_file_task_progress_open(PtkFileTask* ptask)
         {vfs::file_task::type::link, "Link: "},
         {vfs::file_task::type::chmod_chown, "Change: "},
         {vfs::file_task::type::exec, "Run: "},
+        {vfs::file_task::type::rename, "Rename: "},
+        {vfs::file_task::type::sync, "Sync: "},
+        {vfs::file_task::type::find_dups, "Find Duplicates: "},
     };
     const std::map<vfs::file_task::type, const std::string_view> job_titles{
         {vfs::file_task::type::move, "Moving..."},
@@ -804,6 +805,9 @@ ptk_file_task_progress_open(PtkFileTask* ptask)
         {vfs::file_task::type::link, "Linking..."},
         {vfs::file_task::type::chmod_chown, "Changing..."},
         {vfs::file_task::type::exec, "Running..."},
+        {vfs::file_task::type::rename, "Renaming..."},
+        {vfs::file_task::type::sync, "Syncing..."},
+        {vfs::file_task::type::find_dups, "Searching..."},
     };
 
     if (ptask->progress_dlg)
@@ -1560,6 +1564,13 @@ ptk_file_task_set_recursive(PtkFileTask* ptask, bool recursive)
     ptask->task->set_recursive(recursive);
 }
 
+void
+ptk_file_task_set_sync(PtkFileTask* ptask, const vfs::file_task::sync_mode mode,
+                       bool compare_content)
+{
+    ptask->task->set_sync(mode, compare_content);
+}
+
 static void
 ptk_file_task_update(PtkFileTask* ptask)
 {
@@ -1591,15 +1602,10 @@ ptk_file_task_update(PtkFileTask* ptask)
                 task->child_watch = 0;
             }
             g_spawn_close_pid(task->exec_pid);
-            if (task->exec_channel_out)
-            {
-                g_io_channel_shutdown(task->exec_channel_out, true, nullptr);
-            }
-            if (task->exec_channel_err)
+            if (task->exec_output)
             {
-                g_io_channel_shutdown(task->exec_channel_err, true, nullptr);
+                task->exec_output->stop();
             }
-            task->exec_channel_out = task->exec_channel_err = nullptr;
             if (status)
             {
                 if (WIFEXITED(status))
@@ -1823,20 +1829,50 @@ ptk_file_task_update(PtkFileTask* ptask)
         ptask->dsp_avgest = remain2;
     }
 
-    // move log lines from add_log_buf to log_buf
-    if (gtk_text_buffer_get_char_count(task->add_log_buf))
+    // move log records from the task to log_buf, one insert per run of records
+    // with the same level, errors are shown in red
+    if (!task->add_log.empty())
     {
         GtkTextIter iter, siter;
-        char* text;
-        // get add_log text and delete
-        gtk_text_buffer_get_start_iter(task->add_log_buf, &siter);
-        gtk_text_buffer_get_iter_at_mark(task->add_log_buf, &iter, task->add_log_end);
-        text = gtk_text_buffer_get_text(task->add_log_buf, &siter, &iter, false);
-        gtk_text_buffer_delete(task->add_log_buf, &siter, &iter);
+
+        std::vector<vfs::task_log::record> records;
+        task->add_log.drain(records);
+
+        const u64 dropped = task->add_log.take_dropped();
+        if (dropped)
+        {
+            records.push_back(
+                {vfs::task_log::level::info,
+                 fmt::format("[ {} messages were dropped, the task log was full ]\n", dropped)});
+        }
+
         // insert into log
         gtk_text_buffer_get_iter_at_mark(ptask->log_buf, &iter, ptask->log_end);
-        gtk_text_buffer_insert(ptask->log_buf, &iter, text, -1);
-        std::free(text);
+        for (usize i = 0; i < records.size();)
+        {
+            const vfs::task_log::level level = records[i].level;
+            std::string text;
+            for (; i < records.size() && records[i].level == level; ++i)
+            {
+                text.append(records[i].msg);
+            }
+
+            switch (level)
+            {
+                case vfs::task_log::level::error:
+                    gtk_text_buffer_insert_with_tags_by_name(ptask->log_buf,
+                                                             &iter,
+                                                             text.data(),
+                                                             text.size(),
+                                                             "error",
+                                                             nullptr);
+                    break;
+                case vfs::task_log::level::info:
+                case vfs::task_log::level::output:
+                    gtk_text_buffer_insert(ptask->log_buf, &iter, text.data(), text.size());
+                    break;
+            }
+        }
         ptask->log_appended = true;
 
         // trim log ?  (less than 64K and 800 lines)
@@ -2430,8 +2466,12 @@ query_overwrite(PtkFileTask* ptask)
 
     const auto filename_parts = split_basename_extension(filename);
 
-    const std::string unique_name =
-        vfs_get_unique_name(dest_dir, filename_parts.basename, filename_parts.extension);
+    // only a suggestion, the name is not reserved
+    const std::string unique_name = vfs::unique_name::get(dest_dir,
+                                                          filename_parts.basename,
+                                                          filename_parts.extension,
+                                                          vfs::unique_name::style::copy,
+                                                          false);
     const std::string new_name_plain =
         !unique_name.empty() ? std::filesystem::path(unique_name).filename() : "";
     const std::string new_name = !new_name_plain.empty() ? new_name_plain : "";
@@ -134,6 +134,9 @@ void ptk_file_task_set_chown(PtkFileTask* ptask, uid_t uid, gid_t gid);
 
 void ptk_file_task_set_recursive(PtkFileTask* ptask, bool recursive);
 
+void ptk_file_task_set_sync(PtkFileTask* ptask, const vfs::file_task::sync_mode mode,
+                            bool compare_content);
+
 void ptk_file_task_run(PtkFileTask* ptask);
 
 bool ptk_file_task_cancel(PtkFileTask* ptask);
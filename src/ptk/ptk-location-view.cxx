@@ -24,9 +24,12 @@
 #include <filesystem>
 
 #include <vector>
+#include <unordered_map>
 
 #include <memory>
 
+#include <utility>
+
 #include <ranges>
 
 #include <glibmm.h>
@@ -60,17 +63,48 @@
 // This limits the small icon size for side panes and task list
 inline constexpr i32 PANE_MAX_ICON_SIZE = 48;
 
+// attributes of a row that need to be refreshed
+inline constexpr u8 DIRTY_VISIBLE = 0b0001;
+inline constexpr u8 DIRTY_NAME = 0b0010;
+inline constexpr u8 DIRTY_PATH = 0b0100;
+inline constexpr u8 DIRTY_ICON = 0b1000;
+inline constexpr u8 DIRTY_ALL = DIRTY_VISIBLE | DIRTY_NAME | DIRTY_PATH | DIRTY_ICON;
+
 static GtkTreeModel* model = nullptr;
 static i32 n_vols = 0;
 
+// GtkListStore iters stay valid across inserts, removals and sorting, so every
+// row is found through this index instead of walking the model. The column
+// values are kept to only touch the cells that really changed.
+struct LocationRow
+{
+    GtkTreeIter it;
+    std::string name{};
+    std::string path{};
+    std::string icon{}; // empty forces a reload
+};
+static std::unordered_map<const vfs::volume*, LocationRow> rows;
+
+// settings changes are collected and applied in one batch from an idle callback,
+// volume changes already arrive batched as a vfs::volume_delta
+struct PendingUpdate
+{
+    std::shared_ptr<vfs::volume> volume{nullptr};
+    u8 dirty{0};
+};
+static std::unordered_map<const vfs::volume*, PendingUpdate> pending_updates;
+static u32 pending_source_id = 0;
+
 static void ptk_location_view_init_model(GtkListStore* list);
 
-static void on_volume_event(const std::shared_ptr<vfs::volume>& vol, const vfs::volume::state state,
+static void on_volume_event(const std::shared_ptr<const vfs::volume_delta>& delta,
                             void* user_data);
 
 static void add_volume(const std::shared_ptr<vfs::volume>& vol, bool set_icon);
 static void remove_volume(const std::shared_ptr<vfs::volume>& vol);
-static void update_volume(const std::shared_ptr<vfs::volume>& vol);
+static void update_volume(const std::shared_ptr<vfs::volume>& vol, u8 dirty);
+static void apply_update(const std::shared_ptr<vfs::volume>& vol, u8 dirty);
+static void queue_update(const std::shared_ptr<vfs::volume>& vol, u8 dirty);
 
 static bool on_button_press_event(GtkTreeView* view, GdkEvent* event, void* user_data);
 static bool on_key_press_event(GtkWidget* w, GdkEvent* event, PtkFileBrowser* file_browser);
@@ -136,6 +170,25 @@ on_model_destroy(void* data, GObject* object)
 
     model = nullptr;
     n_vols = 0;
+
+    rows.clear();
+    pending_updates.clear();
+    if (pending_source_id != 0)
+    {
+        g_source_remove(pending_source_id);
+        pending_source_id = 0;
+    }
+}
+
+static i32
+location_icon_size()
+{
+    i32 icon_size = app_settings.icon_size_small();
+    if (icon_size > PANE_MAX_ICON_SIZE)
+    {
+        icon_size = PANE_MAX_ICON_SIZE;
+    }
+    return icon_size;
 }
 
 void
@@ -146,35 +199,17 @@ update_volume_icons()
         return;
     }
 
-    GtkTreeIter it;
-
-    // GtkListStore* list = GTK_LIST_STORE( model );
-    i32 icon_size = app_settings.icon_size_small();
-    if (icon_size > PANE_MAX_ICON_SIZE)
+    // the icon size changed, reload every icon
+    for (auto& row : rows | std::views::values)
     {
-        icon_size = PANE_MAX_ICON_SIZE;
+        row.icon.clear();
     }
-
-    if (gtk_tree_model_get_iter_first(model, &it))
+    for (const auto& volume : vfs_volume_get_all_volumes())
     {
-        do
+        if (volume && rows.contains(volume.get()))
         {
-            std::shared_ptr<vfs::volume> vol = nullptr;
-            gtk_tree_model_get(model, &it, ptk::location_view::column::data, &vol, -1);
-            if (vol)
-            {
-                GdkPixbuf* icon = vfs_load_icon(vol->icon(), icon_size);
-                gtk_list_store_set(GTK_LIST_STORE(model),
-                                   &it,
-                                   ptk::location_view::column::icon,
-                                   icon,
-                                   -1);
-                if (icon)
-                {
-                    g_object_unref(icon);
-                }
-            }
-        } while (gtk_tree_model_iter_next(model, &it));
+            queue_update(volume, DIRTY_ICON);
+        }
     }
 }
 
@@ -194,8 +229,12 @@ update_change_detection()
                     PTK_FILE_BROWSER_REINTERPRET(gtk_notebook_get_nth_page(notebook, i));
                 if (file_browser)
                 {
-                    // update current dir change detection
-                    file_browser->dir_->update_avoid_changes();
+                    // update current dir change detection, a deferred tab has
+                    // no dir yet and checks this when the dir is loaded
+                    if (!file_browser->is_deferred())
+                    {
+                        file_browser->dir_->update_avoid_changes();
+                    }
                     // update thumbnail visibility
                     file_browser->show_thumbnails(
                         app_settings.show_thumbnail() ? app_settings.max_thumb_size() : 0);
@@ -213,40 +252,11 @@ update_all()
         return;
     }
 
-    std::shared_ptr<vfs::volume> v = nullptr;
-
     for (const auto& volume : vfs_volume_get_all_volumes())
     {
         if (volume)
         {
-            bool havevol = false;
-
-            // search model for volume vol
-            GtkTreeIter it;
-            if (gtk_tree_model_get_iter_first(model, &it))
-            {
-                do
-                {
-                    gtk_tree_model_get(model, &it, ptk::location_view::column::data, &v, -1);
-                } while (v != volume && gtk_tree_model_iter_next(model, &it));
-                havevol = (v == volume);
-            }
-
-            if (volume_is_visible(volume))
-            {
-                if (havevol)
-                {
-                    update_volume(volume);
-                }
-                else
-                {
-                    add_volume(volume, true);
-                }
-            }
-            else if (havevol)
-            {
-                remove_volume(volume);
-            }
+            queue_update(volume, DIRTY_VISIBLE);
         }
     }
 }
@@ -254,7 +264,6 @@ update_all()
 static void
 update_names()
 {
-    std::shared_ptr<vfs::volume> v = nullptr;
     for (const auto& volume : vfs_volume_get_all_volumes())
     {
         if (!volume)
@@ -264,18 +273,9 @@ update_names()
 
         volume->set_info();
 
-        // search model for volume vol
-        GtkTreeIter it;
-        if (gtk_tree_model_get_iter_first(model, &it))
+        if (rows.contains(volume.get()))
         {
-            do
-            {
-                gtk_tree_model_get(model, &it, ptk::location_view::column::data, &v, -1);
-            } while (v != volume && gtk_tree_model_iter_next(model, &it));
-            if (v == volume)
-            {
-                update_volume(volume);
-            }
+            queue_update(volume, DIRTY_NAME);
         }
     }
 }
@@ -359,14 +359,9 @@ on_row_activated(GtkTreeView* view, GtkTreePath* tree_path, GtkTreeViewColumn* c
         try_mount(view, vol);
         if (vol->is_mounted())
         {
-            const auto mount_point = vol->mount_point();
-            if (!mount_point.empty())
+            if (!vol->mount_point().empty())
             {
-                gtk_list_store_set(GTK_LIST_STORE(model),
-                                   &it,
-                                   ptk::location_view::column::path,
-                                   mount_point.data(),
-                                   -1);
+                update_volume(vol, DIRTY_PATH);
             }
         }
     }
@@ -434,9 +429,8 @@ ptk_location_view_init_model(GtkListStore* list)
             continue;
         }
 
-        add_volume(volume, false);
+        add_volume(volume, true);
     }
-    update_volume_icons();
 }
 
 GtkWidget*
@@ -508,33 +502,118 @@ ptk_location_view_new(PtkFileBrowser* file_browser)
     return view;
 }
 
+static u8
+delta_dirty(u8 changed)
+{
+    u8 dirty = 0;
+    if (changed & VOLUME_CHANGED_NAME)
+    {
+        dirty |= DIRTY_NAME;
+    }
+    if (changed & VOLUME_CHANGED_MOUNT)
+    {
+        dirty |= DIRTY_PATH | DIRTY_VISIBLE;
+    }
+    if (changed & VOLUME_CHANGED_ICON)
+    {
+        dirty |= DIRTY_ICON;
+    }
+    if (changed & VOLUME_CHANGED_VISIBLE)
+    {
+        dirty |= DIRTY_VISIBLE;
+    }
+    return dirty;
+}
+
 static void
-on_volume_event(const std::shared_ptr<vfs::volume>& vol, const vfs::volume::state state,
-                void* user_data)
+on_volume_event(const std::shared_ptr<const vfs::volume_delta>& delta, void* user_data)
 {
     (void)user_data;
-    switch (state)
+
+    if (!model)
     {
-        case vfs::volume::state::added:
-            add_volume(vol, true);
-            break;
-        case vfs::volume::state::removed:
-            remove_volume(vol);
-            break;
-        case vfs::volume::state::changed: // CHANGED may occur before ADDED !
-            if (!volume_is_visible(vol))
-            {
-                remove_volume(vol);
-            }
-            else
+        return;
+    }
+
+    for (const auto& entry : delta->entries)
+    {
+        switch (entry.state)
+        {
+            case vfs::volume::state::added:
+                apply_update(entry.volume, DIRTY_ALL);
+                break;
+            case vfs::volume::state::changed:
+                apply_update(entry.volume, delta_dirty(entry.changed));
+                break;
+            case vfs::volume::state::removed:
+                // the row only holds a raw pointer, the delta keeps the volume
+                // alive until the row is gone
+                remove_volume(entry.volume);
+                break;
+            case vfs::volume::state::mounted:
+            case vfs::volume::state::unmounted:
+            case vfs::volume::state::eject:
+                break;
+        }
+    }
+}
+
+static void
+apply_update(const std::shared_ptr<vfs::volume>& vol, u8 dirty)
+{
+    if (!rows.contains(vol.get()))
+    {
+        add_volume(vol, true);
+    }
+    else if ((dirty & DIRTY_VISIBLE) && !volume_is_visible(vol))
+    {
+        remove_volume(vol);
+    }
+    else
+    {
+        update_volume(vol, dirty);
+    }
+}
+
+static void
+flush_updates()
+{
+    if (!model)
+    {
+        pending_updates.clear();
+        return;
+    }
+
+    const auto updates = std::exchange(pending_updates, {});
+    for (const auto& update : updates | std::views::values)
+    {
+        apply_update(update.volume, update.dirty);
+    }
+}
+
+static void
+queue_update(const std::shared_ptr<vfs::volume>& vol, u8 dirty)
+{
+    if (!vol)
+    {
+        return;
+    }
+
+    auto& update = pending_updates[vol.get()];
+    update.volume = vol;
+    update.dirty |= dirty;
+
+    if (pending_source_id == 0)
+    {
+        pending_source_id = g_idle_add(
+            [](void* user_data) -> gboolean
             {
-                update_volume(vol);
-            }
-            break;
-        case vfs::volume::state::mounted:
-        case vfs::volume::state::unmounted:
-        case vfs::volume::state::eject:
-            break;
+                (void)user_data;
+                pending_source_id = 0;
+                flush_updates();
+                return G_SOURCE_REMOVE;
+            },
+            nullptr);
     }
 }
 
@@ -547,49 +626,42 @@ add_volume(const std::shared_ptr<vfs::volume>& vol, bool set_icon)
     }
 
     // sfm - vol already exists?
-    std::shared_ptr<vfs::volume> v = nullptr;
-    GtkTreeIter it;
-    if (gtk_tree_model_get_iter_first(model, &it))
-    {
-        do
-        {
-            gtk_tree_model_get(model, &it, ptk::location_view::column::data, &v, -1);
-        } while (v != vol && gtk_tree_model_iter_next(model, &it));
-    }
-    if (v == vol)
+    if (rows.contains(vol.get()))
     {
         return;
     }
 
-    // get mount point
-    const auto mount_point = vol->mount_point();
+    LocationRow row;
+    row.name = vol->display_name();
+    row.path = vol->mount_point();
 
     // add to model
     gtk_list_store_insert_with_values(GTK_LIST_STORE(model),
-                                      &it,
+                                      &row.it,
                                       0,
                                       ptk::location_view::column::name,
-                                      vol->display_name().data(),
+                                      row.name.data(),
                                       ptk::location_view::column::path,
-                                      mount_point.data(),
+                                      row.path.data(),
                                       ptk::location_view::column::data,
                                       vol.get(),
                                       -1);
     if (set_icon)
     {
-        i32 icon_size = app_settings.icon_size_small();
-        if (icon_size > PANE_MAX_ICON_SIZE)
-        {
-            icon_size = PANE_MAX_ICON_SIZE;
-        }
+        row.icon = vol->icon();
 
-        GdkPixbuf* icon = vfs_load_icon(vol->icon(), icon_size);
-        gtk_list_store_set(GTK_LIST_STORE(model), &it, ptk::location_view::column::icon, icon, -1);
+        GdkPixbuf* icon = vfs_load_icon(row.icon, location_icon_size());
+        gtk_list_store_set(GTK_LIST_STORE(model),
+                           &row.it,
+                           ptk::location_view::column::icon,
+                           icon,
+                           -1);
         if (icon)
         {
             g_object_unref(icon);
         }
     }
+    rows.insert_or_assign(vol.get(), std::move(row));
     ++n_vols;
 }
 
@@ -601,65 +673,67 @@ remove_volume(const std::shared_ptr<vfs::volume>& vol)
         return;
     }
 
-    GtkTreeIter it;
-    std::shared_ptr<vfs::volume> v = nullptr;
-    if (gtk_tree_model_get_iter_first(model, &it))
-    {
-        do
-        {
-            gtk_tree_model_get(model, &it, ptk::location_view::column::data, &v, -1);
-        } while (v != vol && gtk_tree_model_iter_next(model, &it));
-    }
-    if (v != vol)
+    pending_updates.erase(vol.get());
+
+    const auto row = rows.find(vol.get());
+    if (row == rows.cend())
     {
         return;
     }
-    gtk_list_store_remove(GTK_LIST_STORE(model), &it);
+    gtk_list_store_remove(GTK_LIST_STORE(model), &row->second.it);
+    rows.erase(row);
     --n_vols;
 }
 
 static void
-update_volume(const std::shared_ptr<vfs::volume>& vol)
+update_volume(const std::shared_ptr<vfs::volume>& vol, u8 dirty)
 {
     if (!vol)
     {
         return;
     }
 
-    GtkTreeIter it;
-    std::shared_ptr<vfs::volume> v = nullptr;
-    if (gtk_tree_model_get_iter_first(model, &it))
-    {
-        do
-        {
-            gtk_tree_model_get(model, &it, ptk::location_view::column::data, &v, -1);
-        } while (v != vol && gtk_tree_model_iter_next(model, &it));
-    }
-    if (v != vol)
+    const auto found = rows.find(vol.get());
+    if (found == rows.cend())
     {
         add_volume(vol, true);
         return;
     }
+    auto& row = found->second;
 
-    i32 icon_size = app_settings.icon_size_small();
-    if (icon_size > PANE_MAX_ICON_SIZE)
+    // only set the cells whose value changed, setting the name re-sorts the store
+    if ((dirty & DIRTY_NAME) && row.name != vol->display_name())
     {
-        icon_size = PANE_MAX_ICON_SIZE;
+        row.name = vol->display_name();
+        gtk_list_store_set(GTK_LIST_STORE(model),
+                           &row.it,
+                           ptk::location_view::column::name,
+                           row.name.data(),
+                           -1);
     }
-
-    GdkPixbuf* icon = vfs_load_icon(vol->icon(), icon_size);
-    gtk_list_store_set(GTK_LIST_STORE(model),
-                       &it,
-                       ptk::location_view::column::icon,
-                       icon,
-                       ptk::location_view::column::name,
-                       vol->display_name().data(),
-                       ptk::location_view::column::path,
-                       vol->mount_point().data(),
-                       -1);
-    if (icon)
+    if ((dirty & DIRTY_PATH) && row.path != vol->mount_point())
     {
-        g_object_unref(icon);
+        row.path = vol->mount_point();
+        gtk_list_store_set(GTK_LIST_STORE(model),
+                           &row.it,
+                           ptk::location_view::column::path,
+                           row.path.data(),
+                           -1);
+    }
+    if ((dirty & DIRTY_ICON) && (row.icon.empty() || row.icon != vol->icon()))
+    {
+        row.icon = vol->icon();
+
+        GdkPixbuf* icon = vfs_load_icon(row.icon, location_icon_size());
+        gtk_list_store_set(GTK_LIST_STORE(model),
+                           &row.it,
+                           ptk::location_view::column::icon,
+                           icon,
+                           -1);
+        if (icon)
+        {
+            g_object_unref(icon);
+        }
     }
 }
 
@@ -1079,6 +1079,9 @@ main_task_view_update_task(PtkFileTask* ptask)
         {vfs::file_task::type::link, "linking"},
         {vfs::file_task::type::chmod_chown, "changing"},
         {vfs::file_task::type::exec, "running"},
+        {vfs::file_task::type::rename, "renaming"},
+        {vfs::file_task::type::sync, "syncing"},
+        {vfs::file_task::type::find_dups, "searching"},
     };
 
     if (!ptask)
@@ -1233,7 +1236,8 @@ main_task_view_update_task(PtkFileTask* ptask)
             }
             else if (ptask->task->type_ == vfs::file_task::type::move ||
                      ptask->task->type_ == vfs::file_task::type::copy ||
-                     ptask->task->type_ == vfs::file_task::type::link)
+                     ptask->task->type_ == vfs::file_task::type::link ||
+                     ptask->task->type_ == vfs::file_task::type::sync)
             {
                 pixbuf = vfs_load_icon("stock_copy", 22);
             }
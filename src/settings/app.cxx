@@ -59,6 +59,30 @@ AppSettings::max_thumb_size(u32 val) noexcept
     this->thumbnail_max_size_ = val;
 }
 
+u64
+AppSettings::thumbnail_cache_size() const noexcept
+{
+    return this->thumbnail_cache_size_;
+}
+
+void
+AppSettings::thumbnail_cache_size(u64 val) noexcept
+{
+    this->thumbnail_cache_size_ = val;
+}
+
+u64
+AppSettings::dir_cache_size() const noexcept
+{
+    return this->dir_cache_size_;
+}
+
+void
+AppSettings::dir_cache_size(u64 val) noexcept
+{
+    this->dir_cache_size_ = val;
+}
+
 i32
 AppSettings::icon_size_big() const noexcept
 {
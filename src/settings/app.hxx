@@ -32,6 +32,12 @@ struct AppSettings
     [[nodiscard]] u32 max_thumb_size() const noexcept;
     void max_thumb_size(u32 val) noexcept;
 
+    [[nodiscard]] u64 thumbnail_cache_size() const noexcept;
+    void thumbnail_cache_size(u64 val) noexcept;
+
+    [[nodiscard]] u64 dir_cache_size() const noexcept;
+    void dir_cache_size(u64 val) noexcept;
+
     [[nodiscard]] i32 icon_size_big() const noexcept;
     void icon_size_big(i32 val) noexcept;
 
@@ -94,6 +100,11 @@ struct AppSettings
     bool show_thumbnails_{false};
     bool thumbnail_size_limit_{true};
     u32 thumbnail_max_size_{8 << 20}; // 8 MiB
+    // memory used by loaded thumbnails in all open dirs
+    u64 thumbnail_cache_size_{128 << 20}; // 128 MiB
+
+    // memory used to keep closed directories loaded
+    u64 dir_cache_size_{64 << 20}; // 64 MiB
 
     i32 icon_size_big_{48};
     i32 icon_size_small_{22};
@@ -72,6 +72,19 @@ config_parse_general(const toml::value& tbl, u64 version)
         app_settings.max_thumb_size(max_thumb_size << 10);
     }
 
+    if (section.contains(TOML_KEY_THUMBNAIL_CACHE_SIZE))
+    {
+        const auto thumbnail_cache_size =
+            toml::find<u64>(section, TOML_KEY_THUMBNAIL_CACHE_SIZE);
+        app_settings.thumbnail_cache_size(thumbnail_cache_size << 20);
+    }
+
+    if (section.contains(TOML_KEY_DIR_CACHE_SIZE))
+    {
+        const auto dir_cache_size = toml::find<u64>(section, TOML_KEY_DIR_CACHE_SIZE);
+        app_settings.dir_cache_size(dir_cache_size << 20);
+    }
+
     if (section.contains(TOML_KEY_ICON_SIZE_BIG))
     {
         const auto icon_size_big = toml::find<i32>(section, TOML_KEY_ICON_SIZE_BIG);
@@ -276,6 +276,8 @@ save_user_confing()
          toml::value{
              {TOML_KEY_SHOW_THUMBNAIL, app_settings.show_thumbnail()},
              {TOML_KEY_MAX_THUMB_SIZE, app_settings.max_thumb_size() >> 10},
+             {TOML_KEY_THUMBNAIL_CACHE_SIZE, app_settings.thumbnail_cache_size() >> 20},
+             {TOML_KEY_DIR_CACHE_SIZE, app_settings.dir_cache_size() >> 20},
              {TOML_KEY_ICON_SIZE_BIG, app_settings.icon_size_big()},
              {TOML_KEY_ICON_SIZE_SMALL, app_settings.icon_size_small()},
              {TOML_KEY_ICON_SIZE_TOOL, app_settings.icon_size_tool()},
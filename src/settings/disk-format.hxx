@@ -57,6 +57,8 @@ const std::string TOML_KEY_VERSION{"version"};
 
 const std::string TOML_KEY_SHOW_THUMBNAIL{"show_thumbnail"};
 const std::string TOML_KEY_MAX_THUMB_SIZE{"max_thumb_size"};
+const std::string TOML_KEY_THUMBNAIL_CACHE_SIZE{"thumbnail_cache_size"};
+const std::string TOML_KEY_DIR_CACHE_SIZE{"dir_cache_size"};
 const std::string TOML_KEY_ICON_SIZE_BIG{"icon_size_big"};
 const std::string TOML_KEY_ICON_SIZE_SMALL{"icon_size_small"};
 const std::string TOML_KEY_ICON_SIZE_TOOL{"icon_size_tool"};
@@ -200,6 +200,9 @@ namespace libudev
 
         [[nodiscard]] dev_t get_devnum() const noexcept;
 
+        // 0 unless the device was received from a monitor
+        [[nodiscard]] unsigned long long get_seqnum() const noexcept;
+
         [[nodiscard]] bool has_devtype() const noexcept;
         [[nodiscard]] const std::optional<std::string> get_devtype() const noexcept;
 
@@ -71,6 +71,12 @@ libudev::device::get_devnum() const noexcept
     return udev_device_get_devnum(this->handle.get());
 }
 
+unsigned long long
+libudev::device::get_seqnum() const noexcept
+{
+    return udev_device_get_seqnum(this->handle.get());
+}
+
 bool
 libudev::device::has_devtype() const noexcept
 {
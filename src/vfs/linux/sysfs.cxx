@@ -18,81 +18,105 @@
 
 #include <filesystem>
 
+#include <array>
+
 #include <optional>
 
-#include <glibmm.h>
+#include <charconv>
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <ztd/ztd.hxx>
 #include <ztd/ztd_logger.hxx>
 
 #include "vfs/linux/sysfs.hxx"
 
-const std::optional<std::string>
-vfs::linux::sysfs::get_string(const std::filesystem::path& dir, const std::string_view attribute)
+namespace
 {
-    const auto filename = dir / attribute;
-
-    std::string contents;
-    try
+    // attributes are read for every block device on each volume refresh, plain
+    // read() without exceptions keeps missing attributes cheap
+    const std::optional<std::string>
+    read_attribute(const std::filesystem::path& filename) noexcept
     {
-        contents = Glib::file_get_contents(filename);
+        const i32 fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+        {
+            return std::nullopt;
+        }
+
+        std::string contents;
+        std::array<char, 4096> buffer;
+        while (true)
+        {
+            const auto length = read(fd, buffer.data(), buffer.size());
+            if (length > 0)
+            {
+                contents.append(buffer.data(), length);
+                continue;
+            }
+            if (length == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            if (length == -1)
+            {
+                close(fd);
+                return std::nullopt;
+            }
+            break;
+        }
+        close(fd);
+
+        return contents;
     }
-    catch (const Glib::FileError& e)
+
+    template<typename T>
+    const std::optional<T>
+    read_number(const std::filesystem::path& filename) noexcept
     {
-        return std::nullopt;
+        const auto contents = read_attribute(filename);
+        if (!contents)
+        {
+            return std::nullopt;
+        }
+
+        T value;
+        const auto* first = contents->data();
+        const auto* last = contents->data() + contents->size();
+        const auto [ptr, ec] = std::from_chars(first, last, value);
+        if (ec != std::errc())
+        {
+            return std::nullopt;
+        }
+        return value;
     }
-    return contents;
+} // namespace
+
+const std::optional<std::string>
+vfs::linux::sysfs::get_string(const std::filesystem::path& dir, const std::string_view attribute)
+{
+    return read_attribute(dir / attribute);
 }
 
 const std::optional<i64>
 vfs::linux::sysfs::get_i64(const std::filesystem::path& dir, const std::string_view attribute)
 {
-    const auto filename = dir / attribute;
-
-    std::string contents;
-    try
-    {
-        contents = Glib::file_get_contents(filename);
-    }
-    catch (const Glib::FileError& e)
-    {
-        return std::nullopt;
-    }
-    return std::stoul(contents);
+    return read_number<i64>(dir / attribute);
 }
 
 const std::optional<u64>
 vfs::linux::sysfs::get_u64(const std::filesystem::path& dir, const std::string_view attribute)
 {
-    const auto filename = dir / attribute;
-
-    std::string contents;
-    try
-    {
-        contents = Glib::file_get_contents(filename);
-    }
-    catch (const Glib::FileError& e)
-    {
-        return std::nullopt;
-    }
-    return std::stoll(contents);
+    return read_number<u64>(dir / attribute);
 }
 
 const std::optional<f64>
 vfs::linux::sysfs::get_f64(const std::filesystem::path& dir, const std::string_view attribute)
 {
-    const auto filename = dir / attribute;
-
-    std::string contents;
-    try
-    {
-        contents = Glib::file_get_contents(filename);
-    }
-    catch (const Glib::FileError& e)
-    {
-        return std::nullopt;
-    }
-    return std::stod(contents);
+    return read_number<f64>(dir / attribute);
 }
 
 bool
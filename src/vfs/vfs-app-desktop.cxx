@@ -32,6 +32,7 @@
 
 #include <memory>
 
+#include <algorithm>
 #include <ranges>
 
 #include <gtkmm.h>
@@ -44,6 +45,7 @@
 #include "ptk/ptk-file-task.hxx"
 
 #include "vfs/vfs-utils.hxx"
+#include "vfs/vfs-launcher.hxx"
 #include "vfs/vfs-app-desktop.hxx"
 
 static const std::string DESKTOP_ENTRY_GROUP = "Desktop Entry";
@@ -557,7 +559,18 @@ vfs::desktop::open_files(const std::filesystem::path& working_dir,
 
     if (this->open_multiple_files())
     {
-        this->exec_desktop(working_dir, file_paths);
+        // xargs style, as many files per command as fit in ARG_MAX
+        usize budget = vfs::launcher::arg_budget();
+        budget -= std::min(budget / 2, this->desktop_entry_.exec.size() + 1);
+        if (this->use_terminal())
+        {
+            // the terminal gets the whole command as one argument, paths are quoted
+            budget = std::min(budget, vfs::launcher::MAX_ARG_LENGTH / 2);
+        }
+        for (const auto files : vfs::launcher::split(file_paths, budget))
+        {
+            this->exec_desktop(working_dir, files);
+        }
     }
     else
     {
@@ -598,22 +611,10 @@ vfs::desktop::exec_desktop(const std::filesystem::path& working_dir,
     {
         for (const auto& argv : desktop_commands)
         {
-            Glib::spawn_async_with_pipes(
-                !this->desktop_entry_.path.empty() ? this->desktop_entry_.path
-                                                   : working_dir.string(),
-                argv,
-#if (GTK_MAJOR_VERSION == 4)
-                Glib::SpawnFlags::SEARCH_PATH | Glib::SpawnFlags::STDOUT_TO_DEV_NULL |
-                    Glib::SpawnFlags::STDERR_TO_DEV_NULL,
-#elif (GTK_MAJOR_VERSION == 3)
-                Glib::SpawnFlags::SPAWN_SEARCH_PATH | Glib::SpawnFlags::SPAWN_STDOUT_TO_DEV_NULL |
-                    Glib::SpawnFlags::SPAWN_STDERR_TO_DEV_NULL,
-#endif
-                Glib::SlotSpawnChildSetup(),
-                nullptr,
-                nullptr,
-                nullptr,
-                nullptr);
+            vfs::launcher::spawn(!this->desktop_entry_.path.empty()
+                                     ? std::filesystem::path(this->desktop_entry_.path)
+                                     : working_dir,
+                                 argv);
         }
     }
 }
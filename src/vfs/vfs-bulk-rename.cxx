@@ -0,0 +1,567 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <string_view>
+
+#include <fmt/core.h>
+
+#include <filesystem>
+
+#include <span>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <algorithm>
+#include <ranges>
+
+#include <optional>
+
+#include <regex>
+
+#include <glibmm.h>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "vfs/vfs-bulk-rename.hxx"
+
+namespace
+{
+    struct name_parts
+    {
+        std::string basename{};
+        std::string extension{};
+    };
+
+    // same rules as split_basename_extension() without touching the filesystem
+    const name_parts
+    split_name(const std::string_view filename) noexcept
+    {
+        const auto dot_pos = filename.find_last_of('.');
+        if (dot_pos == std::string_view::npos || dot_pos == 0 || dot_pos == filename.size() - 1)
+        {
+            return {std::string(filename)};
+        }
+
+        const auto basename = filename.substr(0, dot_pos);
+        const auto extension = filename.substr(dot_pos + 1);
+
+        // compressed tar archive
+        const auto tar_pos = basename.find_last_of('.');
+        if (basename.ends_with(".tar") && tar_pos != 0)
+        {
+            return {std::string(basename.substr(0, tar_pos)),
+                    fmt::format("tar.{}", extension)};
+        }
+
+        return {std::string(basename), std::string(extension)};
+    }
+
+    const std::string
+    join_name(const name_parts& parts) noexcept
+    {
+        if (parts.extension.empty())
+        {
+            return parts.basename;
+        }
+        return fmt::format("{}.{}", parts.basename, parts.extension);
+    }
+
+    const std::string
+    change_case(const std::string_view str, vfs::bulk_rename::case_rule::mode mode) noexcept
+    {
+        const Glib::ustring ustr = std::string(str);
+        switch (mode)
+        {
+            case vfs::bulk_rename::case_rule::mode::lower:
+                return ustr.lowercase();
+            case vfs::bulk_rename::case_rule::mode::upper:
+                return ustr.uppercase();
+            case vfs::bulk_rename::case_rule::mode::title:
+            {
+                Glib::ustring title;
+                bool word_start = true;
+                for (const auto c : ustr)
+                {
+                    if (g_unichar_isalnum(c))
+                    {
+                        title.push_back(word_start ? g_unichar_totitle(c) : g_unichar_tolower(c));
+                        word_start = false;
+                    }
+                    else
+                    {
+                        title.push_back(c);
+                        word_start = true;
+                    }
+                }
+                return title;
+            }
+        }
+        return std::string(str);
+    }
+
+    const std::string
+    literal_replace(const std::string_view str, const std::string_view pattern,
+                    const std::string_view replacement, bool ignore_case) noexcept
+    {
+        if (!ignore_case)
+        {
+            return ztd::replace(str, pattern, replacement);
+        }
+
+        const std::string needle = Glib::ustring(std::string(pattern)).casefold();
+
+        // casefolding can change the byte length of a character, so every
+        // character is folded on its own and a match has to end on one of them
+        struct folded_char
+        {
+            usize begin{0};
+            usize end{0};
+            std::string folded{};
+        };
+        const bool utf8 = g_utf8_validate(str.data(), static_cast<gssize>(str.size()), nullptr);
+        std::vector<folded_char> chars;
+        for (usize pos = 0; pos < str.size();)
+        {
+            // names that are not UTF-8 only fold ASCII
+            usize end = pos + 1;
+            std::string folded(1, g_ascii_tolower(str[pos]));
+            if (utf8)
+            {
+                end = g_utf8_next_char(str.data() + pos) - str.data();
+                folded = Glib::ustring(std::string(str.substr(pos, end - pos))).casefold();
+            }
+            chars.push_back({pos, end, folded});
+            pos = end;
+        }
+
+        std::string result;
+        usize copied = 0;
+        usize index = 0;
+        while (index < chars.size())
+        {
+            std::string candidate;
+            usize last = index;
+            while (last < chars.size() && candidate.size() < needle.size())
+            {
+                candidate.append(chars[last].folded);
+                last += 1;
+            }
+
+            if (candidate != needle)
+            {
+                index += 1;
+                continue;
+            }
+
+            result.append(str.substr(copied, chars[index].begin - copied));
+            result.append(replacement);
+            copied = chars[last - 1].end;
+            index = last;
+        }
+        result.append(str.substr(copied));
+        return result;
+    }
+
+    const std::string
+    apply_rule(const std::string_view filename, usize index,
+               const vfs::bulk_rename::replace_rule& rule)
+    {
+        if (rule.pattern.empty())
+        {
+            return std::string(filename);
+        }
+
+        (void)index;
+
+        // operate on the whole filename or only on the basename
+        auto parts = rule.include_extension ? name_parts{std::string(filename)}
+                                            : split_name(filename);
+        std::string& target = parts.basename;
+
+        if (rule.use_regex)
+        {
+            // the same rule is applied to every file in the selection, only compile it once
+            thread_local std::string cached_pattern;
+            thread_local bool cached_ignore_case = false;
+            thread_local std::optional<std::regex> cached_regex = std::nullopt;
+            if (!cached_regex || cached_pattern != rule.pattern ||
+                cached_ignore_case != rule.ignore_case)
+            {
+                auto flags = std::regex::ECMAScript;
+                if (rule.ignore_case)
+                {
+                    flags |= std::regex::icase;
+                }
+                cached_regex = std::nullopt;
+                cached_regex = std::regex(rule.pattern, flags);
+                cached_pattern = rule.pattern;
+                cached_ignore_case = rule.ignore_case;
+            }
+            target = std::regex_replace(target, cached_regex.value(), rule.replacement);
+        }
+        else
+        {
+            target = literal_replace(target, rule.pattern, rule.replacement, rule.ignore_case);
+        }
+
+        return join_name(parts);
+    }
+
+    const std::string
+    apply_rule(const std::string_view filename, usize index,
+               const vfs::bulk_rename::counter_rule& rule)
+    {
+        auto parts = split_name(filename);
+
+        const u64 value = rule.start + (index * rule.step);
+        const auto counter = fmt::format("{:0{}}", value, rule.width);
+
+        std::string basename;
+        for (const auto c : rule.name_template)
+        {
+            if (c == '*')
+            {
+                basename.append(parts.basename);
+            }
+            else if (c == '#')
+            {
+                basename.append(counter);
+            }
+            else
+            {
+                basename.push_back(c);
+            }
+        }
+        parts.basename = basename;
+
+        return join_name(parts);
+    }
+
+    const std::string
+    apply_rule(const std::string_view filename, usize index,
+               const vfs::bulk_rename::case_rule& rule)
+    {
+        (void)index;
+
+        if (rule.include_extension)
+        {
+            return change_case(filename, rule.case_mode);
+        }
+
+        auto parts = split_name(filename);
+        parts.basename = change_case(parts.basename, rule.case_mode);
+        return join_name(parts);
+    }
+
+    const std::string
+    apply_rule(const std::string_view filename, usize index,
+               const vfs::bulk_rename::extension_rule& rule)
+    {
+        (void)index;
+
+        auto parts = split_name(filename);
+        if (parts.extension.empty())
+        {
+            return std::string(filename);
+        }
+
+        const std::string key = Glib::ustring(parts.extension).lowercase();
+        for (const auto& [old_extension, new_extension] : rule.mapping)
+        {
+            if (Glib::ustring(old_extension).lowercase() == key)
+            {
+                parts.extension = new_extension;
+                break;
+            }
+        }
+
+        if (rule.lowercase)
+        {
+            parts.extension = Glib::ustring(parts.extension).lowercase();
+        }
+
+        return join_name(parts);
+    }
+
+    bool
+    is_valid_name(const std::string_view name) noexcept
+    {
+        return !name.empty() && name != "." && name != ".." && !name.contains('/');
+    }
+
+    const std::filesystem::path
+    temporary_name(const std::filesystem::path& path) noexcept
+    {
+        while (true)
+        {
+            const auto tmp = path.parent_path() / fmt::format(".{}.{}.rename",
+                                                              path.filename().string(),
+                                                              ztd::randhex());
+            if (!std::filesystem::exists(std::filesystem::symlink_status(tmp)))
+            {
+                return tmp;
+            }
+        }
+    }
+} // namespace
+
+bool
+vfs::bulk_rename::plan::is_valid() const noexcept
+{
+    return this->errors == 0;
+}
+
+bool
+vfs::bulk_rename::plan::has_changes() const noexcept
+{
+    return !this->src_paths.empty();
+}
+
+const std::string
+vfs::bulk_rename::apply_rules(const std::string_view filename, usize index,
+                              const std::span<const rule> rules)
+{
+    std::string name = std::string(filename);
+    for (const auto& rule : rules)
+    {
+        name = std::visit([&name, index](const auto& r) { return apply_rule(name, index, r); },
+                          rule);
+    }
+    return name;
+}
+
+const vfs::bulk_rename::plan
+vfs::bulk_rename::create_plan(const std::span<const std::filesystem::path> files,
+                              const std::span<const rule> rules)
+{
+    plan result;
+    result.entries.reserve(files.size());
+
+    // new names
+    for (const auto index : std::views::iota(0uz, files.size()))
+    {
+        const auto& file = files[index];
+
+        entry e;
+        e.src = file;
+        e.dest = file;
+
+        try
+        {
+            const auto new_name = apply_rules(file.filename().string(), index, rules);
+            if (is_valid_name(new_name))
+            {
+                e.dest = file.parent_path() / new_name;
+                e.state = (e.dest == e.src) ? entry::status::unchanged : entry::status::ok;
+            }
+            else
+            {
+                e.state = entry::status::invalid;
+            }
+        }
+        catch (const std::regex_error&)
+        {
+            e.state = entry::status::invalid;
+        }
+
+        result.entries.push_back(e);
+    }
+
+    // collisions within the selection, every entry occupies its final name
+    std::unordered_map<std::string, usize> dest_count;
+    std::unordered_map<std::string, usize> src_index;
+    for (const auto index : std::views::iota(0uz, result.entries.size()))
+    {
+        const auto& e = result.entries[index];
+        dest_count[e.dest.string()] += 1;
+        if (e.state == entry::status::ok)
+        {
+            src_index[e.src.string()] = index;
+        }
+    }
+
+    // collisions with files that are not part of the rename
+    for (auto& e : result.entries)
+    {
+        if (e.state != entry::status::ok)
+        {
+            continue;
+        }
+
+        if (dest_count[e.dest.string()] > 1)
+        {
+            e.state = entry::status::collision;
+            continue;
+        }
+
+        if (src_index.contains(e.dest.string()))
+        {
+            // name will be freed by another rename in this plan
+            continue;
+        }
+
+        std::error_code ec;
+        if (std::filesystem::exists(std::filesystem::symlink_status(e.dest, ec)))
+        {
+            // case only rename on a case insensitive filesystem
+            if (!std::filesystem::equivalent(e.src, e.dest, ec))
+            {
+                e.state = entry::status::collision;
+            }
+        }
+    }
+
+    // an entry whose source would have been freed by a failed entry is blocked as well,
+    // every entry that keeps its name is visited once and blocks the one renaming onto it
+    std::unordered_map<std::string, usize> dest_index;
+    std::vector<usize> kept;
+    for (const auto index : std::views::iota(0uz, result.entries.size()))
+    {
+        const auto& e = result.entries[index];
+        if (e.state == entry::status::ok)
+        {
+            dest_index[e.dest.string()] = index;
+        }
+        else
+        {
+            kept.push_back(index);
+        }
+    }
+    while (!kept.empty())
+    {
+        const auto& e = result.entries[kept.back()];
+        kept.pop_back();
+
+        const auto it = dest_index.find(e.src.string());
+        if (it == dest_index.cend())
+        {
+            continue;
+        }
+        // ok entries have unique destinations, so only one can rename onto e
+        const usize other = it->second;
+        dest_index.erase(it);
+        if (result.entries[other].state == entry::status::ok)
+        {
+            result.entries[other].state = entry::status::collision;
+            kept.push_back(other);
+        }
+    }
+
+    result.errors = std::ranges::count_if(result.entries,
+                                          [](const auto& e)
+                                          {
+                                              return e.state == entry::status::collision ||
+                                                     e.state == entry::status::invalid;
+                                          });
+    if (result.errors != 0)
+    {
+        return result;
+    }
+
+    // order the renames so no destination is still occupied, breaking cycles
+    // by moving one member of the cycle to a temporary name first
+    src_index.clear();
+    for (const auto index : std::views::iota(0uz, result.entries.size()))
+    {
+        const auto& e = result.entries[index];
+        if (e.state == entry::status::ok)
+        {
+            src_index[e.src.string()] = index;
+        }
+    }
+
+    const auto blocker = [&result, &src_index](usize index) -> std::optional<usize>
+    {
+        const auto it = src_index.find(result.entries[index].dest.string());
+        if (it == src_index.cend())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    };
+
+    const auto emit = [&result](const std::filesystem::path& src, const std::filesystem::path& dest)
+    {
+        result.src_paths.push_back(src);
+        result.dest_paths.push_back(dest);
+    };
+
+    // position of an entry in the chain being walked, so finding a cycle is not a search
+    std::vector<std::optional<usize>> chain_pos(result.entries.size(), std::nullopt);
+    std::vector<bool> emitted(result.entries.size(), false);
+    for (const auto start : std::views::iota(0uz, result.entries.size()))
+    {
+        if (emitted[start] || result.entries[start].state != entry::status::ok)
+        {
+            continue;
+        }
+
+        std::vector<usize> chain{start};
+        chain_pos[start] = 0;
+        std::optional<usize> cycle_start = std::nullopt;
+        auto next = blocker(start);
+        while (next && !emitted[next.value()])
+        {
+            if (chain_pos[next.value()])
+            {
+                cycle_start = chain_pos[next.value()];
+                break;
+            }
+            chain_pos[next.value()] = chain.size();
+            chain.push_back(next.value());
+            next = blocker(next.value());
+        }
+        for (const auto index : chain)
+        {
+            chain_pos[index] = std::nullopt;
+        }
+
+        if (!cycle_start)
+        {
+            for (const auto index : std::views::reverse(chain))
+            {
+                emit(result.entries[index].src, result.entries[index].dest);
+                emitted[index] = true;
+            }
+            continue;
+        }
+
+        const usize cycle_index = chain[cycle_start.value()];
+        const auto& cycle_entry = result.entries[cycle_index];
+        const auto tmp = temporary_name(cycle_entry.src);
+        emit(cycle_entry.src, tmp);
+
+        for (const auto pos : std::views::iota(cycle_start.value() + 1, chain.size()) |
+                                  std::views::reverse)
+        {
+            emit(result.entries[chain[pos]].src, result.entries[chain[pos]].dest);
+            emitted[chain[pos]] = true;
+        }
+
+        emit(tmp, cycle_entry.dest);
+        emitted[cycle_index] = true;
+
+        for (const auto pos : std::views::iota(0uz, cycle_start.value()) | std::views::reverse)
+        {
+            emit(result.entries[chain[pos]].src, result.entries[chain[pos]].dest);
+            emitted[chain[pos]] = true;
+        }
+    }
+
+    return result;
+}
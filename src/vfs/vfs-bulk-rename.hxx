@@ -0,0 +1,113 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <filesystem>
+
+#include <span>
+#include <map>
+#include <vector>
+
+#include <variant>
+
+#include <ztd/ztd.hxx>
+
+// Compute new names for a whole selection at once, the resulting plan is
+// executed as a single vfs::file_task of type vfs::file_task::type::rename
+namespace vfs::bulk_rename
+{
+    struct replace_rule
+    {
+        std::string pattern{};
+        std::string replacement{}; // regex can use $1 .. $9 back references
+        bool use_regex{false};
+        bool ignore_case{false};
+        bool include_extension{false};
+    };
+
+    struct counter_rule
+    {
+        // '*' is replaced by the current name, '#' by the counter
+        std::string name_template{"*_#"};
+        u64 start{1};
+        u64 step{1};
+        u32 width{1};
+    };
+
+    struct case_rule
+    {
+        enum class mode
+        {
+            lower,
+            upper,
+            title,
+        };
+
+        mode case_mode{mode::lower};
+        bool include_extension{false};
+    };
+
+    struct extension_rule
+    {
+        // old extension -> new extension, without the leading dot.
+        // old extensions are matched ignoring case.
+        std::map<std::string, std::string> mapping{};
+        bool lowercase{false};
+    };
+
+    using rule = std::variant<replace_rule, counter_rule, case_rule, extension_rule>;
+
+    struct entry
+    {
+        enum class status
+        {
+            ok,
+            unchanged,
+            collision, // another file already has, or will get, this name
+            invalid,   // empty name, contains '/', or a bad regex
+        };
+
+        std::filesystem::path src{};
+        std::filesystem::path dest{};
+        status state{status::ok};
+    };
+
+    struct plan
+    {
+        std::vector<entry> entries{};
+
+        // Rename operations in execution order. Entries that form a cycle
+        // (a -> b, b -> a) are first moved to a temporary name.
+        std::vector<std::filesystem::path> src_paths{};
+        std::vector<std::filesystem::path> dest_paths{};
+
+        usize errors{0};
+
+        [[nodiscard]] bool is_valid() const noexcept;
+        [[nodiscard]] bool has_changes() const noexcept;
+    };
+
+    // Run the rule pipeline on a single filename, index is the position in the selection
+    const std::string apply_rules(const std::string_view filename, usize index,
+                                  const std::span<const rule> rules);
+
+    // Compute all new names, collisions and the rename order up front
+    const plan create_plan(const std::span<const std::filesystem::path> files,
+                           const std::span<const rule> rules);
+} // namespace vfs::bulk_rename
@@ -18,8 +18,16 @@
 
 #include <filesystem>
 
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <optional>
+
 #include <memory>
 
+#include <mutex>
+
 #include <fcntl.h>
 
 #include <ztd/ztd.hxx>
@@ -32,12 +40,83 @@
 
 #include "vfs/vfs-device.hxx"
 
+namespace
+{
+    // udev properties and sysfs attributes of a device only change together with a
+    // udev event, so they are read in one pass and reused until an event with a newer
+    // seqnum is seen. Mount points change without udev events and are not cached.
+    struct device_info
+    {
+        unsigned long long seqnum{0};
+        std::map<std::string, std::string> properties{};
+        std::vector<std::string> devlinks{};
+        std::optional<u64> size{std::nullopt};
+        std::optional<u64> block_size{std::nullopt};
+
+        const std::optional<std::string>
+        get_property(const std::string& name) const noexcept
+        {
+            const auto it = this->properties.find(name);
+            if (it == this->properties.cend())
+            {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+
+        bool
+        has_property(const std::string& name) const noexcept
+        {
+            return this->properties.contains(name);
+        }
+    };
+
+    std::mutex info_cache_lock;
+    std::unordered_map<std::string, std::shared_ptr<const device_info>> info_cache;
+
+    const std::shared_ptr<const device_info>
+    get_device_info(const libudev::device& udevice,
+                    const std::filesystem::path& syspath) noexcept
+    {
+        // devices from enumeration or devnum lookups have no seqnum,
+        // they use whatever the last event for the syspath loaded
+        const auto seqnum = udevice.get_seqnum();
+
+        const std::scoped_lock<std::mutex> lock(info_cache_lock);
+
+        const auto it = info_cache.find(syspath.string());
+        if (it != info_cache.cend() && (seqnum == 0 || seqnum <= it->second->seqnum))
+        {
+            return it->second;
+        }
+
+        auto info = std::make_shared<device_info>();
+        info->seqnum = seqnum;
+        info->properties = udevice.get_properties();
+        info->devlinks = udevice.get_devlinks();
+        info->size = vfs::linux::sysfs::get_u64(syspath, "size");
+        info->block_size = vfs::linux::sysfs::get_u64(syspath, "queue/hw_sector_size");
+
+        info_cache.insert_or_assign(syspath.string(), info);
+
+        return info;
+    }
+} // namespace
+
 const std::shared_ptr<vfs::device>
 vfs::device::create(const libudev::device& udevice) noexcept
 {
     return std::make_shared<vfs::device>(udevice);
 }
 
+void
+vfs::device::invalidate(const std::filesystem::path& syspath) noexcept
+{
+    const std::scoped_lock<std::mutex> lock(info_cache_lock);
+
+    info_cache.erase(syspath.string());
+}
+
 vfs::device::device(const libudev::device& udevice)
 {
     this->udevice = udevice;
@@ -232,15 +311,17 @@ vfs::device::device_get_info() noexcept
     this->devnode_ = device_devnode.value();
     this->devnum_ = device_devnum;
 
-    const auto prop_id_fs_usage = this->udevice.get_property("ID_FS_USAGE");
-    const auto prop_id_fs_uuid = this->udevice.get_property("ID_FS_UUID");
+    const auto info = get_device_info(this->udevice, this->native_path_);
+
+    const auto prop_id_fs_usage = info->get_property("ID_FS_USAGE");
+    const auto prop_id_fs_uuid = info->get_property("ID_FS_UUID");
 
-    const auto prop_id_fs_type = this->udevice.get_property("ID_FS_TYPE");
+    const auto prop_id_fs_type = info->get_property("ID_FS_TYPE");
     if (prop_id_fs_type)
     {
         this->fstype_ = prop_id_fs_type.value();
     }
-    const auto prop_id_fs_label = this->udevice.get_property("ID_FS_LABEL");
+    const auto prop_id_fs_label = info->get_property("ID_FS_LABEL");
     if (prop_id_fs_label)
     {
         this->id_label_ = prop_id_fs_label.value();
@@ -261,7 +342,7 @@ vfs::device::device_get_info() noexcept
     {
         bool is_cd;
 
-        const auto prop_id_cdrom = this->udevice.get_property("ID_CDROM");
+        const auto prop_id_cdrom = info->get_property("ID_CDROM");
         if (prop_id_cdrom)
         {
             is_cd = std::stol(prop_id_cdrom.value()) != 0;
@@ -284,7 +365,7 @@ vfs::device::device_get_info() noexcept
         }
         else
         {
-            const auto prop_id_cdrom_media = this->udevice.get_property("ID_CDROM_MEDIA");
+            const auto prop_id_cdrom_media = info->get_property("ID_CDROM_MEDIA");
             if (prop_id_cdrom_media)
             {
                 media_available = (std::stol(prop_id_cdrom_media.value()) == 1);
@@ -293,7 +374,7 @@ vfs::device::device_get_info() noexcept
     }
     else
     {
-        const auto prop_id_cdrom_media = this->udevice.get_property("ID_CDROM_MEDIA");
+        const auto prop_id_cdrom_media = info->get_property("ID_CDROM_MEDIA");
         if (prop_id_cdrom_media)
         {
             media_available = (std::stol(prop_id_cdrom_media.value()) == 1);
@@ -308,23 +389,20 @@ vfs::device::device_get_info() noexcept
 
     if (this->is_media_available())
     {
-        const auto check_size = vfs::linux::sysfs::get_u64(this->native_path_, "size");
-        if (check_size)
+        if (info->size)
         {
-            this->size_ = check_size.value() * ztd::BLOCK_SIZE;
+            this->size_ = info->size.value() * ztd::BLOCK_SIZE;
         }
 
         //  This is not available on all devices so fall back to 512 if unavailable.
         //
         //  Another way to get this information is the BLKSSZGET ioctl but we do not want
         //  to open the device. Ideally vol_id would export it.
-        const auto check_block_size =
-            vfs::linux::sysfs::get_u64(this->native_path_, "queue/hw_sector_size");
-        if (check_block_size)
+        if (info->block_size)
         {
-            if (check_block_size.value() != 0)
+            if (info->block_size.value() != 0)
             {
-                this->block_size_ = check_block_size.value();
+                this->block_size_ = info->block_size.value();
             }
             else
             {
@@ -338,8 +416,7 @@ vfs::device::device_get_info() noexcept
     }
 
     // links
-    const auto entrys = this->udevice.get_devlinks();
-    for (const std::string_view entry : entrys)
+    for (const std::string_view entry : info->devlinks)
     {
         if (entry.starts_with("/dev/disk/by-id/") || entry.starts_with("/dev/disk/by-uuid/"))
         {
@@ -353,18 +430,19 @@ vfs::device::device_get_info() noexcept
         return false;
     }
 
-    this->is_removable_ = this->udevice.is_removable();
+    // only usb, ieee1394, firewire, mmc, and pcmcia devices have ID_BUS
+    this->is_removable_ = info->has_property("ID_BUS");
 
     // is_ejectable
     bool drive_is_ejectable = false;
-    const auto prop_id_drive_ejectable = this->udevice.get_property("ID_DRIVE_EJECTABLE");
+    const auto prop_id_drive_ejectable = info->get_property("ID_DRIVE_EJECTABLE");
     if (prop_id_drive_ejectable)
     {
         drive_is_ejectable = std::stol(prop_id_drive_ejectable.value()) != 0;
     }
     else
     {
-        drive_is_ejectable = this->udevice.has_property("ID_CDROM");
+        drive_is_ejectable = info->has_property("ID_CDROM");
     }
     this->is_media_ejectable_ = drive_is_ejectable;
 
@@ -374,7 +452,7 @@ vfs::device::device_get_info() noexcept
     this->mount_points_ = this->info_mount_points().value_or("");
     this->is_mounted_ = !this->mount_points_.empty();
 
-    const auto prop_id_cdrom = this->udevice.get_property("ID_CDROM");
+    const auto prop_id_cdrom = info->get_property("ID_CDROM");
     if (prop_id_cdrom && std::stol(prop_id_cdrom.value()) != 0)
     {
         this->is_optical_disc_ = true;
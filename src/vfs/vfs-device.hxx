@@ -18,6 +18,8 @@
 #include <string>
 #include <string_view>
 
+#include <filesystem>
+
 #include <optional>
 
 #include <memory>
@@ -36,6 +38,9 @@ namespace vfs
 
         static const std::shared_ptr<vfs::device> create(const libudev::device& udevice) noexcept;
 
+        // drop the cached udev properties and sysfs attributes of a removed device
+        static void invalidate(const std::filesystem::path& syspath) noexcept;
+
         libudev::device udevice;
 
         dev_t devnum() const noexcept;
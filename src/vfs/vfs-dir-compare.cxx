@@ -0,0 +1,358 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include <filesystem>
+
+#include <span>
+#include <vector>
+
+#include <memory>
+
+#include <algorithm>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <stop_token>
+#include <chrono>
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <glibmm.h>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "vfs/vfs-dir-compare.hxx"
+
+// entries handed to the main loop at most this often
+inline constexpr std::chrono::milliseconds FLUSH_INTERVAL{200};
+inline constexpr usize BATCH_SIZE = 4096;
+inline constexpr u32 MAX_CONTENT_WORKERS = 4;
+inline constexpr usize READ_SIZE = 128 * 1024;
+
+vfs::dir_compare::dir_compare(const std::span<const std::shared_ptr<vfs::file>> left,
+                              const std::span<const std::shared_ptr<vfs::file>> right,
+                              bool content, const batch_callback_t& batch_cb,
+                              const finish_callback_t& finish_cb) noexcept
+    : left_(make_snapshot(left)), right_(make_snapshot(right)), content_(content),
+      batch_cb_(batch_cb), finish_cb_(finish_cb)
+{
+}
+
+vfs::dir_compare::~dir_compare()
+{
+    this->cancel();
+}
+
+const std::shared_ptr<vfs::dir_compare>
+vfs::dir_compare::create(const std::span<const std::shared_ptr<vfs::file>> left,
+                         const std::span<const std::shared_ptr<vfs::file>> right, bool content,
+                         const batch_callback_t& batch_cb,
+                         const finish_callback_t& finish_cb) noexcept
+{
+    return std::make_shared<vfs::dir_compare>(left, right, content, batch_cb, finish_cb);
+}
+
+std::vector<vfs::dir_compare::snapshot>
+vfs::dir_compare::make_snapshot(const std::span<const std::shared_ptr<vfs::file>> files) noexcept
+{
+    std::vector<snapshot> snapshots;
+    snapshots.reserve(files.size());
+    for (const auto& file : files)
+    {
+        snapshots.push_back({
+            .name = std::string(file->name()),
+            .path = file->path(),
+            .size = file->size(),
+            .mtime = file->mtime(),
+            .is_dir = file->is_directory(),
+            .is_regular = file->is_regular_file(),
+        });
+    }
+    return snapshots;
+}
+
+void
+vfs::dir_compare::start() noexcept
+{
+    this->flush_timer_ = g_timeout_add_full(
+        G_PRIORITY_DEFAULT,
+        FLUSH_INTERVAL.count(),
+        [](void* user_data) -> gboolean
+        {
+            const auto self = static_cast<std::weak_ptr<vfs::dir_compare>*>(user_data)->lock();
+            if (!self || self->canceled_)
+            {
+                return G_SOURCE_REMOVE;
+            }
+
+            // read first, everything reported before done_ was set is flushed below
+            const bool done = self->done_;
+            self->flush();
+            if (done)
+            {
+                self->flush_timer_ = 0;
+                if (self->finish_cb_)
+                {
+                    self->finish_cb_(self->differences_);
+                }
+                return G_SOURCE_REMOVE;
+            }
+            return G_SOURCE_CONTINUE;
+        },
+        new std::weak_ptr<vfs::dir_compare>(this->weak_from_this()),
+        [](void* user_data) { delete static_cast<std::weak_ptr<vfs::dir_compare>*>(user_data); });
+
+    this->thread_ = std::jthread([this](const std::stop_token& stop_token)
+                                 { this->compare_thread(stop_token); });
+}
+
+void
+vfs::dir_compare::cancel() noexcept
+{
+    this->canceled_ = true;
+
+    if (this->thread_.joinable())
+    {
+        this->thread_.request_stop();
+        this->thread_.join();
+    }
+
+    if (this->flush_timer_)
+    {
+        g_source_remove(this->flush_timer_);
+        this->flush_timer_ = 0;
+    }
+}
+
+void
+vfs::dir_compare::compare_thread(const std::stop_token& stop_token) noexcept
+{
+    std::ranges::sort(this->left_, {}, &snapshot::name);
+    std::ranges::sort(this->right_, {}, &snapshot::name);
+
+    const auto newer = [](const snapshot& left, const snapshot& right)
+    {
+        if (left.mtime > right.mtime)
+        {
+            return vfs::dir_compare::result::newer_left;
+        }
+        if (left.mtime < right.mtime)
+        {
+            return vfs::dir_compare::result::newer_right;
+        }
+        return vfs::dir_compare::result::differs;
+    };
+
+    // pairs of same sized files, by index into left_ and right_
+    std::vector<std::pair<usize, usize>> content_jobs;
+
+    std::vector<entry> batch;
+    usize l = 0;
+    usize r = 0;
+    while (l < this->left_.size() || r < this->right_.size())
+    {
+        if (stop_token.stop_requested())
+        {
+            return;
+        }
+
+        if (r == this->right_.size() ||
+            (l < this->left_.size() && this->left_[l].name < this->right_[r].name))
+        {
+            batch.push_back({this->left_[l].name, result::only_left});
+            l += 1;
+        }
+        else if (l == this->left_.size() || this->right_[r].name < this->left_[l].name)
+        {
+            batch.push_back({this->right_[r].name, result::only_right});
+            r += 1;
+        }
+        else
+        {
+            const auto& left = this->left_[l];
+            const auto& right = this->right_[r];
+            if (left.is_dir != right.is_dir)
+            {
+                batch.push_back({left.name, result::differs});
+            }
+            else if (left.is_dir)
+            {
+                // subdirectories are not descended into
+            }
+            else if (this->content_ && left.is_regular && right.is_regular &&
+                     left.size == right.size)
+            {
+                content_jobs.emplace_back(l, r);
+            }
+            else if (left.size != right.size || left.mtime != right.mtime)
+            {
+                batch.push_back({left.name, newer(left, right)});
+            }
+            l += 1;
+            r += 1;
+        }
+
+        if (batch.size() >= BATCH_SIZE)
+        {
+            this->report(std::move(batch));
+            batch.clear();
+        }
+    }
+    this->report(std::move(batch));
+
+    if (!content_jobs.empty())
+    {
+        std::atomic<usize> next{0};
+        const auto worker = [&]()
+        {
+            std::vector<entry> found;
+            usize n;
+            while ((n = next.fetch_add(1)) < content_jobs.size() && !stop_token.stop_requested())
+            {
+                const auto& left = this->left_[content_jobs[n].first];
+                const auto& right = this->right_[content_jobs[n].second];
+                if (!this->same_content(stop_token, left, right))
+                {
+                    found.push_back({left.name, newer(left, right)});
+                    // stream results, content compares are slow
+                    this->report(std::move(found));
+                    found.clear();
+                }
+            }
+        };
+
+        const u32 count = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_CONTENT_WORKERS);
+        std::vector<std::jthread> pool;
+        for (u32 i = 1; i < count; ++i)
+        {
+            pool.emplace_back(worker);
+        }
+        worker();
+        // pool is joined here
+    }
+
+    if (!stop_token.stop_requested())
+    {
+        this->done_ = true;
+    }
+}
+
+bool
+vfs::dir_compare::same_content(const std::stop_token& stop_token, const snapshot& left,
+                               const snapshot& right) const noexcept
+{
+    const auto read_full = [](i32 fd, char* buffer, usize size) -> isize
+    {
+        usize total = 0;
+        while (total < size)
+        {
+            const auto length = read(fd, buffer + total, size - total);
+            if (length == 0)
+            {
+                break;
+            }
+            if (length == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return -1;
+            }
+            total += length;
+        }
+        return static_cast<isize>(total);
+    };
+
+    const i32 lfd = open(left.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (lfd == -1)
+    {
+        return false;
+    }
+    const i32 rfd = open(right.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (rfd == -1)
+    {
+        close(lfd);
+        return false;
+    }
+    posix_fadvise(lfd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(rfd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    std::vector<char> lbuf(READ_SIZE);
+    std::vector<char> rbuf(READ_SIZE);
+    bool same = true;
+    while (!stop_token.stop_requested())
+    {
+        const auto llen = read_full(lfd, lbuf.data(), lbuf.size());
+        const auto rlen = read_full(rfd, rbuf.data(), rbuf.size());
+        if (llen != rlen || llen == -1 || std::memcmp(lbuf.data(), rbuf.data(), llen) != 0)
+        {
+            same = false;
+            break;
+        }
+        if (llen == 0)
+        {
+            break;
+        }
+    }
+
+    close(lfd);
+    close(rfd);
+    return same;
+}
+
+void
+vfs::dir_compare::report(std::vector<entry>&& entries) noexcept
+{
+    if (entries.empty())
+    {
+        return;
+    }
+
+    const std::scoped_lock<std::mutex> lock(this->lock_);
+    this->differences_ += entries.size();
+    if (this->pending_.empty())
+    {
+        this->pending_ = std::move(entries);
+    }
+    else
+    {
+        this->pending_.insert(this->pending_.cend(),
+                              std::make_move_iterator(entries.begin()),
+                              std::make_move_iterator(entries.end()));
+    }
+}
+
+void
+vfs::dir_compare::flush() noexcept
+{
+    std::vector<entry> entries;
+    {
+        const std::scoped_lock<std::mutex> lock(this->lock_);
+        entries.swap(this->pending_);
+    }
+
+    if (!entries.empty() && this->batch_cb_)
+    {
+        this->batch_cb_(entries);
+    }
+}
@@ -0,0 +1,122 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <filesystem>
+
+#include <span>
+#include <vector>
+
+#include <memory>
+
+#include <functional>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <stop_token>
+
+#include <ctime>
+
+#include <ztd/ztd.hxx>
+
+#include "vfs/vfs-file.hxx"
+
+namespace vfs
+{
+    // Compares the file lists of two dirs by name. Size and mtime are compared on a
+    // worker thread, same sized regular files can also be compared byte by byte on a
+    // small thread pool. Differences are handed to the main loop in batches while the
+    // comparison runs, entries that are the same are not reported.
+    struct dir_compare : public std::enable_shared_from_this<dir_compare>
+    {
+        enum class result
+        {
+            only_left,
+            only_right,
+            newer_left,
+            newer_right,
+            differs, // same mtime, different size or content
+        };
+
+        struct entry
+        {
+            std::string name{};
+            vfs::dir_compare::result result{vfs::dir_compare::result::differs};
+        };
+
+        // called in the main loop thread
+        using batch_callback_t = std::function<void(const std::span<const entry> entries)>;
+        using finish_callback_t = std::function<void(u64 differences)>;
+
+        dir_compare() = delete;
+        dir_compare(const std::span<const std::shared_ptr<vfs::file>> left,
+                    const std::span<const std::shared_ptr<vfs::file>> right, bool content,
+                    const batch_callback_t& batch_cb, const finish_callback_t& finish_cb) noexcept;
+        ~dir_compare();
+        dir_compare(const dir_compare& other) = delete;
+        dir_compare& operator=(const dir_compare& other) = delete;
+
+        static const std::shared_ptr<vfs::dir_compare>
+        create(const std::span<const std::shared_ptr<vfs::file>> left,
+               const std::span<const std::shared_ptr<vfs::file>> right, bool content,
+               const batch_callback_t& batch_cb, const finish_callback_t& finish_cb) noexcept;
+
+        void start() noexcept;
+        // no more callbacks are run after this
+        void cancel() noexcept;
+
+      private:
+        // copied on the main thread, the vfs::file objects can change while comparing
+        struct snapshot
+        {
+            std::string name{};
+            std::filesystem::path path{};
+            u64 size{0};
+            std::time_t mtime{0};
+            bool is_dir{false};
+            bool is_regular{false};
+        };
+
+        static std::vector<snapshot>
+        make_snapshot(const std::span<const std::shared_ptr<vfs::file>> files) noexcept;
+
+        void compare_thread(const std::stop_token& stop_token) noexcept;
+        bool same_content(const std::stop_token& stop_token, const snapshot& left,
+                          const snapshot& right) const noexcept;
+        void report(std::vector<entry>&& entries) noexcept;
+        void flush() noexcept;
+
+        std::vector<snapshot> left_;
+        std::vector<snapshot> right_;
+        bool content_{false};
+
+        batch_callback_t batch_cb_{nullptr};
+        finish_callback_t finish_cb_{nullptr};
+
+        std::mutex lock_;
+        std::vector<entry> pending_{};
+        u64 differences_{0};
+        u32 flush_timer_{0};
+
+        std::atomic<bool> done_{false};
+        std::atomic<bool> canceled_{false};
+
+        std::jthread thread_;
+    };
+} // namespace vfs
@@ -0,0 +1,208 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <string_view>
+
+#include <filesystem>
+
+#include <span>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+
+#include <algorithm>
+#include <ranges>
+
+#include <chrono>
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "vfs/vfs-volume.hxx"
+
+#include "vfs/vfs-dir-prefetch.hxx"
+
+namespace
+{
+    // stop warming a dir after this many entries
+    constexpr usize MAX_WARM_ENTRIES = 20000;
+    // selection changes request the same dirs over and over, the kernel
+    // caches stay hot for a while
+    constexpr std::chrono::seconds WARM_TTL{60};
+    constexpr usize MAX_WARMED = 256;
+
+    constexpr usize MAX_VISITS = 512;
+    constexpr usize MAX_FREQUENT = 3;
+
+    std::mutex queue_lock;
+    std::condition_variable_any queue_cond;
+    std::deque<std::filesystem::path> queue;
+    // bumped by every request, stale work is dropped
+    std::atomic<u64> generation{0};
+    // when each dir was last warmed, guarded by queue_lock
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> warmed;
+
+    // main thread only
+    std::unordered_map<std::string, u64> visits;
+
+    bool
+    recently_warmed(const std::filesystem::path& path,
+                    const std::chrono::steady_clock::time_point now) noexcept
+    {
+        const auto it = warmed.find(path.string());
+        return it != warmed.cend() && now - it->second < WARM_TTL;
+    }
+
+    void
+    worker_thread(const std::stop_token& stop_token)
+    {
+        while (true)
+        {
+            std::filesystem::path path;
+            u64 gen = 0;
+            {
+                std::unique_lock<std::mutex> lock(queue_lock);
+                if (!queue_cond.wait(lock, stop_token, [] { return !queue.empty(); }))
+                {
+                    return;
+                }
+                path = std::move(queue.front());
+                queue.pop_front();
+                gen = generation;
+            }
+
+            // same reads vfs::dir does when loading
+            usize entries = 0;
+            std::error_code ec;
+            for (auto it = std::filesystem::directory_iterator(path, ec);
+                 !ec && it != std::filesystem::directory_iterator();
+                 it.increment(ec))
+            {
+                if (stop_token.stop_requested() || gen != generation ||
+                    entries >= MAX_WARM_ENTRIES)
+                {
+                    break;
+                }
+                (void)ztd::statx(it->path(), ztd::statx::symlink::no_follow);
+                entries += 1;
+            }
+
+            if (ec || stop_token.stop_requested() || gen != generation)
+            {
+                continue;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            const std::scoped_lock<std::mutex> lock(queue_lock);
+            if (warmed.size() >= MAX_WARMED)
+            {
+                std::erase_if(warmed,
+                              [now](const auto& item) { return now - item.second >= WARM_TTL; });
+            }
+            if (warmed.size() < MAX_WARMED)
+            {
+                warmed.insert_or_assign(path.string(), now);
+            }
+        }
+    }
+
+    // declared last, stopped and joined before the queue is destroyed
+    std::jthread worker;
+} // namespace
+
+void
+vfs::dir_prefetch::request(const std::span<const std::filesystem::path> paths) noexcept
+{
+    std::vector<std::filesystem::path> wanted;
+    for (const auto& path : paths)
+    {
+        if (path.empty() || std::ranges::find(wanted, path) != wanted.cend())
+        {
+            continue;
+        }
+        // network and removable media can be slow to wake
+        if (vfs_volume_dir_avoid_changes(path))
+        {
+            continue;
+        }
+        wanted.push_back(path);
+    }
+
+    {
+        const std::scoped_lock<std::mutex> lock(queue_lock);
+        const auto now = std::chrono::steady_clock::now();
+        std::erase_if(wanted, [now](const auto& path) { return recently_warmed(path, now); });
+
+        generation += 1;
+        queue.assign(wanted.cbegin(), wanted.cend());
+        if (!worker.joinable())
+        {
+            worker = std::jthread(worker_thread);
+        }
+    }
+    queue_cond.notify_one();
+}
+
+void
+vfs::dir_prefetch::cancel() noexcept
+{
+    const std::scoped_lock<std::mutex> lock(queue_lock);
+    generation += 1;
+    queue.clear();
+}
+
+void
+vfs::dir_prefetch::visited(const std::filesystem::path& path) noexcept
+{
+    visits[path.string()] += 1;
+
+    if (visits.size() > MAX_VISITS)
+    {
+        // age the counts so old habits fade out
+        for (auto& count : visits | std::views::values)
+        {
+            count /= 2;
+        }
+        std::erase_if(visits, [](const auto& item) { return item.second == 0; });
+    }
+}
+
+const std::vector<std::filesystem::path>
+vfs::dir_prefetch::frequent() noexcept
+{
+    std::vector<std::pair<u64, std::string_view>> counts;
+    counts.reserve(visits.size());
+    for (const auto& [path, count] : visits)
+    {
+        counts.emplace_back(count, path);
+    }
+
+    const usize n = std::min(counts.size(), MAX_FREQUENT);
+    std::ranges::partial_sort(counts, counts.begin() + n, std::ranges::greater());
+
+    std::vector<std::filesystem::path> paths;
+    for (const auto& item : std::span(counts).first(n))
+    {
+        paths.emplace_back(item.second);
+    }
+    return paths;
+}
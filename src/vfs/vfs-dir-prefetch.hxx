@@ -0,0 +1,39 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+
+#include <span>
+#include <vector>
+
+namespace vfs::dir_prefetch
+{
+    // Warm the likely next directories in the background. A worker thread
+    // reads and stats each dir so the kernel caches are hot when it is opened.
+    // No vfs::dir is created, that would list and sniff the dir and add a
+    // monitor for a dir that may never be opened. Paths on volumes that avoid
+    // changes are skipped, as are dirs that were warmed a moment ago.
+
+    // replaces whatever is still queued, most likely first
+    void request(const std::span<const std::filesystem::path> paths) noexcept;
+    // drop the queue and stop warming the current dir
+    void cancel() noexcept;
+
+    // count a visit, the most visited dirs are returned by frequent()
+    void visited(const std::filesystem::path& path) noexcept;
+    const std::vector<std::filesystem::path> frequent() noexcept;
+} // namespace vfs::dir_prefetch
@@ -20,6 +20,8 @@
 #include <filesystem>
 
 #include <vector>
+#include <list>
+#include <unordered_set>
 
 #include <algorithm>
 
@@ -35,9 +37,10 @@
 
 #include <cassert>
 
-#include <glibmm.h>
+#include <unistd.h>
+#include <fcntl.h>
 
-#include <malloc.h>
+#include <glibmm.h>
 
 #include <ztd/ztd.hxx>
 #include <ztd/ztd_logger.hxx>
@@ -45,16 +48,47 @@
 #include "write.hxx"
 #include "utils.hxx"
 
+#include "settings/app.hxx"
+
+#include "mime-type/mime-type.hxx"
+
 #include "vfs/vfs-async-thread.hxx"
 #include "vfs/vfs-async-task.hxx"
 #include "vfs/vfs-file.hxx"
 #include "vfs/vfs-thumbnailer.hxx"
+#include "vfs/vfs-unique-name.hxx"
 #include "vfs/vfs-volume.hxx"
 
 #include "vfs/vfs-dir.hxx"
 
 static ztd::smart_cache<std::filesystem::path, vfs::dir> dir_smart_cache;
 
+// recently used dirs, newest first. holding a reference keeps a dir
+// loaded after its last tab is closed, see vfs_dir_cache_trim()
+static std::list<std::shared_ptr<vfs::dir>> dir_retained;
+// sum of vfs::dir::memory_usage() over every loaded dir, open or not
+static std::atomic<i64> dir_memory_total = 0;
+
+static void
+dir_retain(const std::shared_ptr<vfs::dir>& dir) noexcept
+{
+    const auto it = std::ranges::find(dir_retained, dir);
+    if (it != dir_retained.cend())
+    {
+        dir_retained.splice(dir_retained.cbegin(), dir_retained, it);
+    }
+    else
+    {
+        dir_retained.push_front(dir);
+    }
+}
+
+static i64
+file_memory_usage(const std::shared_ptr<vfs::file>& file) noexcept
+{
+    return static_cast<i64>(sizeof(std::shared_ptr<vfs::file>) + file->memory_usage());
+}
+
 vfs::dir::dir(const std::filesystem::path& path) : path_(path)
 {
     // ztd::logger::debug("vfs::dir::dir({})   {}", fmt::ptr(this), path);
@@ -75,6 +109,8 @@ vfs::dir::~dir()
 
     this->signal_task_load_dir.disconnect();
 
+    dir_memory_total -= this->memory_usage_;
+
     if (this->task_)
     {
         // FIXME: should we generate a "file-list" signal to indicate the dir loading was cancelled?
@@ -87,13 +123,23 @@ vfs::dir::~dir()
 const std::shared_ptr<vfs::dir>
 vfs::dir::create(const std::filesystem::path& path) noexcept
 {
+    // also drops closed dirs that were deleted, so they are not reused
+    vfs_dir_cache_trim();
+
     std::shared_ptr<vfs::dir> dir = nullptr;
     if (dir_smart_cache.contains(path))
     {
         dir = dir_smart_cache.at(path);
         // ztd::logger::debug("vfs::dir::dir({}) cache   {}", fmt::ptr(dir.get()), path);
+        if (!dir->resume())
+        {
+            // removed while closed, this was the last reference besides the
+            // retained list, so the cache entry expires with it
+            std::erase(dir_retained, dir);
+            dir = nullptr;
+        }
     }
-    else
+    if (!dir)
     {
         dir = dir_smart_cache.create(
             path,
@@ -101,6 +147,20 @@ vfs::dir::create(const std::filesystem::path& path) noexcept
         // ztd::logger::debug("vfs::dir::dir({}) new     {}", fmt::ptr(dir.get()), path);
     }
     // ztd::logger::debug("dir({})     {}", fmt::ptr(dir.get()), path);
+
+    dir_retain(dir);
+
+    // the dir the caller leaves is only released after this returns, trim
+    // again afterwards so that it is suspended without waiting for the next open
+    g_idle_add(
+        [](void* user_data) -> gboolean
+        {
+            (void)user_data;
+            vfs_dir_cache_trim();
+            return G_SOURCE_REMOVE;
+        },
+        nullptr);
+
     return dir;
 }
 
@@ -111,6 +171,28 @@ vfs::dir::on_list_task_finished(bool is_cancelled)
     this->run_event<spacefm::signal::file_listed>(is_cancelled);
     this->file_listed_ = true;
     this->load_complete_ = true;
+
+    // the only full walk, afterwards files are accounted as they come and go
+    {
+        std::scoped_lock<std::mutex> lock(this->lock_);
+
+        i64 size = sizeof(vfs::dir);
+        for (const auto& file : this->files_)
+        {
+            size += file_memory_usage(file);
+        }
+        this->add_memory_usage(size - this->memory_usage_);
+    }
+
+    // size is only known now. deferred since trimming can free this dir
+    g_idle_add(
+        [](void* user_data) -> gboolean
+        {
+            (void)user_data;
+            vfs_dir_cache_trim();
+            return G_SOURCE_REMOVE;
+        },
+        nullptr);
 }
 
 const std::filesystem::path&
@@ -194,6 +276,8 @@ vfs::dir::load_thread()
     this->load_complete_ = false;
     this->xhidden_count_ = 0;
 
+    this->update_writable();
+
     /* Install file alteration monitor */
     this->monitor_ = vfs::monitor::create(
         this->path_,
@@ -234,7 +318,7 @@ vfs::dir::load_thread()
             }
         }
 
-        const auto file = vfs::file::create(full_path);
+        const auto file = vfs::file::create(full_path, this->arena_);
         this->files_.emplace_back(file);
     }
 }
@@ -249,16 +333,98 @@ vfs::dir::on_monitor_event(const vfs::monitor::event event, const std::filesyste
             this->emit_file_created(path.filename(), false);
             break;
         case vfs::monitor::event::deleted:
+            // the name is free again, new names are picked from the dir contents
+            vfs::unique_name::release(this->path_ / path.filename());
             this->emit_file_deleted(path.filename(), nullptr);
             break;
         case vfs::monitor::event::changed:
             this->emit_file_changed(path.filename(), nullptr, false);
             break;
+        case vfs::monitor::event::rescan:
+            vfs::unique_name::invalidate(this->path_);
+            this->rescan();
+            break;
         case vfs::monitor::event::other:
             break;
     }
 }
 
+void
+vfs::dir::rescan() noexcept
+{
+    // monitor events were lost, compare the file list with the directory
+    std::unordered_set<std::string> names;
+    std::error_code ec;
+    for (auto it = std::filesystem::directory_iterator(this->path_, ec);
+         !ec && it != std::filesystem::directory_iterator();
+         it.increment(ec))
+    {
+        names.insert(it->path().filename().string());
+    }
+    if (ec)
+    { // the directory itself is gone, its monitor reports that
+        ztd::logger::warn("Cannot rescan {}: {}", this->path_.string(), ec.message());
+        return;
+    }
+
+    std::scoped_lock<std::mutex> lock(this->lock_);
+
+    // known files are updated, or removed if they are gone
+    for (const auto& file : this->files_)
+    {
+        names.erase(file->name());
+        this->changed_files_.emplace_back(file);
+    }
+    for (const auto& name : names)
+    {
+        this->created_files_.emplace_back(name);
+    }
+
+    this->update_changed_files();
+    this->update_created_files();
+}
+
+void
+vfs_dir_cache_trim()
+{
+    // one budget for every loaded dir, open dirs cannot be dropped, so closed
+    // dirs are dropped from the least recently used end until the total fits
+    i64 excess = dir_memory_total - static_cast<i64>(app_settings.dir_cache_size());
+    for (auto it = dir_retained.end(); it != dir_retained.begin();)
+    {
+        --it;
+        if (it->use_count() > 1)
+        {
+            // still open somewhere
+            continue;
+        }
+
+        if ((*it)->is_retainable() && excess <= 0)
+        {
+            // closed dirs are not watched, they are revalidated when opened again
+            (*it)->suspend();
+            continue;
+        }
+
+        excess -= static_cast<i64>((*it)->memory_usage());
+        it = dir_retained.erase(it);
+    }
+}
+
+u64
+vfs_dir_cache_usage()
+{
+    u64 used = 0;
+    for (const auto& dir : dir_retained)
+    {
+        if (dir.use_count() == 1 && dir->is_retainable())
+        {
+            used += dir->memory_usage();
+        }
+    }
+    return used;
+}
+
 void
 vfs_dir_mime_type_reload()
 {
@@ -267,6 +433,17 @@ vfs_dir_mime_type_reload()
     // std::ranges::for_each(dir_smart_cache, action);
 }
 
+void
+vfs_dir_mime_type_reload(const std::span<const std::string> types)
+{
+    // open dirs are always retained, copied as the signals can open other dirs
+    const auto dirs = dir_retained;
+    for (const auto& dir : dirs)
+    {
+        dir->reload_mime_type(types);
+    }
+}
+
 /**
 * vfs::dir class
 */
@@ -327,6 +504,25 @@ vfs::dir::load_thumbnail(const std::shared_ptr<vfs::file>& file, const bool is_b
     }
 }
 
+bool
+vfs::dir::is_writable() const noexcept
+{
+    return this->writable_;
+}
+
+void
+vfs::dir::set_writable(bool writable) noexcept
+{
+    this->writable_ = writable;
+}
+
+void
+vfs::dir::update_writable() noexcept
+{
+    // Note: network filesystems may become unresponsive here
+    this->writable_ = faccessat(0, this->path_.c_str(), W_OK, AT_EACCESS) == 0;
+}
+
 bool
 vfs::dir::is_file_listed() const noexcept
 {
@@ -376,6 +572,7 @@ vfs::dir::update_file_info(const std::shared_ptr<vfs::file>& file) noexcept
         if (ztd_contains(this->files_, file))
         {
             ztd::remove(this->files_, file);
+            this->add_memory_usage(-file_memory_usage(file));
             if (file)
             {
                 this->run_event<spacefm::signal::file_deleted>(file);
@@ -427,8 +624,9 @@ vfs::dir::update_created_files() noexcept
             const auto full_path = std::filesystem::path() / this->path_ / created_file;
             if (std::filesystem::exists(full_path))
             {
-                const auto file = vfs::file::create(full_path);
+                const auto file = vfs::file::create(full_path, this->arena_);
                 this->files_.emplace_back(file);
+                this->add_memory_usage(file_memory_usage(file));
 
                 this->run_event<spacefm::signal::file_created>(file);
             }
@@ -463,11 +661,85 @@ vfs::dir::unload_thumbnails(bool is_big) noexcept
             file->unload_small_thumbnail();
         }
     }
+}
+
+usize
+vfs::dir::memory_usage() const noexcept
+{
+    // a removed file can count more than when it was added,
+    // its display strings are formatted lazily
+    return static_cast<usize>(std::max<i64>(this->memory_usage_, 0));
+}
+
+void
+vfs::dir::add_memory_usage(const i64 delta) noexcept
+{
+    this->memory_usage_ += delta;
+    dir_memory_total += delta;
+}
+
+bool
+vfs::dir::is_retainable() const noexcept
+{
+    return this->load_complete_ && !this->avoid_changes_ && !this->removed_;
+}
+
+void
+vfs::dir::suspend() noexcept
+{
+    if (this->suspended_)
+    {
+        return;
+    }
+
+    const auto dir_stat = ztd::statx(this->path_);
+    if (!dir_stat)
+    {
+        this->removed_ = true;
+        return;
+    }
+
+    this->suspended_ = true;
+    this->suspended_mtime_sec_ = dir_stat.mtime().tv_sec;
+    this->suspended_mtime_nsec_ = dir_stat.mtime().tv_nsec;
+    this->monitor_ = nullptr;
+}
+
+bool
+vfs::dir::resume() noexcept
+{
+    if (!this->suspended_)
+    {
+        return true;
+    }
+    this->suspended_ = false;
+
+    const auto dir_stat = ztd::statx(this->path_);
+    if (!dir_stat)
+    {
+        this->removed_ = true;
+        return false;
+    }
+
+    // installed first, so nothing that changes during the check is missed
+    this->monitor_ = vfs::monitor::create(
+        this->path_,
+        std::bind(&vfs::dir::on_monitor_event, this, std::placeholders::_1, std::placeholders::_2));
+
+    if (dir_stat.mtime().tv_sec != this->suspended_mtime_sec_ ||
+        dir_stat.mtime().tv_nsec != this->suspended_mtime_nsec_)
+    {
+        // entries were added, removed or renamed
+        vfs::unique_name::invalidate(this->path_);
+        this->rescan();
+        return true;
+    }
 
-    /* Ensuring free space at the end of the heap is freed to the OS,
-     * mainly to deal with the possibility thousands of large thumbnails
-     * have been freed but the memory not actually released by SpaceFM */
-    malloc_trim(0);
+    // the same names, their contents can still have changed
+    std::scoped_lock<std::mutex> lock(this->lock_);
+    this->changed_files_.assign(this->files_.cbegin(), this->files_.cend());
+    this->update_changed_files();
+    return true;
 }
 
 void
@@ -488,6 +760,38 @@ vfs::dir::reload_mime_type() noexcept
     std::ranges::for_each(this->files_, signal_file_changed_action);
 }
 
+void
+vfs::dir::reload_mime_type(const std::span<const std::string> types) noexcept
+{
+    std::scoped_lock<std::mutex> lock(this->lock_);
+
+    if (this->is_directory_empty())
+    {
+        return;
+    }
+
+    const auto& user_overlay = mime_type_get_user_overlay();
+    const auto is_changed_type = [types](const std::string_view type)
+    { return std::ranges::find(types, type) != types.end(); };
+
+    for (const auto& file : this->files_)
+    {
+        bool reload = is_changed_type(file->mime_type()->type());
+        if (!reload && user_overlay)
+        {
+            // a new user glob can match files of an unchanged type
+            const auto user_type = user_overlay->lookup_filename(file->name());
+            reload = user_type && is_changed_type(user_type.value());
+        }
+
+        if (reload)
+        {
+            file->reload_mime_type();
+            this->run_event<spacefm::signal::file_changed>(file);
+        }
+    }
+}
+
 /* signal handlers */
 void
 vfs::dir::emit_file_created(const std::filesystem::path& filename, bool force) noexcept
@@ -522,6 +826,8 @@ vfs::dir::emit_file_deleted(const std::filesystem::path& filename,
 
         /* clear the whole list */
         this->files_.clear();
+        this->add_memory_usage(static_cast<i64>(sizeof(vfs::dir)) - this->memory_usage_);
+        this->removed_ = true;
 
         this->run_event<spacefm::signal::file_deleted>(nullptr);
 
@@ -17,13 +17,19 @@
 
 #pragma once
 
+#include <string>
+
 #include <filesystem>
 
 #include <vector>
 
+#include <span>
+
+#include <atomic>
 #include <mutex>
 
 #include <memory>
+#include <memory_resource>
 
 #include <glibmm.h>
 #include <sigc++/sigc++.h>
@@ -59,14 +65,27 @@ namespace vfs
         bool is_file_listed() const noexcept;
         bool is_directory_empty() const noexcept;
 
+        // cached effective write access, checked when the dir is loaded and, after
+        // the dir itself changed, by a worker that stores the answer with set_writable()
+        bool is_writable() const noexcept;
+        void set_writable(bool writable) noexcept;
+
         void unload_thumbnails(bool is_big) noexcept;
 
+        // estimated heap usage of the file list in bytes, counted once when
+        // loading completes and then adjusted as files are added and removed
+        usize memory_usage() const noexcept;
+        // loaded and not removed, kept after closing and revalidated on reopen
+        bool is_retainable() const noexcept;
+
         bool add_hidden(const std::shared_ptr<vfs::file>& file) const noexcept;
 
         void cancel_all_thumbnail_requests() noexcept;
         void load_thumbnail(const std::shared_ptr<vfs::file>& file, const bool is_big) noexcept;
 
         void reload_mime_type() noexcept;
+        // only the files that have, or by name would get, one of these types
+        void reload_mime_type(const std::span<const std::string> types) noexcept;
 
         const std::optional<std::vector<std::filesystem::path>> get_hidden_files() const noexcept;
 
@@ -85,9 +104,20 @@ namespace vfs
         void load_thread();
 
         void on_monitor_event(const vfs::monitor::event event, const std::filesystem::path& path);
+        void rescan() noexcept;
+
+      public:
+        // a closed dir in the cache holds no monitor, on reopen the monitor is
+        // installed again and the files are checked against the filesystem
+        void suspend() noexcept;
+        // false if a suspended dir is gone and must not be reused
+        bool resume() noexcept;
+
+      private:
 
         void update_created_files() noexcept;
         void update_changed_files() noexcept;
+        void update_writable() noexcept;
 
         // signal callback
         void on_list_task_finished(bool is_cancelled);
@@ -96,11 +126,16 @@ namespace vfs
         find_file(const std::filesystem::path& filename,
                   const std::shared_ptr<vfs::file>& file) const noexcept;
         bool update_file_info(const std::shared_ptr<vfs::file>& file) noexcept;
+        void add_memory_usage(const i64 delta) noexcept;
 
       private:
         std::filesystem::path path_{};
 
         std::vector<std::shared_ptr<vfs::file>> files_{};
+        // file records are allocated here, they are created on the loader thread
+        // and the main thread so the pool is synchronized
+        std::shared_ptr<std::pmr::memory_resource> arena_{
+            std::make_shared<std::pmr::synchronized_pool_resource>()};
 
         std::shared_ptr<vfs::monitor> monitor_{nullptr};
         std::shared_ptr<vfs::async_thread> task_{nullptr};
@@ -113,9 +148,18 @@ namespace vfs
         // bool cancel_{true};
         // bool show_hidden_{true};
         bool avoid_changes_{true};
+        bool removed_{false};
+        bool suspended_{false};
+        // dir mtime when suspended, entries were added or removed if it differs
+        i64 suspended_mtime_sec_{0};
+        i64 suspended_mtime_nsec_{0};
+        std::atomic<bool> writable_{true};
 
         i64 xhidden_count_{0};
 
+        // see memory_usage(), signed since removed files can be counted larger
+        std::atomic<i64> memory_usage_{0};
+
         std::mutex lock_;
 
         // Signals //
@@ -219,3 +263,10 @@ namespace vfs
 } // namespace vfs
 
 void vfs_dir_mime_type_reload();
+void vfs_dir_mime_type_reload(const std::span<const std::string> types);
+
+// drop least recently used closed dirs until all loaded dirs, open or
+// closed, fit in app_settings.dir_cache_size() bytes
+void vfs_dir_cache_trim();
+// memory held by loaded dirs that are no longer open
+u64 vfs_dir_cache_usage();
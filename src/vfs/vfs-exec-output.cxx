@@ -0,0 +1,339 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <string_view>
+
+#include <fmt/core.h>
+
+#include <filesystem>
+
+#include <span>
+#include <array>
+#include <vector>
+
+#include <optional>
+
+#include <memory>
+
+#include <algorithm>
+#include <ranges>
+
+#include <chrono>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <sys/eventfd.h>
+
+#include <glibmm.h>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "vfs/vfs-user-dirs.hxx"
+
+#include "vfs/vfs-exec-output.hxx"
+
+// larger pipes let chatty commands run ahead of the reader
+inline constexpr i32 PIPE_SIZE = 1024 * 1024;
+inline constexpr usize READ_SIZE = 64 * 1024;
+// a line longer than this is passed on without waiting for its newline
+inline constexpr usize MAX_PENDING = 64 * 1024;
+inline constexpr std::chrono::milliseconds FLUSH_INTERVAL{250};
+
+vfs::exec_output::exec_output(i32 out_fd, i32 err_fd, usize max_bytes,
+                              const output_callback_t& output_cb,
+                              const notice_callback_t& notice_cb,
+                              const finish_callback_t& finish_cb) noexcept
+    : out_fd_(out_fd), err_fd_(err_fd), max_bytes_(max_bytes), output_cb_(output_cb),
+      notice_cb_(notice_cb), finish_cb_(finish_cb)
+{
+    for (const i32 fd : {this->out_fd_, this->err_fd_})
+    {
+        // not fatal, the default pipe size still works
+        if (fcntl(fd, F_SETPIPE_SZ, PIPE_SIZE) == -1)
+        {
+            ztd::logger::debug("exec output: F_SETPIPE_SZ failed: {}", std::strerror(errno));
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    this->wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+}
+
+vfs::exec_output::~exec_output()
+{
+    this->stop();
+
+    if (this->wake_fd_ != -1)
+    {
+        close(this->wake_fd_);
+    }
+    if (this->spill_fd_ != -1)
+    {
+        close(this->spill_fd_);
+    }
+}
+
+const std::shared_ptr<vfs::exec_output>
+vfs::exec_output::create(i32 out_fd, i32 err_fd, usize max_bytes,
+                         const output_callback_t& output_cb,
+                         const notice_callback_t& notice_cb,
+                         const finish_callback_t& finish_cb) noexcept
+{
+    return std::make_shared<vfs::exec_output>(out_fd,
+                                              err_fd,
+                                              max_bytes,
+                                              output_cb,
+                                              notice_cb,
+                                              finish_cb);
+}
+
+void
+vfs::exec_output::start() noexcept
+{
+    this->thread_ =
+        std::jthread([this](const std::stop_token& stop_token) { this->reader_thread(stop_token); });
+}
+
+void
+vfs::exec_output::stop() noexcept
+{
+    this->stopped_ = true;
+
+    if (this->thread_.joinable())
+    {
+        this->thread_.request_stop();
+        if (this->wake_fd_ != -1)
+        {
+            const u64 value = 1;
+            (void)!write(this->wake_fd_, &value, sizeof(value));
+        }
+        this->thread_.join();
+    }
+
+    for (i32* fd : {&this->out_fd_, &this->err_fd_})
+    {
+        if (*fd != -1)
+        {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+bool
+vfs::exec_output::is_finished() const noexcept
+{
+    return this->finished_ || this->stopped_;
+}
+
+const std::optional<std::filesystem::path>
+vfs::exec_output::spill_file() noexcept
+{
+    const std::scoped_lock<std::mutex> lock(this->lock_);
+    return this->spill_file_;
+}
+
+void
+vfs::exec_output::reader_thread(const std::stop_token& stop_token) noexcept
+{
+    std::array<pollfd, 3> fds{{
+        {this->out_fd_, POLLIN, 0},
+        {this->err_fd_, POLLIN, 0},
+        {this->wake_fd_, POLLIN, 0},
+    }};
+
+    std::vector<char> buffer(READ_SIZE);
+    auto last_flush = std::chrono::steady_clock::now();
+
+    while (!stop_token.stop_requested() && (fds[0].fd != -1 || fds[1].fd != -1))
+    {
+        const i32 ret = poll(fds.data(), fds.size(), FLUSH_INTERVAL.count());
+        if (ret == -1 && errno != EINTR)
+        {
+            ztd::logger::error("exec output: poll failed: {}", std::strerror(errno));
+            break;
+        }
+
+        for (const auto i : std::views::iota(0uz, this->pending_.size()))
+        {
+            auto& pfd = fds[i];
+            auto& pending = this->pending_[i];
+            if (pfd.fd == -1 || pfd.revents == 0)
+            {
+                continue;
+            }
+
+            while (true)
+            {
+                const auto length = read(pfd.fd, buffer.data(), buffer.size());
+                if (length > 0)
+                {
+                    pending.append(buffer.data(), length);
+                    if (pending.size() >= MAX_PENDING)
+                    {
+                        this->flush(pending, false);
+                    }
+                    continue;
+                }
+                if (length == -1 && (errno == EAGAIN || errno == EINTR))
+                {
+                    break;
+                }
+                // EOF or error, the fd is closed in stop()
+                pfd.fd = -1;
+                break;
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_flush >= FLUSH_INTERVAL)
+        {
+            for (auto& pending : this->pending_)
+            {
+                this->flush(pending, false);
+            }
+            last_flush = now;
+        }
+    }
+
+    for (auto& pending : this->pending_)
+    {
+        this->flush(pending, true);
+    }
+
+    if (this->stopped_)
+    {
+        return;
+    }
+
+    // finish is run in the main loop thread like the child watch,
+    // finished_ is only set there so both see the same state
+    g_idle_add(
+        [](void* user_data) -> gboolean
+        {
+            auto* weak = static_cast<std::weak_ptr<vfs::exec_output>*>(user_data);
+            const auto self = weak->lock();
+            delete weak;
+            if (self && !self->stopped_)
+            {
+                self->finished_ = true;
+                if (self->finish_cb_)
+                {
+                    self->finish_cb_();
+                }
+            }
+            return G_SOURCE_REMOVE;
+        },
+        new std::weak_ptr<vfs::exec_output>(this->weak_from_this()));
+}
+
+void
+vfs::exec_output::flush(std::string& pending, bool all) noexcept
+{
+    if (pending.empty())
+    {
+        return;
+    }
+
+    // only whole lines unless the line is too long
+    usize end = pending.size();
+    if (!all)
+    {
+        const auto pos = pending.rfind('\n');
+        if (pos != std::string::npos)
+        {
+            end = pos + 1;
+        }
+        else if (pending.size() < MAX_PENDING)
+        {
+            return;
+        }
+    }
+
+    // pass on the whole lines that still fit in the budget. A full log is
+    // tried again next time, the GTK thread drains it in the meantime.
+    std::string_view output(pending.data(), end);
+    usize fits = std::min(output.size(), this->max_bytes_ - this->sent_bytes_);
+    if (fits < output.size())
+    {
+        const auto pos = output.substr(0, fits).rfind('\n');
+        fits = (pos == std::string_view::npos) ? 0 : pos + 1;
+    }
+    if (fits > 0 && this->output_cb_(output.substr(0, fits)))
+    {
+        this->sent_bytes_ += fits;
+        output.remove_prefix(fits);
+    }
+    if (!output.empty())
+    {
+        this->spill(output);
+    }
+
+    pending.erase(0, end);
+}
+
+void
+vfs::exec_output::spill(const std::string_view output) noexcept
+{
+    if (this->spill_fd_ == -1)
+    {
+        const auto path = vfs::user_dirs->program_tmp_dir() /
+                          fmt::format("exec-output-{}.log", ztd::randhex());
+        this->spill_fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (this->spill_fd_ == -1)
+        {
+            ztd::logger::error("exec output: failed to create {}: {}",
+                               path.string(),
+                               std::strerror(errno));
+            // keep dropping output instead of retrying for every chunk
+            this->spill_fd_ = open("/dev/null", O_WRONLY | O_CLOEXEC);
+            this->notice_cb_("\n[ output that did not fit in the task log was dropped ]\n");
+        }
+        else
+        {
+            {
+                const std::scoped_lock<std::mutex> lock(this->lock_);
+                this->spill_file_ = path;
+            }
+            this->notice_cb_(
+                fmt::format("\n[ output that did not fit in the task log is saved to {} ]\n",
+                            path.string()));
+        }
+    }
+
+    usize written = 0;
+    while (written < output.size())
+    {
+        const auto length =
+            write(this->spill_fd_, output.data() + written, output.size() - written);
+        if (length == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            ztd::logger::error("exec output: write failed: {}", std::strerror(errno));
+            break;
+        }
+        written += length;
+    }
+}
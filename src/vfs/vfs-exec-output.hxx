@@ -0,0 +1,106 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <filesystem>
+
+#include <array>
+
+#include <optional>
+
+#include <memory>
+
+#include <functional>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <stop_token>
+
+#include <ztd/ztd.hxx>
+
+namespace vfs
+{
+    // Reads the stdout and stderr pipes of an exec task on its own thread.
+    // Output of each pipe is coalesced into whole lines and handed out at most
+    // every FLUSH_INTERVAL. Output that is not accepted, and all output once
+    // more than max_bytes were handed out, is written to a file in the program
+    // tmp dir instead.
+    struct exec_output : public std::enable_shared_from_this<exec_output>
+    {
+        // called on the reader thread, returns false if the output was not
+        // accepted, it goes to the spill file. The next output is tried again.
+        using output_callback_t = std::function<bool(const std::string_view output)>;
+        // called on the reader thread for messages that must not be lost
+        using notice_callback_t = std::function<void(const std::string_view notice)>;
+        // called in the main loop thread once both pipes are closed
+        using finish_callback_t = std::function<void()>;
+
+        exec_output() = delete;
+        exec_output(i32 out_fd, i32 err_fd, usize max_bytes, const output_callback_t& output_cb,
+                    const notice_callback_t& notice_cb,
+                    const finish_callback_t& finish_cb) noexcept;
+        ~exec_output();
+        exec_output(const exec_output& other) = delete;
+        exec_output& operator=(const exec_output& other) = delete;
+
+        static const std::shared_ptr<vfs::exec_output>
+        create(i32 out_fd, i32 err_fd, usize max_bytes, const output_callback_t& output_cb,
+               const notice_callback_t& notice_cb, const finish_callback_t& finish_cb) noexcept;
+
+        void start() noexcept;
+
+        // stop reading and close the pipes, the finish callback is not run
+        void stop() noexcept;
+
+        // all output was handed out or stop() was called, main loop thread only
+        [[nodiscard]] bool is_finished() const noexcept;
+
+        // set once output started to be written to a file
+        const std::optional<std::filesystem::path> spill_file() noexcept;
+
+      private:
+        void reader_thread(const std::stop_token& stop_token) noexcept;
+        void flush(std::string& pending, bool all) noexcept;
+        void spill(const std::string_view output) noexcept;
+
+        i32 out_fd_{-1};
+        i32 err_fd_{-1};
+        i32 wake_fd_{-1}; // eventfd to interrupt poll() in stop()
+        usize max_bytes_{0};
+
+        output_callback_t output_cb_{nullptr};
+        notice_callback_t notice_cb_{nullptr};
+        finish_callback_t finish_cb_{nullptr};
+
+        // only used by the reader thread, stdout and stderr, so their
+        // lines are not mixed
+        std::array<std::string, 2> pending_{};
+        usize sent_bytes_{0};
+        i32 spill_fd_{-1};
+
+        std::mutex lock_;
+        std::optional<std::filesystem::path> spill_file_{std::nullopt};
+
+        std::atomic<bool> finished_{false};
+        std::atomic<bool> stopped_{false};
+
+        std::jthread thread_;
+    };
+} // namespace vfs
@@ -24,13 +24,22 @@
 
 #include <vector>
 
+#include <fstream>
+
 #include <chrono>
 
 #include <memory>
 
+#include <algorithm>
 #include <ranges>
 
+#include <atomic>
+#include <thread>
+
+#include <cstring>
+
 #include <fcntl.h>
+#include <unistd.h>
 #include <utime.h>
 
 #include <malloc.h>
@@ -53,6 +62,8 @@
 #include "main-window.hxx"
 #include "vfs/vfs-volume.hxx"
 #include "vfs/vfs-utils.hxx"
+#include "vfs/vfs-exec-output.hxx"
+#include "vfs/vfs-unique-name.hxx"
 
 #include "write.hxx"
 #include "utils.hxx"
@@ -61,6 +72,9 @@
 #include "vfs/vfs-trash-can.hxx"
 #include "vfs/vfs-file-task.hxx"
 
+// read/write size when copying file contents
+inline constexpr usize COPY_BUFFER_SIZE = 128 * 1024;
+
 inline constexpr std::array<std::filesystem::perms, 12> chmod_flags{
     // User
     std::filesystem::perms::owner_read,
@@ -84,6 +98,12 @@ inline constexpr std::array<std::filesystem::perms, 12> chmod_flags{
     std::filesystem::perms::sticky_bit,
 };
 
+// find_dups reads this much from the start and the end of each candidate first
+inline constexpr u64 DUP_BLOCK_SIZE = 4096;
+inline constexpr u32 MAX_HASH_WORKERS = 4;
+// full hashes are computed for at least this many inodes at a time
+inline constexpr usize DUP_HASH_BATCH = 16;
+
 const std::shared_ptr<vfs::file_task>
 vfs::file_task::create(const vfs::file_task::type task_type,
                        const std::span<const std::filesystem::path> src_files,
@@ -110,11 +130,9 @@ vfs::file_task::file_task(const vfs::file_task::type task_type,
     this->mutex = (GMutex*)malloc(sizeof(GMutex));
     g_mutex_init(this->mutex);
 
-    GtkTextIter iter;
-    this->add_log_buf = gtk_text_buffer_new(nullptr);
-    this->add_log_end = gtk_text_mark_new(nullptr, false);
-    gtk_text_buffer_get_end_iter(this->add_log_buf, &iter);
-    gtk_text_buffer_add_mark(this->add_log_buf, this->add_log_end, &iter);
+    // Init GCond
+    this->src_paths_cond = (GCond*)malloc(sizeof(GCond));
+    g_cond_init(this->src_paths_cond);
 
     this->start_time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
     this->timer = ztd::timer();
@@ -125,8 +143,8 @@ vfs::file_task::~file_task()
     g_mutex_clear(this->mutex);
     std::free(this->mutex);
 
-    gtk_text_buffer_set_text(this->add_log_buf, "", -1);
-    g_object_unref(this->add_log_buf);
+    g_cond_clear(this->src_paths_cond);
+    std::free(this->src_paths_cond);
 }
 
 void
@@ -167,6 +185,15 @@ vfs::file_task::set_recursive(bool recursive)
     this->is_recursive = recursive;
 }
 
+void
+vfs::file_task::set_sync(const vfs::file_task::sync_mode mode, bool compare_content)
+{
+    this->sync_mode_ = mode;
+    this->sync_content = compare_content;
+    // what to replace is decided by the sync itself, never ask
+    this->overwrite_mode_ = vfs::file_task::overwrite_mode::overwrite_all;
+}
+
 void
 vfs::file_task::set_overwrite_mode(const vfs::file_task::overwrite_mode mode)
 {
@@ -174,13 +201,51 @@ vfs::file_task::set_overwrite_mode(const vfs::file_task::overwrite_mode mode)
 }
 
 void
-vfs::file_task::append_add_log(const std::string_view msg)
+vfs::file_task::add_src_paths(const std::span<const std::filesystem::path> src_files)
+{
+    this->lock();
+    this->src_paths.insert(this->src_paths.end(), src_files.begin(), src_files.end());
+    g_cond_broadcast(this->src_paths_cond);
+    this->unlock();
+}
+
+void
+vfs::file_task::set_src_paths_complete(bool complete)
+{
+    this->lock();
+    this->src_paths_complete = complete;
+    g_cond_broadcast(this->src_paths_cond);
+    this->unlock();
+}
+
+/*
+ * Get the source file at index, waiting for it to be added if the
+ * source list is still open. Returns std::nullopt once all sources
+ * have been processed or the task was aborted.
+ */
+const std::optional<std::filesystem::path>
+vfs::file_task::next_src_path(usize index)
 {
     this->lock();
-    GtkTextIter iter;
-    gtk_text_buffer_get_iter_at_mark(this->add_log_buf, &iter, this->add_log_end);
-    gtk_text_buffer_insert(this->add_log_buf, &iter, msg.data(), msg.length());
+    while (index >= this->src_paths.size() && !this->src_paths_complete && !this->abort)
+    {
+        g_cond_wait(this->src_paths_cond, this->mutex);
+    }
+    if (index >= this->src_paths.size() || this->abort)
+    {
+        this->unlock();
+        return std::nullopt;
+    }
+    const auto src_path = this->src_paths.at(index);
     this->unlock();
+    return src_path;
+}
+
+bool
+vfs::file_task::append_add_log(const std::string_view msg, const vfs::task_log::level level)
+{
+    // no task lock, the log is drained by the GTK thread in batches
+    return this->add_log.push(level, msg);
 }
 
 bool
@@ -190,16 +255,31 @@ vfs::file_task::should_abort()
     {
         // paused or queued - suspend thread
         this->lock();
-        this->timer.stop();
-        this->pause_cond = g_cond_new();
+        if (this->state_pause_ == vfs::file_task::state::running)
+        {
+            // resumed by another thread meanwhile
+            this->unlock();
+            return this->abort;
+        }
+        // the hash workers of find_dups all wait on the same condition
+        if (!this->pause_cond)
+        {
+            this->timer.stop();
+            this->pause_cond = g_cond_new();
+        }
+        this->pause_waiters += 1;
         g_cond_wait(this->pause_cond, this->mutex);
         // resume
-        g_cond_free(this->pause_cond);
-        this->pause_cond = nullptr;
-        this->last_elapsed = this->timer.elapsed();
-        this->last_progress = this->progress;
-        this->last_speed = 0;
-        this->timer.start();
+        this->pause_waiters -= 1;
+        if (this->pause_waiters == 0)
+        {
+            g_cond_free(this->pause_cond);
+            this->pause_cond = nullptr;
+            this->last_elapsed = this->timer.elapsed();
+            this->last_progress = this->progress;
+            this->last_speed = 0;
+            this->timer.start();
+        }
         this->state_pause_ = vfs::file_task::state::running;
         this->unlock();
     }
@@ -254,9 +334,9 @@ vfs::file_task::check_overwrite(const std::filesystem::path& dest_file, bool* de
 
             const auto filename_parts = split_basename_extension(old_name);
 
-            *new_dest_file = ztd::strdup(vfs_get_unique_name(dest_file_dir,
-                                                             filename_parts.basename,
-                                                             filename_parts.extension));
+            *new_dest_file = ztd::strdup(vfs::unique_name::get(dest_file_dir,
+                                                               filename_parts.basename,
+                                                               filename_parts.extension));
             *dest_exists = false;
             if (*new_dest_file)
             {
@@ -373,7 +453,7 @@ vfs::file_task::check_dest_in_src(const std::filesystem::path& src_dir)
         fmt::format("Destination directory \"{}\" is contained in source \"{}\"",
                     checked_dest_dir.string(),
                     src_dir.string());
-    this->append_add_log(err);
+    this->append_add_log(err, vfs::task_log::level::error);
     if (this->state_cb)
     {
         this->state_cb(this->shared_from_this(),
@@ -395,6 +475,166 @@ vfs::file_task::file_copy(const std::filesystem::path& src_file)
     this->do_file_copy(src_file, dest_file);
 }
 
+bool
+vfs::file_task::copy_file_data(i32 rfd, i32 wfd, const ztd::statx& file_stat,
+                               const std::filesystem::path& src_file,
+                               const std::filesystem::path& dest_file)
+{
+    std::vector<char> buffer(COPY_BUFFER_SIZE);
+
+    // copy [offset, end), end of -1 copies to EOF
+    const auto copy_range = [&](off_t offset, off_t end) -> bool
+    {
+        while (end == -1 || offset < end)
+        {
+            if (this->should_abort())
+            {
+                return false;
+            }
+
+            usize count = buffer.size();
+            if (end != -1)
+            {
+                count = std::min(count, static_cast<usize>(end - offset));
+            }
+            const auto rsize = pread(rfd, buffer.data(), count, offset);
+            if (rsize == 0)
+            {
+                break;
+            }
+            if (rsize == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                this->task_error(errno, "Reading", src_file);
+                return false;
+            }
+
+            isize written = 0;
+            while (written < rsize)
+            {
+                const auto length =
+                    pwrite(wfd, buffer.data() + written, rsize - written, offset + written);
+                if (length == -1)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    this->task_error(errno, "Writing", dest_file);
+                    return false;
+                }
+                written += length;
+            }
+
+            this->lock();
+            this->progress += rsize;
+            this->unlock();
+
+            offset += rsize;
+        }
+        return true;
+    };
+
+    // fewer blocks than the size needs, the file has holes
+    const auto size = static_cast<off_t>(file_stat.size());
+    if (file_stat.blocks() * 512 >= file_stat.size())
+    {
+        return copy_range(0, -1);
+    }
+
+    // only copy the data extents, the holes are left unwritten in the
+    // new file so they stay holes
+    off_t pos = 0;
+    while (pos < size)
+    {
+        const off_t data = lseek(rfd, pos, SEEK_DATA);
+        if (data == -1)
+        {
+            if (errno == ENXIO)
+            {
+                // a hole up to EOF
+                break;
+            }
+            // holes are not reported by this filesystem
+            return copy_range(pos, -1);
+        }
+        const off_t hole = lseek(rfd, data, SEEK_HOLE);
+        if (hole == -1)
+        {
+            return copy_range(pos, -1);
+        }
+
+        this->lock();
+        this->progress += data - pos;
+        this->unlock();
+
+        if (!copy_range(data, hole))
+        {
+            return false;
+        }
+        pos = hole;
+    }
+
+    this->lock();
+    this->progress += std::max(size - pos, off_t(0));
+    this->unlock();
+
+    // a trailing hole only exists once the size is set
+    if (ftruncate(wfd, size) == -1)
+    {
+        this->task_error(errno, "Writing", dest_file);
+        return false;
+    }
+    return true;
+}
+
+bool
+vfs::file_task::copy_hardlink(const ztd::statx& file_stat, const std::filesystem::path& dest_file,
+                              bool replace)
+{
+    // a move removes each source link after copying it, so the link
+    // count cannot be used to skip the lookup
+    if (this->copied_inodes.empty())
+    {
+        return false;
+    }
+
+    const auto it = this->copied_inodes.find({file_stat.dev(), file_stat.ino()});
+    if (it == this->copied_inodes.cend())
+    {
+        return false;
+    }
+
+    const auto& target = it->second.dest;
+    i32 ret = linkat(AT_FDCWD, target.c_str(), AT_FDCWD, dest_file.c_str(), 0);
+    if (ret == -1 && errno == EEXIST && replace)
+    {
+        // overwrite was already confirmed by check_overwrite()
+        std::error_code ec;
+        std::filesystem::remove(dest_file, ec);
+        ret = linkat(AT_FDCWD, target.c_str(), AT_FDCWD, dest_file.c_str(), 0);
+    }
+    if (ret == -1)
+    {
+        // destination filesystem may not support hard links, copy instead
+        ztd::logger::debug("linkat {} -> {} failed: {}",
+                           dest_file.string(),
+                           target.string(),
+                           std::strerror(errno));
+        return false;
+    }
+
+    it->second.links_left -= 1;
+    if (it->second.links_left == 0)
+    {
+        this->copied_inodes.erase(it);
+    }
+    return true;
+}
+
 bool
 vfs::file_task::do_file_copy(const std::filesystem::path& src_file,
                              const std::filesystem::path& dest_file)
@@ -625,74 +865,84 @@ vfs::file_task::do_file_copy(const std::filesystem::path& src_file,
                 }
             }
 
-            const i32 wfd = creat(actual_dest_file.c_str(), file_stat.mode() | S_IWUSR);
-            if (wfd >= 0)
+            if (this->copy_hardlink(file_stat, actual_dest_file, new_dest_file == nullptr))
             {
-                // sshfs becomes unresponsive with this, nfs is okay with it
-                // if (this->avoid_changes)
-                //    emit_created(actual_dest_file);
-                char buffer[4096];
-                isize rsize;
-                while ((rsize = read(rfd, buffer, sizeof(buffer))) > 0)
-                {
-                    if (this->should_abort())
-                    {
-                        copy_fail = true;
-                        break;
-                    }
+                this->lock();
+                this->progress += file_stat.size();
+                this->unlock();
 
-                    const auto length = write(wfd, buffer, rsize);
-                    if (length > 0)
-                    {
-                        this->lock();
-                        this->progress += rsize;
-                        this->unlock();
-                    }
-                    else
+                /* Move files to different device: Need to delete source files */
+                if ((this->type_ == vfs::file_task::type::move) && !this->should_abort())
+                {
+                    std::filesystem::remove(src_file);
+                    if (std::filesystem::exists(src_file))
                     {
-                        this->task_error(errno, "Writing", actual_dest_file);
+                        this->task_error(errno, "Removing", src_file);
                         copy_fail = true;
-                        break;
                     }
                 }
-                close(wfd);
-                if (copy_fail)
+            }
+            else
+            {
+                // renamed destination must not replace a file created since it was picked
+                const i32 wfd = open(actual_dest_file.c_str(),
+                                     O_WRONLY | O_CREAT | (new_dest_file ? O_EXCL : O_TRUNC),
+                                     file_stat.mode() | S_IWUSR);
+                if (wfd >= 0)
                 {
-                    std::filesystem::remove(actual_dest_file);
-                    if (std::filesystem::exists(src_file) && errno != 2 /* no such file */)
+                    // sshfs becomes unresponsive with this, nfs is okay with it
+                    // if (this->avoid_changes)
+                    //    emit_created(actual_dest_file);
+                    if (!this->copy_file_data(rfd, wfd, file_stat, src_file, actual_dest_file))
                     {
-                        this->task_error(errno, "Removing", actual_dest_file);
                         copy_fail = true;
                     }
-                }
-                else
-                {
-                    // MOD do not chmod link
-                    if (!std::filesystem::is_symlink(actual_dest_file))
+                    close(wfd);
+                    if (copy_fail)
                     {
-                        chmod(actual_dest_file.c_str(), file_stat.mode());
-                        struct utimbuf times;
-                        times.actime = file_stat.atime().tv_sec;
-                        times.modtime = file_stat.mtime().tv_sec;
-                        utime(actual_dest_file.c_str(), &times);
+                        std::filesystem::remove(actual_dest_file);
+                        if (std::filesystem::exists(src_file) && errno != 2 /* no such file */)
+                        {
+                            this->task_error(errno, "Removing", actual_dest_file);
+                            copy_fail = true;
+                        }
                     }
-
-                    /* Move files to different device: Need to delete source files */
-                    if ((this->type_ == vfs::file_task::type::move) && !this->should_abort())
+                    else
                     {
-                        std::filesystem::remove(src_file);
-                        if (std::filesystem::exists(src_file))
+                        // MOD do not chmod link
+                        if (!std::filesystem::is_symlink(actual_dest_file))
                         {
-                            this->task_error(errno, "Removing", src_file);
-                            copy_fail = true;
+                            chmod(actual_dest_file.c_str(), file_stat.mode());
+                            struct utimbuf times;
+                            times.actime = file_stat.atime().tv_sec;
+                            times.modtime = file_stat.mtime().tv_sec;
+                            utime(actual_dest_file.c_str(), &times);
+                        }
+
+                        if (file_stat.nlink() > 1)
+                        {
+                            this->copied_inodes.insert_or_assign(
+                                {file_stat.dev(), file_stat.ino()},
+                                copied_inode{actual_dest_file, file_stat.nlink() - 1});
+                        }
+
+                        /* Move files to different device: Need to delete source files */
+                        if ((this->type_ == vfs::file_task::type::move) && !this->should_abort())
+                        {
+                            std::filesystem::remove(src_file);
+                            if (std::filesystem::exists(src_file))
+                            {
+                                this->task_error(errno, "Removing", src_file);
+                                copy_fail = true;
+                            }
                         }
                     }
                 }
-            }
-            else
-            {
-                this->task_error(errno, "Creating", actual_dest_file);
-                copy_fail = true;
+                else
+                {
+                    this->task_error(errno, "Creating", actual_dest_file);
+                    copy_fail = true;
+                }
             }
             close(rfd);
         }
@@ -831,11 +1081,21 @@ vfs::file_task::do_file_move(const std::filesystem::path& src_file,
     }
 
     std::error_code err;
-    std::filesystem::rename(src_file, dest_file, err);
+    if (new_dest_file)
+    {
+        // renamed destination must not replace a file created since it was picked
+        const i32 result = vfs_rename_noreplace(src_file, dest_file);
+        err.assign(result, std::generic_category());
+        errno = result;
+    }
+    else
+    {
+        std::filesystem::rename(src_file, dest_file, err);
+    }
 
     if (err.value() != 0)
     {
-        if (err.value() == -1 && errno == EXDEV)
+        if (err.value() == EXDEV || (err.value() == -1 && errno == EXDEV))
         { // Invalid cross-link device
             return 18;
         }
@@ -875,102 +1135,827 @@ vfs::file_task::file_trash(const std::filesystem::path& src_file)
         return;
     }
 
-    this->lock();
-    this->current_file = src_file;
-    this->current_item++;
-    this->unlock();
+    this->lock();
+    this->current_file = src_file;
+    this->current_item++;
+    this->unlock();
+
+    const auto file_stat = ztd::statx(src_file, ztd::statx::symlink::no_follow);
+    if (!file_stat)
+    {
+        this->task_error(errno, "Accessing", src_file);
+        return;
+    }
+
+    if (!have_rw_access(src_file))
+    {
+        // this->task_error(errno, "Trashing", src_file);
+        ztd::logger::error("Trashing failed missing RW permissions '{}'", src_file.string());
+        return;
+    }
+
+    const bool result = vfs::trash_can::trash(src_file);
+
+    if (!result)
+    {
+        this->task_error(errno, "Trashing", src_file);
+        return;
+    }
+
+    this->lock();
+    this->progress += file_stat.size();
+    if (this->error_first)
+    {
+        this->error_first = false;
+    }
+    this->unlock();
+}
+
+bool
+vfs::file_task::file_rename(const std::filesystem::path& src_file,
+                            const std::filesystem::path& dest_file)
+{
+    if (this->should_abort())
+    {
+        return false;
+    }
+
+    this->lock();
+    this->current_file = src_file;
+    this->current_dest = dest_file;
+    this->current_item++;
+    this->unlock();
+
+    const auto file_stat = ztd::statx(src_file, ztd::statx::symlink::no_follow);
+    if (!file_stat)
+    {
+        this->task_error(errno, "Accessing", src_file);
+        return false;
+    }
+
+    // the plan was checked for collisions, never replace a file that showed up since
+    const i32 result = vfs_rename_noreplace(src_file, dest_file);
+    if (result != 0)
+    {
+        this->task_error(result, "Renaming", src_file);
+        return false;
+    }
+
+    this->lock();
+    this->progress += file_stat.size();
+    if (this->error_first)
+    {
+        this->error_first = false;
+    }
+    this->unlock();
+    return true;
+}
+
+void
+vfs::file_task::undo_renames(usize count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // the plan is applied as a whole, a partly applied plan would also leave
+    // files of a broken cycle under their temporary name
+    this->append_add_log(fmt::format("Renaming stopped, undoing {} renames\n", count),
+                         vfs::task_log::level::error);
+
+    for (const auto index : std::views::iota(0uz, count) | std::views::reverse)
+    {
+        // not next_src_path(), it stops returning paths once the task is aborted
+        this->lock();
+        const auto src_file = this->src_paths.at(index);
+        this->unlock();
+
+        const auto& dest_file = this->rename_dest_paths.at(index);
+        const i32 result = vfs_rename_noreplace(dest_file, src_file);
+        if (result != 0)
+        {
+            this->append_add_log(fmt::format("Cannot undo renaming {} to {}: {}\n",
+                                             src_file.string(),
+                                             dest_file.string(),
+                                             std::strerror(result)),
+                                 vfs::task_log::level::error);
+        }
+    }
+}
+
+void
+vfs::file_task::file_delete(const std::filesystem::path& src_file)
+{
+    if (this->should_abort())
+    {
+        return;
+    }
+
+    this->lock();
+    this->current_file = src_file;
+    this->current_item++;
+    this->unlock();
+
+    const auto file_stat = ztd::statx(src_file, ztd::statx::symlink::no_follow);
+    if (!file_stat)
+    {
+        this->task_error(errno, "Accessing", src_file);
+        return;
+    }
+
+    if (file_stat.is_directory())
+    {
+        for (const auto& file : std::filesystem::directory_iterator(src_file))
+        {
+            const auto filename = file.path().filename();
+            if (this->should_abort())
+            {
+                break;
+            }
+            const auto sub_src_file = src_file / filename;
+            this->file_delete(sub_src_file);
+        }
+
+        if (this->should_abort())
+        {
+            return;
+        }
+        std::filesystem::remove_all(src_file);
+        if (std::filesystem::exists(src_file))
+        {
+            this->task_error(errno, "Removing", src_file);
+            return;
+        }
+    }
+    else
+    {
+        std::filesystem::remove(src_file);
+        if (std::filesystem::exists(src_file))
+        {
+            this->task_error(errno, "Removing", src_file);
+            return;
+        }
+    }
+    this->lock();
+    this->progress += file_stat.size();
+    if (this->error_first)
+    {
+        this->error_first = false;
+    }
+    this->unlock();
+}
+
+bool
+vfs::file_task::is_synced(const std::filesystem::path& src_file, const ztd::statx& src_stat,
+                          const std::filesystem::path& dest_file, const ztd::statx& dest_stat)
+{
+    if ((src_stat.mode() & S_IFMT) != (dest_stat.mode() & S_IFMT))
+    {
+        return false;
+    }
+
+    if (src_stat.is_symlink())
+    {
+        // the copy does not keep the link mtime
+        std::error_code ec;
+        const auto src_target = std::filesystem::read_symlink(src_file, ec);
+        const auto dest_target = std::filesystem::read_symlink(dest_file, ec);
+        return !ec && src_target == dest_target;
+    }
+
+    if (!src_stat.is_regular_file())
+    {
+        return true;
+    }
+
+    if (src_stat.size() != dest_stat.size())
+    {
+        return false;
+    }
+
+    if (!this->sync_content)
+    {
+        // the copy sets the mtime in whole seconds
+        return src_stat.mtime().tv_sec == dest_stat.mtime().tv_sec;
+    }
+
+    const i32 src_fd = open(src_file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src_fd == -1)
+    {
+        return false;
+    }
+    const i32 dest_fd = open(dest_file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (dest_fd == -1)
+    {
+        close(src_fd);
+        return false;
+    }
+    posix_fadvise(src_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(dest_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    std::vector<char> src_buffer(COPY_BUFFER_SIZE);
+    std::vector<char> dest_buffer(COPY_BUFFER_SIZE);
+    bool same = true;
+    while (same && !this->should_abort())
+    {
+        const auto length = read(src_fd, src_buffer.data(), src_buffer.size());
+        if (length <= 0)
+        {
+            same = (length == 0);
+            break;
+        }
+        usize got = 0;
+        while (got < static_cast<usize>(length))
+        {
+            const auto n = read(dest_fd, dest_buffer.data() + got, length - got);
+            if (n <= 0)
+            {
+                break;
+            }
+            got += n;
+        }
+        same = (got == static_cast<usize>(length)) &&
+               std::equal(src_buffer.cbegin(), src_buffer.cbegin() + length, dest_buffer.cbegin());
+    }
+
+    close(src_fd);
+    close(dest_fd);
+    return same;
+}
+
+void
+vfs::file_task::plan_sync(const std::filesystem::path& src_file,
+                          const std::filesystem::path& dest_file,
+                          std::vector<vfs::file_task::sync_action>& actions)
+{
+    if (this->should_abort())
+    {
+        return;
+    }
+
+    const bool two_way = this->sync_mode_ == vfs::file_task::sync_mode::two_way;
+
+    const auto add_action = [this, &actions](const vfs::file_task::sync_action::kind kind,
+                                             const std::filesystem::path& from,
+                                             const std::filesystem::path& to)
+    {
+        // only copied bytes advance the progress, deleting the old dest does not
+        if (kind == vfs::file_task::sync_action::kind::copy ||
+            kind == vfs::file_task::sync_action::kind::replace)
+        {
+            const u64 size = this->get_total_size_of_dir(from);
+            this->lock();
+            this->total_size += size;
+            this->unlock();
+        }
+
+        actions.push_back({kind, from, to});
+    };
+
+    const auto src_stat = ztd::statx(src_file, ztd::statx::symlink::no_follow);
+    const auto dest_stat = ztd::statx(dest_file, ztd::statx::symlink::no_follow);
+    if (!src_stat)
+    {
+        if (!dest_stat)
+        {
+            return;
+        }
+        if (two_way)
+        {
+            add_action(vfs::file_task::sync_action::kind::copy, dest_file, src_file);
+        }
+        else if (this->sync_mode_ == vfs::file_task::sync_mode::one_way_delete)
+        {
+            add_action(vfs::file_task::sync_action::kind::remove, src_file, dest_file);
+        }
+        return;
+    }
+    if (!dest_stat)
+    {
+        add_action(vfs::file_task::sync_action::kind::copy, src_file, dest_file);
+        return;
+    }
+
+    if (src_stat.is_directory() && dest_stat.is_directory())
+    {
+        // one sorted pass over both listings, only the differences are stat'ed twice
+        const auto list = [](const std::filesystem::path& dir, std::error_code& ec)
+        {
+            std::vector<std::string> names;
+            auto it = std::filesystem::directory_iterator(dir, ec);
+            for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+            {
+                names.push_back(it->path().filename());
+            }
+            std::ranges::sort(names);
+            return names;
+        };
+        std::error_code src_ec;
+        std::error_code dest_ec;
+        const auto src_names = list(src_file, src_ec);
+        const auto dest_names = list(dest_file, dest_ec);
+        if (src_ec || dest_ec)
+        {
+            // a partial listing would plan copies or removals for files that
+            // are still there, so the whole subtree is left alone
+            const auto& dir = src_ec ? src_file : dest_file;
+            this->append_add_log(fmt::format("Cannot read {}, not synced: {}\n",
+                                             dir.string(),
+                                             (src_ec ? src_ec : dest_ec).message()),
+                                 vfs::task_log::level::error);
+            return;
+        }
+
+        auto src_it = src_names.cbegin();
+        auto dest_it = dest_names.cbegin();
+        while ((src_it != src_names.cend() || dest_it != dest_names.cend()) &&
+               !this->should_abort())
+        {
+            if (dest_it == dest_names.cend() ||
+                (src_it != src_names.cend() && *src_it < *dest_it))
+            {
+                add_action(vfs::file_task::sync_action::kind::copy,
+                           src_file / *src_it,
+                           dest_file / *src_it);
+                ++src_it;
+            }
+            else if (src_it == src_names.cend() || *dest_it < *src_it)
+            {
+                if (two_way)
+                {
+                    add_action(vfs::file_task::sync_action::kind::copy,
+                               dest_file / *dest_it,
+                               src_file / *dest_it);
+                }
+                else if (this->sync_mode_ == vfs::file_task::sync_mode::one_way_delete)
+                {
+                    add_action(vfs::file_task::sync_action::kind::remove,
+                               src_file / *dest_it,
+                               dest_file / *dest_it);
+                }
+                ++dest_it;
+            }
+            else
+            {
+                this->plan_sync(src_file / *src_it, dest_file / *dest_it, actions);
+                ++src_it;
+                ++dest_it;
+            }
+        }
+        return;
+    }
+
+    if (this->is_synced(src_file, src_stat, dest_file, dest_stat))
+    {
+        return;
+    }
+
+    const bool same_type = (src_stat.mode() & S_IFMT) == (dest_stat.mode() & S_IFMT);
+    if (two_way && !same_type)
+    {
+        // the newer mtime says nothing about which side is wanted, replacing
+        // would delete a whole file or dir, so the user has to decide
+        add_action(vfs::file_task::sync_action::kind::conflict, src_file, dest_file);
+        return;
+    }
+
+    const auto kind = same_type ? vfs::file_task::sync_action::kind::copy
+                                : vfs::file_task::sync_action::kind::replace;
+    if (two_way && dest_stat.mtime().tv_sec > src_stat.mtime().tv_sec)
+    {
+        add_action(kind, dest_file, src_file);
+    }
+    else
+    {
+        add_action(kind, src_file, dest_file);
+    }
+}
+
+void
+vfs::file_task::file_sync(const std::filesystem::path& src_file)
+{
+    if (this->should_abort())
+    {
+        return;
+    }
+
+    const auto dest_file = this->dest_dir.value() / src_file.filename();
+
+    const auto file_stat = ztd::statx(src_file, ztd::statx::symlink::no_follow);
+    if (!file_stat)
+    {
+        this->task_error(errno, "Accessing", src_file);
+        return;
+    }
+    if (file_stat.is_directory() && this->check_dest_in_src(src_file))
+    {
+        return;
+    }
+
+    this->lock();
+    this->current_file = src_file;
+    this->current_dest = dest_file;
+    this->unlock();
+
+    // everything is compared before anything is changed, so the total size
+    // only covers what is transferred and the progress is for the whole sync
+    std::vector<vfs::file_task::sync_action> actions;
+    this->plan_sync(src_file, dest_file, actions);
+    if (actions.empty())
+    {
+        this->append_add_log(fmt::format("Already in sync: {}\n", src_file.string()));
+        return;
+    }
+
+    for (const auto& action : actions)
+    {
+        if (this->should_abort())
+        {
+            break;
+        }
+
+        switch (action.op)
+        {
+            case vfs::file_task::sync_action::kind::copy:
+                this->do_file_copy(action.src, action.dest);
+                break;
+            case vfs::file_task::sync_action::kind::replace:
+                this->file_delete(action.dest);
+                if (!std::filesystem::exists(action.dest))
+                {
+                    this->do_file_copy(action.src, action.dest);
+                }
+                break;
+            case vfs::file_task::sync_action::kind::remove:
+                this->file_delete(action.dest);
+                break;
+            case vfs::file_task::sync_action::kind::conflict:
+                this->append_add_log(
+                    fmt::format("Not synced, {} and {} are not the same file type\n",
+                                action.src.string(),
+                                action.dest.string()),
+                    vfs::task_log::level::error);
+                break;
+        }
+    }
+}
+
+void
+vfs::file_task::file_find_dups(const std::filesystem::path& src_file)
+{
+    if (this->should_abort())
+    {
+        return;
+    }
+
+    const auto file_stat = ztd::statx(src_file, ztd::statx::symlink::no_follow);
+    if (!file_stat)
+    {
+        this->task_error(errno, "Accessing", src_file);
+        return;
+    }
+
+    // only collected here, the hashing starts once every source was walked
+    this->walk_dups(src_file, file_stat);
+}
+
+void
+vfs::file_task::walk_dups(const std::filesystem::path& path, const ztd::statx& file_stat)
+{
+    if (file_stat.is_directory())
+    {
+        this->lock();
+        this->current_file = path;
+        this->unlock();
+
+        std::error_code ec;
+        for (const auto& file : std::filesystem::directory_iterator(path, ec))
+        {
+            if (this->should_abort())
+            {
+                return;
+            }
+            // entries removed since the listing are skipped
+            const auto stat = ztd::statx(file.path(), ztd::statx::symlink::no_follow);
+            if (stat)
+            {
+                this->walk_dups(file.path(), stat);
+            }
+        }
+        return;
+    }
+
+    // empty files are all equal and free nothing
+    if (!file_stat.is_regular_file() || file_stat.size() == 0)
+    {
+        return;
+    }
+
+    // the sources are siblings and symlinks are not followed, so a file
+    // with a single link is only reached once and needs no index entry
+    if (file_stat.nlink() > 1)
+    {
+        const auto seen = this->dup_seen.find({file_stat.dev(), file_stat.ino()});
+        if (seen != this->dup_seen.cend())
+        {
+            auto& inode = this->dup_sizes[seen->second.first][seen->second.second];
+            // the same path is found again when sources overlap
+            if (std::ranges::find(inode.paths, path) == inode.paths.cend())
+            {
+                inode.paths.push_back(path);
+            }
+            return;
+        }
+    }
+
+    auto& bucket = this->dup_sizes[file_stat.size()];
+    if (file_stat.nlink() > 1)
+    {
+        this->dup_seen.insert(
+            {{file_stat.dev(), file_stat.ino()}, {file_stat.size(), bucket.size()}});
+    }
+    bucket.push_back({{path}, file_stat.size(), {}});
+}
+
+bool
+vfs::file_task::hash_dup(vfs::file_task::dup_inode& inode, bool partial)
+{
+    inode.hash.clear();
+
+    const auto& path = inode.paths.front();
+    const i32 fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        this->append_add_log(
+            fmt::format("Cannot read {}: {}\n", path.string(), std::strerror(errno)),
+            vfs::task_log::level::error);
+        return false;
+    }
+
+    this->lock();
+    this->current_file = path;
+    this->unlock();
+
+    GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    bool ok = true;
+
+    const auto hash_range = [this, fd, checksum](off_t offset, u64 length)
+    {
+        std::vector<u8> buffer(std::min(length, u64(COPY_BUFFER_SIZE)));
+        while (length > 0 && !this->should_abort())
+        {
+            const auto rsize =
+                pread(fd, buffer.data(), std::min(length, u64(buffer.size())), offset);
+            if (rsize == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            if (rsize <= 0)
+            {
+                // an error, or the end of a file truncated while it was read
+                return rsize == 0;
+            }
+            g_checksum_update(checksum, buffer.data(), rsize);
+            offset += rsize;
+            length -= rsize;
+
+            this->lock();
+            this->progress += rsize;
+            this->unlock();
+        }
+        return !this->abort;
+    };
 
-    const auto file_stat = ztd::statx(src_file, ztd::statx::symlink::no_follow);
-    if (!file_stat)
+    if (!partial || inode.size <= 2 * DUP_BLOCK_SIZE)
     {
-        this->task_error(errno, "Accessing", src_file);
-        return;
+        if (!partial)
+        {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        }
+        ok = hash_range(0, inode.size);
     }
-
-    if (!have_rw_access(src_file))
+    else
     {
-        // this->task_error(errno, "Trashing", src_file);
-        ztd::logger::error("Trashing failed missing RW permissions '{}'", src_file.string());
-        return;
+        ok = hash_range(0, DUP_BLOCK_SIZE) &&
+             hash_range(static_cast<off_t>(inode.size - DUP_BLOCK_SIZE), DUP_BLOCK_SIZE);
     }
+    close(fd);
 
-    const bool result = vfs::trash_can::trash(src_file);
-
-    if (!result)
+    if (ok)
     {
-        this->task_error(errno, "Trashing", src_file);
-        return;
+        inode.hash = g_checksum_get_string(checksum);
     }
+    else if (!this->abort)
+    {
+        this->append_add_log(fmt::format("Cannot read {}\n", path.string()),
+                             vfs::task_log::level::error);
+    }
+    g_checksum_free(checksum);
+    return ok;
+}
 
-    this->lock();
-    this->progress += file_stat.size();
-    if (this->error_first)
+void
+vfs::file_task::hash_dups(const std::span<vfs::file_task::dup_inode* const> inodes, bool partial)
+{
+    std::atomic<usize> next{0};
+    const auto worker = [this, &next, inodes, partial]()
     {
-        this->error_first = false;
+        usize n;
+        while ((n = next.fetch_add(1)) < inodes.size() && !this->should_abort())
+        {
+            this->hash_dup(*inodes[n], partial);
+        }
+    };
+
+    const u32 count = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_HASH_WORKERS);
+    std::vector<std::jthread> pool;
+    for (u32 i = 1; i < std::min(count, u32(inodes.size())); ++i)
+    {
+        pool.emplace_back(worker);
     }
-    this->unlock();
+    worker();
+    // pool is joined here
 }
 
 void
-vfs::file_task::file_delete(const std::filesystem::path& src_file)
+vfs::file_task::report_dups()
 {
-    if (this->should_abort())
+    // the dev/ino index is only needed by the walk
+    this->dup_seen.clear();
+
+    // largest first, they free the most space
+    std::vector<u64> sizes;
+    for (const auto& [size, bucket] : this->dup_sizes)
     {
-        return;
+        if (bucket.size() > 1)
+        {
+            sizes.push_back(size);
+        }
     }
+    std::ranges::sort(sizes, std::ranges::greater());
 
+    // narrow each size down by the first and last block, files sharing a size
+    // by chance rarely share those. Small files are read whole here.
+    std::vector<vfs::file_task::dup_inode*> candidates;
+    u64 partial_size = 0;
+    for (const u64 size : sizes)
+    {
+        for (auto& inode : this->dup_sizes[size])
+        {
+            candidates.push_back(&inode);
+            partial_size += std::min(size, 2 * DUP_BLOCK_SIZE);
+        }
+    }
     this->lock();
-    this->current_file = src_file;
-    this->current_item++;
+    this->total_size += partial_size;
     this->unlock();
+    this->hash_dups(candidates, true);
 
-    const auto file_stat = ztd::statx(src_file, ztd::statx::symlink::no_follow);
-    if (!file_stat)
+    // runs of two or more inodes with the same hash
+    const auto split = [](const std::span<vfs::file_task::dup_inode* const> inodes)
     {
-        this->task_error(errno, "Accessing", src_file);
-        return;
-    }
+        std::vector<vfs::file_task::dup_inode*> sorted;
+        for (auto* inode : inodes)
+        {
+            if (!inode->hash.empty())
+            {
+                sorted.push_back(inode);
+            }
+        }
+        std::ranges::sort(sorted, {}, &vfs::file_task::dup_inode::hash);
 
-    if (file_stat.is_directory())
+        std::vector<std::vector<vfs::file_task::dup_inode*>> groups;
+        for (usize i = 0; i < sorted.size();)
+        {
+            usize j = i + 1;
+            while (j < sorted.size() && sorted[j]->hash == sorted[i]->hash)
+            {
+                j += 1;
+            }
+            if (j - i > 1)
+            {
+                groups.emplace_back(sorted.cbegin() + i, sorted.cbegin() + j);
+            }
+            i = j;
+        }
+        return groups;
+    };
+
+    std::optional<std::filesystem::path> report_path{std::nullopt};
+    std::ofstream report;
+    u64 found = 0;
+    u64 reclaimable = 0;
+
+    const auto emit = [&](const std::span<vfs::file_task::dup_inode* const> group)
     {
-        for (const auto& file : std::filesystem::directory_iterator(src_file))
+        const u64 size = group.front()->size;
+        std::string msg =
+            fmt::format("\n{} copies of {}:\n", group.size(), vfs_file_size_format(size));
+        for (const auto* inode : group)
         {
-            const auto filename = file.path().filename();
-            if (this->should_abort())
+            for (const auto i : std::views::iota(0uz, inode->paths.size()))
             {
-                break;
+                msg.append(fmt::format("{}{}\n",
+                                       inode->paths[i].string(),
+                                       i > 0 ? " (hard link)" : ""));
             }
-            const auto sub_src_file = src_file / filename;
-            this->file_delete(sub_src_file);
         }
 
-        if (this->should_abort())
+        // streamed to the log as found, the log may drop some on large trees
+        this->append_add_log(msg);
+
+        if (!report_path)
         {
-            return;
+            report_path = vfs::user_dirs->program_tmp_dir() /
+                          fmt::format("duplicates-{}.txt", ztd::randhex());
+            report.open(report_path.value());
         }
-        std::filesystem::remove_all(src_file);
-        if (std::filesystem::exists(src_file))
+        report << msg;
+
+        found += 1;
+        reclaimable += size * (group.size() - 1);
+    };
+
+    // full hashes, a few sizes at a time so the results stream in
+    std::vector<std::vector<vfs::file_task::dup_inode*>> pending;
+    std::vector<vfs::file_task::dup_inode*> batch;
+    const auto flush = [&]()
+    {
+        if (batch.empty())
         {
-            this->task_error(errno, "Removing", src_file);
             return;
         }
-    }
-    else
+        u64 batch_size = 0;
+        for (const auto* inode : batch)
+        {
+            batch_size += inode->size;
+        }
+        this->lock();
+        this->total_size += batch_size;
+        this->unlock();
+
+        this->hash_dups(batch, false);
+        for (const auto& group : pending)
+        {
+            for (const auto& dups : split(group))
+            {
+                emit(dups);
+            }
+        }
+        pending.clear();
+        batch.clear();
+    };
+
+    for (const u64 size : sizes)
     {
-        std::filesystem::remove(src_file);
-        if (std::filesystem::exists(src_file))
+        if (this->should_abort())
         {
-            this->task_error(errno, "Removing", src_file);
-            return;
+            break;
+        }
+
+        std::vector<vfs::file_task::dup_inode*> bucket;
+        for (auto& inode : this->dup_sizes[size])
+        {
+            bucket.push_back(&inode);
+        }
+
+        for (auto& group : split(bucket))
+        {
+            if (size <= 2 * DUP_BLOCK_SIZE)
+            {
+                // the partial hash covered the whole file
+                flush();
+                emit(group);
+                continue;
+            }
+            batch.insert(batch.cend(), group.cbegin(), group.cend());
+            pending.push_back(std::move(group));
+        }
+
+        if (batch.size() >= DUP_HASH_BATCH)
+        {
+            flush();
         }
     }
-    this->lock();
-    this->progress += file_stat.size();
-    if (this->error_first)
+    if (!this->should_abort())
     {
-        this->error_first = false;
+        flush();
     }
-    this->unlock();
+
+    this->dup_sizes.clear();
+
+    if (found == 0)
+    {
+        this->append_add_log("\nNo duplicate files found\n");
+        return;
+    }
+    this->append_add_log(fmt::format("\nDuplicate file sets found: {}\n"
+                                     "Space that can be freed: {}\n"
+                                     "The full list is saved to {}\n",
+                                     found,
+                                     vfs_file_size_format(reclaimable),
+                                     report_path.value().string()));
 }
 
 void
@@ -1247,80 +2232,12 @@ cb_exec_child_watch(pid_t pid, i32 status, const std::shared_ptr<vfs::file_task>
         call_state_callback(task, vfs::file_task::state::error);
     }
 
-    if (bad_status || (!task->exec_channel_out && !task->exec_channel_err))
+    if (bad_status || !task->exec_output || task->exec_output->is_finished())
     {
         call_state_callback(task, vfs::file_task::state::finish);
     }
 }
 
-static bool
-cb_exec_out_watch(GIOChannel* channel, GIOCondition cond,
-                  const std::shared_ptr<vfs::file_task>& task)
-{
-    if ((cond & G_IO_NVAL))
-    {
-        g_io_channel_unref(channel);
-        return false;
-    }
-    else if (!(cond & G_IO_IN))
-    {
-        if ((cond & G_IO_HUP))
-        {
-            g_io_channel_unref(channel);
-            if (channel == task->exec_channel_out)
-            {
-                task->exec_channel_out = nullptr;
-            }
-            else if (channel == task->exec_channel_err)
-            {
-                task->exec_channel_err = nullptr;
-            }
-            if (!task->exec_channel_out && !task->exec_channel_err && !task->exec_pid)
-            {
-                call_state_callback(task, vfs::file_task::state::finish);
-            }
-            return false;
-        }
-        else
-        {
-            return true;
-        }
-    }
-    else if (!(fcntl(g_io_channel_unix_get_fd(channel), F_GETFL) != -1 || errno != EBADF))
-    {
-        // bad file descriptor - occurs with stop on fast output
-        g_io_channel_unref(channel);
-        if (channel == task->exec_channel_out)
-        {
-            task->exec_channel_out = nullptr;
-        }
-        else if (channel == task->exec_channel_err)
-        {
-            task->exec_channel_err = nullptr;
-        }
-        if (!task->exec_channel_out && !task->exec_channel_err && !task->exec_pid)
-        {
-            call_state_callback(task, vfs::file_task::state::finish);
-        }
-        return false;
-    }
-
-    // GError *error = nullptr;
-    u64 size;
-    char buf[2048];
-    if (g_io_channel_read_chars(channel, buf, sizeof(buf), &size, nullptr) == G_IO_STATUS_NORMAL &&
-        size > 0)
-    {
-        task->append_add_log(buf);
-    }
-    else
-    {
-        ztd::logger::info("cb_exec_out_watch: g_io_channel_read_chars != G_IO_STATUS_NORMAL");
-    }
-
-    return true;
-}
-
 void
 vfs::file_task::file_exec(const std::filesystem::path& src_file)
 {
@@ -1625,31 +2542,25 @@ vfs::file_task::file_exec(const std::filesystem::path& src_file)
     // catch termination (always is run in the main loop thread)
     this->child_watch = g_child_watch_add(pid, (GChildWatchFunc)cb_exec_child_watch, this);
 
-    // create channels for output
-    fcntl(out, F_SETFL, O_NONBLOCK);
-    fcntl(err, F_SETFL, O_NONBLOCK);
-    this->exec_channel_out = g_io_channel_unix_new(out);
-    this->exec_channel_err = g_io_channel_unix_new(err);
-    g_io_channel_set_close_on_unref(this->exec_channel_out, true);
-    g_io_channel_set_close_on_unref(this->exec_channel_err, true);
-
-    // Add watches to channels
-    // These are run in the main loop thread so use G_PRIORITY_LOW to not
-    // interfere with g_idle_add in vfs-dir/vfs-async-task etc
-    // "Use this for very low priority background tasks. It is not used within
-    // GLib or GTK+."
-    g_io_add_watch_full(this->exec_channel_out,
-                        G_PRIORITY_LOW,
-                        GIOCondition(G_IO_IN | G_IO_HUP | G_IO_NVAL | G_IO_ERR), // want ERR?
-                        (GIOFunc)cb_exec_out_watch,
-                        this,
-                        nullptr);
-    g_io_add_watch_full(this->exec_channel_err,
-                        G_PRIORITY_LOW,
-                        GIOCondition(G_IO_IN | G_IO_HUP | G_IO_NVAL | G_IO_ERR), // want ERR?
-                        (GIOFunc)cb_exec_out_watch,
-                        this,
-                        nullptr);
+    // output is read on its own thread, the task log is drained by the GTK thread.
+    // The dialog keeps less than the log holds at once, more output than that
+    // is saved to a file.
+    this->exec_output = vfs::exec_output::create(
+        out,
+        err,
+        this->add_log.max_bytes(),
+        [this](const std::string_view output)
+        { return this->append_add_log(output, vfs::task_log::level::output); },
+        [this](const std::string_view notice)
+        { this->add_log.push_notice(vfs::task_log::level::info, notice); },
+        [this]()
+        {
+            if (!this->exec_pid)
+            {
+                call_state_callback(this->shared_from_this(), vfs::file_task::state::finish);
+            }
+        });
+    this->exec_output->start();
 
     // running
     this->state_ = vfs::file_task::state::running;
@@ -1668,6 +2579,48 @@ on_size_timeout(const std::shared_ptr<vfs::file_task>& task)
     return false;
 }
 
+static void
+add_src_path_size(const std::shared_ptr<vfs::file_task>& task,
+                  const std::filesystem::path& src_path, dev_t dest_dev)
+{
+    if (!task->is_recursive && (task->type_ == vfs::file_task::type::trash ||
+                                task->type_ == vfs::file_task::type::exec))
+    {
+        return;
+    }
+    if (task->type_ == vfs::file_task::type::sync ||
+        task->type_ == vfs::file_task::type::find_dups)
+    {
+        // only the changes are counted, when the trees are compared.
+        // find_dups counts the bytes it has to read once the sources are walked
+        return;
+    }
+
+    const auto file_stat = ztd::statx(src_path, ztd::statx::symlink::no_follow);
+    if (!file_stat)
+    {
+        // do not report error here since it is reported later
+        // task->error(errno, "Accessing", (char*)l->data);
+        return;
+    }
+
+    u64 size;
+    if (task->is_recursive ||
+        ((task->type_ == vfs::file_task::type::move) && file_stat.dev() != dest_dev))
+    {
+        // recursive size
+        size = task->get_total_size_of_dir(src_path);
+    }
+    else
+    {
+        size = file_stat.size();
+    }
+
+    task->lock();
+    task->total_size += size;
+    task->unlock();
+}
+
 static void*
 vfs_file_task_thread(const std::shared_ptr<vfs::file_task>& task)
 {
@@ -1690,6 +2643,9 @@ vfs_file_task_thread(const std::shared_ptr<vfs::file_task>& task)
     task->state_ = vfs::file_task::state::running;
     task->current_file = task->src_paths.at(0);
     task->total_size = 0;
+    // sources added after this point are sized when they are processed
+    const std::vector<std::filesystem::path> sized_src_paths = task->src_paths;
+    const bool all_src_paths_sized = task->src_paths_complete;
     task->unlock();
 
     if (task->abort)
@@ -1707,27 +2663,17 @@ vfs_file_task_thread(const std::shared_ptr<vfs::file_task>& task)
         return nullptr;
     }
 
+    dev_t dest_dev = 0;
+
     /* Calculate total size of all files */
     if (task->is_recursive)
     {
         // start timer to limit the amount of time to spend on this - can be
         // VERY slow for network filesystems
         size_timeout = g_timeout_add_seconds(5, (GSourceFunc)on_size_timeout, task.get());
-        for (const auto& src_path : task->src_paths)
+        for (const auto& src_path : sized_src_paths)
         {
-            const auto file_stat = ztd::statx(src_path, ztd::statx::symlink::no_follow);
-            if (!file_stat)
-            {
-                // do not report error here since its reported later
-                // this->task_error(errno, "Accessing"sv, (char*)l->data);
-            }
-            else
-            {
-                const u64 size = task->get_total_size_of_dir(src_path);
-                task->lock();
-                task->total_size += size;
-                task->unlock();
-            }
+            add_src_path_size(task, src_path, 0);
             if (task->abort)
             {
                 task->state_ = vfs::file_task::state::running;
@@ -1752,12 +2698,11 @@ vfs_file_task_thread(const std::shared_ptr<vfs::file_task>& task)
     }
     else if (task->type_ != vfs::file_task::type::exec)
     {
-        dev_t dest_dev = 0;
-
         // start timer to limit the amount of time to spend on this - can be
         // VERY slow for network filesystems
         size_timeout = g_timeout_add_seconds(5, (GSourceFunc)on_size_timeout, task.get());
-        if (task->type_ != vfs::file_task::type::chmod_chown)
+        if (task->type_ != vfs::file_task::type::chmod_chown &&
+            task->type_ != vfs::file_task::type::find_dups)
         {
             const auto file_stat =
                 ztd::statx(task->dest_dir.value(), ztd::statx::symlink::no_follow);
@@ -1779,31 +2724,9 @@ vfs_file_task_thread(const std::shared_ptr<vfs::file_task>& task)
             dest_dev = file_stat.dev();
         }
 
-        for (const auto& src_path : task->src_paths)
+        for (const auto& src_path : sized_src_paths)
         {
-            const auto file_stat = ztd::statx(src_path, ztd::statx::symlink::no_follow);
-            if (!file_stat)
-            {
-                // do not report error here since it is reported later
-                // task->error(errno, "Accessing", (char*)l->data);
-            }
-            else
-            {
-                if ((task->type_ == vfs::file_task::type::move) && file_stat.dev() != dest_dev)
-                {
-                    // recursive size
-                    const u64 size = task->get_total_size_of_dir(src_path);
-                    task->lock();
-                    task->total_size += size;
-                    task->unlock();
-                }
-                else
-                {
-                    task->lock();
-                    task->total_size += file_stat.size();
-                    task->unlock();
-                }
-            }
+            add_src_path_size(task, src_path, dest_dev);
             if (task->abort)
             {
                 task->state_ = vfs::file_task::state::running;
@@ -1857,6 +2780,8 @@ vfs_file_task_thread(const std::shared_ptr<vfs::file_task>& task)
                 case vfs::file_task::type::move:
                 case vfs::file_task::type::copy:
                 case vfs::file_task::type::trash:
+                case vfs::file_task::type::sync:
+                case vfs::file_task::type::find_dups:
                     exlimit = 10485760; // 10M
                     break;
                 case vfs::file_task::type::del:
@@ -1865,12 +2790,15 @@ vfs_file_task_thread(const std::shared_ptr<vfs::file_task>& task)
                 case vfs::file_task::type::link:
                 case vfs::file_task::type::chmod_chown:
                 case vfs::file_task::type::exec:
+                case vfs::file_task::type::rename:
                 case vfs::file_task::type::last:
                     exlimit = 0; // always exception for other types
                     break;
             }
 
-            if (!exlimit || task->total_size < exlimit)
+            // more sources are still being added, the size so far says
+            // nothing about the size of the whole task
+            if (!exlimit || (all_src_paths_sized && task->total_size < exlimit))
             {
                 task->state_pause_ = vfs::file_task::state::running;
             }
@@ -1879,7 +2807,8 @@ vfs_file_task_thread(const std::shared_ptr<vfs::file_task>& task)
         task->queue_start = true;
     }
 
-    if (task->state_ == vfs::file_task::state::size_timeout)
+    const bool size_timed_out = task->state_ == vfs::file_task::state::size_timeout;
+    if (size_timed_out)
     {
         task->append_add_log("Timed out calculating total size\n");
         task->total_size = 0;
@@ -1899,8 +2828,24 @@ vfs_file_task_thread(const std::shared_ptr<vfs::file_task>& task)
         return nullptr;
     }
 
-    for (const auto& src_path : task->src_paths)
+    // steps of a bulk rename that are done, undone if the plan is not finished
+    usize renamed = 0;
+    bool rename_failed = false;
+    for (usize i = 0;; ++i)
     {
+        const auto next_src_path = task->next_src_path(i);
+        if (!next_src_path)
+        {
+            break;
+        }
+        const auto& src_path = next_src_path.value();
+
+        if (i >= sized_src_paths.size() && !size_timed_out)
+        {
+            // streamed source, was not included in the initial size calculation
+            add_src_path_size(task, src_path, dest_dev);
+        }
+
         switch (task->type_)
         {
             case vfs::file_task::type::move:
@@ -1924,9 +2869,63 @@ vfs_file_task_thread(const std::shared_ptr<vfs::file_task>& task)
             case vfs::file_task::type::exec:
                 task->file_exec(src_path);
                 break;
+            case vfs::file_task::type::rename:
+                if (task->file_rename(src_path, task->rename_dest_paths.at(i)))
+                {
+                    renamed += 1;
+                }
+                else
+                {
+                    rename_failed = true;
+                }
+                break;
+            case vfs::file_task::type::sync:
+                task->file_sync(src_path);
+                break;
+            case vfs::file_task::type::find_dups:
+                task->file_find_dups(src_path);
+                break;
             case vfs::file_task::type::last:
                 break;
         }
+
+        switch (task->type_)
+        {
+            case vfs::file_task::type::move:
+            case vfs::file_task::type::trash:
+            case vfs::file_task::type::del:
+            case vfs::file_task::type::rename:
+                // the source name can be free again, also when the dir is not open
+                vfs::unique_name::release(src_path);
+                break;
+            case vfs::file_task::type::copy:
+            case vfs::file_task::type::link:
+            case vfs::file_task::type::chmod_chown:
+            case vfs::file_task::type::exec:
+            case vfs::file_task::type::sync:
+            case vfs::file_task::type::find_dups:
+            case vfs::file_task::type::last:
+                break;
+        }
+
+        if (rename_failed)
+        {
+            break;
+        }
+    }
+
+    if (task->type_ == vfs::file_task::type::rename)
+    {
+        // also when aborted between two steps, next_src_path() ends the loop then
+        if (renamed < task->rename_dest_paths.size())
+        {
+            task->undo_renames(renamed);
+        }
+    }
+
+    if (task->type_ == vfs::file_task::type::find_dups && !task->should_abort())
+    {
+        task->report_dups();
     }
 
     task->state_ = vfs::file_task::state::running;
@@ -1979,6 +2978,9 @@ void
 vfs::file_task::try_abort_task()
 {
     this->abort = true;
+    this->lock();
+    g_cond_broadcast(this->src_paths_cond);
+    this->unlock();
     if (this->pause_cond)
     {
         this->lock();
@@ -2003,6 +3005,9 @@ void
 vfs::file_task::abort_task()
 {
     this->abort = true;
+    this->lock();
+    g_cond_broadcast(this->src_paths_cond);
+    this->unlock();
     /* Called from another thread */
     if (this->thread && g_thread_self() != this->thread &&
         this->type_ != vfs::file_task::type::exec)
@@ -2076,12 +3081,12 @@ vfs::file_task::task_error(i32 errnox, const std::string_view action)
     {
         const std::string errno_msg = std::strerror(errnox);
         const std::string msg = fmt::format("{}\n{}\n", action, errno_msg);
-        this->append_add_log(msg);
+        this->append_add_log(msg, vfs::task_log::level::error);
     }
     else
     {
         const std::string msg = fmt::format("{}\n", action);
-        this->append_add_log(msg);
+        this->append_add_log(msg, vfs::task_log::level::error);
     }
 
     call_state_callback(this->shared_from_this(), vfs::file_task::state::error);
@@ -2094,6 +3099,6 @@ vfs::file_task::task_error(i32 errnox, const std::string_view action,
     this->error = errnox;
     const std::string errno_msg = std::strerror(errnox);
     const std::string msg = fmt::format("\n{} {}\nError: {}\n", action, target.string(), errno_msg);
-    this->append_add_log(msg);
+    this->append_add_log(msg, vfs::task_log::level::error);
     call_state_callback(this->shared_from_this(), vfs::file_task::state::error);
 }
@@ -22,8 +22,11 @@
 
 #include <filesystem>
 
+#include <span>
 #include <array>
 #include <vector>
+#include <map>
+#include <unordered_map>
 
 #include <optional>
 
@@ -39,6 +42,9 @@
 
 #include "xset/xset.hxx"
 
+#include "vfs/vfs-task-log.hxx"
+#include "vfs/vfs-exec-output.hxx"
+
 namespace vfs
 {
     struct file_task : public std::enable_shared_from_this<file_task>
@@ -53,6 +59,9 @@ namespace vfs
             chmod_chown, // These two kinds of operation have lots in common,
                          // so put them together to reduce duplicated disk I/O
             exec,
+            rename,
+            sync,
+            find_dups,
             last,
         };
 
@@ -77,6 +86,14 @@ namespace vfs
             rename,        // Rename file
         };
 
+        enum class sync_mode
+        {
+            one_way,        // update dest from src, keep files only found in dest
+            one_way_delete, // mirror src, also delete files only found in dest
+            two_way,        // newer side wins, files missing on either side are copied,
+                            // a file and a dir of the same name are reported, not replaced
+        };
+
         enum chmod_action
         {
             owner_r,
@@ -115,8 +132,15 @@ namespace vfs
         void set_chown(uid_t new_uid, gid_t new_gid);
 
         void set_recursive(bool recursive);
+        // compare_content checks same sized files by their data instead of the mtime
+        void set_sync(const vfs::file_task::sync_mode mode, bool compare_content);
         void set_overwrite_mode(const vfs::file_task::overwrite_mode mode);
 
+        // Source files can be appended while the task is running, the task thread
+        // will wait for more sources until the source list is marked complete.
+        void add_src_paths(const std::span<const std::filesystem::path> src_files);
+        void set_src_paths_complete(bool complete);
+
         void run_task();
         void try_abort_task();
         void abort_task();
@@ -129,6 +153,11 @@ namespace vfs
         void file_copy(const std::filesystem::path& src_file);
         bool do_file_copy(const std::filesystem::path& src_file,
                           const std::filesystem::path& dest_file);
+        bool copy_file_data(i32 rfd, i32 wfd, const ztd::statx& file_stat,
+                            const std::filesystem::path& src_file,
+                            const std::filesystem::path& dest_file);
+        bool copy_hardlink(const ztd::statx& file_stat, const std::filesystem::path& dest_file,
+                           bool replace);
 
         void file_move(const std::filesystem::path& src_file);
         i32 do_file_move(const std::filesystem::path& src_file,
@@ -139,12 +168,56 @@ namespace vfs
         void file_link(const std::filesystem::path& src_file);
         void file_chown_chmod(const std::filesystem::path& src_file);
         void file_exec(const std::filesystem::path& src_file);
+        // false when the step failed or the task was aborted
+        bool file_rename(const std::filesystem::path& src_file,
+                         const std::filesystem::path& dest_file);
+        // move the first count renames back, last one first
+        void undo_renames(usize count);
+
+        struct sync_action
+        {
+            enum class kind
+            {
+                copy,    // src to dest, dest does not exist or is an older version
+                replace,  // remove dest first, it is not the same file type as src
+                remove,   // dest is not in src
+                conflict, // two-way, src and dest differ in type, neither side is changed
+            };
+
+            vfs::file_task::sync_action::kind op{vfs::file_task::sync_action::kind::copy};
+            std::filesystem::path src{};
+            std::filesystem::path dest{};
+        };
+        void file_sync(const std::filesystem::path& src_file);
+        void plan_sync(const std::filesystem::path& src_file,
+                       const std::filesystem::path& dest_file,
+                       std::vector<vfs::file_task::sync_action>& actions);
+        bool is_synced(const std::filesystem::path& src_file, const ztd::statx& src_stat,
+                       const std::filesystem::path& dest_file, const ztd::statx& dest_stat);
+
+        // One regular file inode. Its other hard links are kept with it, so they
+        // are neither hashed again nor reported as copies taking up space.
+        struct dup_inode
+        {
+            std::vector<std::filesystem::path> paths{};
+            u64 size{0};
+            std::string hash{};
+        };
+        void file_find_dups(const std::filesystem::path& src_file);
+        void walk_dups(const std::filesystem::path& path, const ztd::statx& file_stat);
+        void report_dups();
+        void hash_dups(const std::span<vfs::file_task::dup_inode* const> inodes, bool partial);
+        bool hash_dup(vfs::file_task::dup_inode& inode, bool partial);
 
         bool should_abort();
 
+        const std::optional<std::filesystem::path> next_src_path(usize index);
+
         u64 get_total_size_of_dir(const std::filesystem::path& path);
 
-        void append_add_log(const std::string_view msg);
+        // returns false if the log is full and msg was dropped
+        bool append_add_log(const std::string_view msg,
+                            const vfs::task_log::level level = vfs::task_log::level::info);
 
         void task_error(i32 errnox, const std::string_view action);
         void task_error(i32 errnox, const std::string_view action,
@@ -155,6 +228,8 @@ namespace vfs
         std::vector<std::filesystem::path> src_paths{}; // All source files. This list will be freed
                                                         // after file operation is completed.
         std::optional<std::filesystem::path> dest_dir{}; // Destinaton directory
+        bool src_paths_complete{true}; // false while more source files can be added
+        GCond* src_paths_cond{nullptr};
         bool avoid_changes{false};
 
         vfs::file_task::overwrite_mode overwrite_mode_;
@@ -195,6 +270,7 @@ namespace vfs
         vfs::file_task::state state_pause_{vfs::file_task::state::running};
         bool abort{false};
         GCond* pause_cond{nullptr};
+        u32 pause_waiters{0};
         bool queue_start{false};
 
         state_callback_t state_cb{nullptr};
@@ -202,9 +278,29 @@ namespace vfs
 
         GMutex* mutex{nullptr};
 
-        // sfm write directly to gtk buffer for speed
-        GtkTextBuffer* add_log_buf{nullptr};
-        GtkTextMark* add_log_end{nullptr};
+        // written by the task thread, moved to the progress dialog by the GTK thread
+        vfs::task_log add_log{1024, 256 * 1024};
+
+        // For rename, new path of each file in src_paths, by index
+        std::vector<std::filesystem::path> rename_dest_paths{};
+
+        // For copy and move to another device, the first copy of each source inode
+        // with more than one link. Its other links are recreated as hard links to it.
+        struct copied_inode
+        {
+            std::filesystem::path dest{};
+            u64 links_left{0}; // erased at zero, so a reused inode is never matched
+        };
+        std::map<std::pair<dev_t, ino_t>, copied_inode> copied_inodes{};
+
+        // For sync
+        vfs::file_task::sync_mode sync_mode_{vfs::file_task::sync_mode::one_way};
+        bool sync_content{false};
+
+        // For find_dups, every inode found by the walk of the sources, by size
+        std::unordered_map<u64, std::vector<vfs::file_task::dup_inode>> dup_sizes{};
+        // size and index in dup_sizes of each inode, to find its hard links
+        std::map<std::pair<dev_t, ino_t>, std::pair<u64, usize>> dup_seen{};
 
         // MOD run task
         std::string exec_action{};
@@ -229,8 +325,7 @@ namespace vfs
         i32 exec_exit_status{0};
         u32 child_watch{0};
         bool exec_is_error{false};
-        GIOChannel* exec_channel_out{nullptr};
-        GIOChannel* exec_channel_err{nullptr};
+        std::shared_ptr<vfs::exec_output> exec_output{nullptr};
         bool exec_scroll_lock{false};
         xset_t exec_set{nullptr};
         GCond* exec_cond{nullptr};
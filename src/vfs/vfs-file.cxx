@@ -23,6 +23,17 @@
 #include <filesystem>
 
 #include <memory>
+#include <memory_resource>
+
+#include <unordered_map>
+
+#include <algorithm>
+
+#include <array>
+
+#include <cstdint>
+
+#include <mutex>
 
 #include <glibmm.h>
 
@@ -33,6 +44,7 @@
 
 #include "vfs/vfs-app-desktop.hxx"
 #include "vfs/vfs-mime-type.hxx"
+#include "vfs/vfs-thumbnail-store.hxx"
 #include "vfs/vfs-thumbnailer.hxx"
 #include "vfs/vfs-time.hxx"
 #include "vfs/vfs-utils.hxx"
@@ -40,16 +52,158 @@
 
 #include "vfs/vfs-file.hxx"
 
+namespace
+{
+    // allocator that keeps its arena alive, it is copied into the
+    // shared_ptr control block so the arena outlives its vfs::dir
+    template<typename T> struct arena_allocator
+    {
+        using value_type = T;
+
+        std::shared_ptr<std::pmr::memory_resource> arena;
+
+        arena_allocator(const std::shared_ptr<std::pmr::memory_resource>& arena) noexcept
+            : arena(arena)
+        {
+        }
+
+        template<typename U>
+        arena_allocator(const arena_allocator<U>& other) noexcept : arena(other.arena)
+        {
+        }
+
+        T*
+        allocate(usize n)
+        {
+            return static_cast<T*>(this->arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void
+        deallocate(T* p, usize n) noexcept
+        {
+            this->arena->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        template<typename U>
+        bool
+        operator==(const arena_allocator<U>& other) const noexcept
+        {
+            return this->arena == other.arena;
+        }
+    };
+
+    // parent paths, shared by every vfs::file in the same dir
+    std::mutex parent_lock;
+    std::unordered_map<std::string, std::weak_ptr<const std::filesystem::path>> parent_map;
+
+    const std::shared_ptr<const std::filesystem::path>
+    intern_parent(const std::filesystem::path& path) noexcept
+    {
+        const std::scoped_lock<std::mutex> lock(parent_lock);
+
+        auto& weak = parent_map[path.native()];
+        auto parent = weak.lock();
+        if (!parent)
+        {
+            parent = std::make_shared<const std::filesystem::path>(path);
+            weak = parent;
+
+            // drop expired entries once in a while instead of on every release
+            static usize sweep_size = 1024;
+            if (parent_map.size() >= sweep_size)
+            {
+                std::erase_if(parent_map, [](const auto& item) { return item.second.expired(); });
+                sweep_size = std::max(usize(1024), parent_map.size() * 2);
+            }
+        }
+        return parent;
+    }
+
+    // there are only a few owners and groups, keep one copy of each name
+    std::mutex owner_lock;
+    std::unordered_map<u32, std::string> owner_map;
+    std::unordered_map<u32, std::string> group_map;
+
+    const std::string_view
+    intern_owner(u32 uid) noexcept
+    {
+        const std::scoped_lock<std::mutex> lock(owner_lock);
+
+        const auto it = owner_map.find(uid);
+        if (it != owner_map.cend())
+        {
+            return it->second;
+        }
+        const auto pw = ztd::passwd(uid);
+        return owner_map.insert({uid, std::string(pw.name())}).first->second;
+    }
+
+    const std::string_view
+    intern_group(u32 gid) noexcept
+    {
+        const std::scoped_lock<std::mutex> lock(owner_lock);
+
+        const auto it = group_map.find(gid);
+        if (it != group_map.cend())
+        {
+            return it->second;
+        }
+        const auto gr = ztd::group(gid);
+        return group_map.insert({gid, std::string(gr.name())}).first->second;
+    }
+
+    // the lazily formatted strings are also read by the thumbnailer and preview
+    // threads, a small pool of locks keeps a mutex out of every vfs::file
+    std::array<std::mutex, 32> format_locks;
+
+    std::mutex&
+    format_lock(const vfs::file* file) noexcept
+    {
+        const auto key = reinterpret_cast<std::uintptr_t>(file) / alignof(vfs::file);
+        return format_locks[key % format_locks.size()];
+    }
+
+    const std::string_view
+    format_once(const vfs::file* file, std::string& cache, const auto& format) noexcept
+    {
+        const std::scoped_lock<std::mutex> lock(format_lock(file));
+        if (cache.empty())
+        {
+            cache = format();
+        }
+        return cache;
+    }
+} // namespace
+
 const std::shared_ptr<vfs::file>
 vfs::file::create(const std::filesystem::path& path) noexcept
 {
     return std::make_shared<vfs::file>(path);
 }
 
-vfs::file::file(const std::filesystem::path& path) : path_(path)
+const std::shared_ptr<vfs::file>
+vfs::file::create(const std::filesystem::path& path,
+                  const std::shared_ptr<std::pmr::memory_resource>& arena) noexcept
+{
+    return std::allocate_shared<vfs::file>(arena_allocator<vfs::file>(arena), path);
+}
+
+vfs::file::file(const std::filesystem::path& path)
 {
     // ztd::logger::debug("vfs::file::file({})    {}", fmt::ptr(this), this->path);
-    this->uri_ = Glib::filename_to_uri(this->path_.string());
+    if (path.has_relative_path() && path.has_filename())
+    {
+        this->parent_ = intern_parent(path.parent_path());
+        this->name_ = path.filename();
+    }
+    else
+    {
+        // special case, using std::filesystem::path::filename() on the root
+        // directory returns an empty string. that causes subtle bugs
+        // so hard code "/" as the value for root.
+        // paths with a trailing '/' are also kept whole.
+        this->name_ = path.empty() || path == "/" ? "/" : path.string();
+    }
     this->update();
 }
 
@@ -58,10 +212,12 @@ vfs::file::~file()
     // ztd::logger::debug("vfs::file::~file({})   {}", fmt::ptr(this), this->path);
     if (this->big_thumbnail_)
     {
+        vfs::thumbnail_store::remove(this, true);
         g_object_unref(this->big_thumbnail_);
     }
     if (this->small_thumbnail_)
     {
+        vfs::thumbnail_store::remove(this, false);
         g_object_unref(this->small_thumbnail_);
     }
 }
@@ -69,21 +225,31 @@ vfs::file::~file()
 bool
 vfs::file::update() noexcept
 {
-    if (std::filesystem::equivalent(this->path_, "/"))
-    {
-        // special case, using std::filesystem::path::filename() on the root
-        // directory returns an empty string. that causes subtle bugs
-        // so hard code "/" as the value for root.
-        this->name_ = "/";
-        this->display_name_ = "/";
-    }
-    else
+    const auto path = this->path();
+
+    this->display_name_.clear();
+
+    auto file_stat = ztd::statx(path, ztd::statx::symlink::no_follow);
+    // this->status = std::filesystem::status(file_path);
+    const auto status = file_stat ? std::filesystem::symlink_status(path) : this->status_;
+
     {
-        this->name_ = this->path_.filename();
-        this->display_name_ = this->path_.filename();
+        // swap in the new stat and drop the strings formatted from the old
+        // one together, so another thread never caches a stale string
+        const std::scoped_lock<std::mutex> lock(format_lock(this));
+        this->file_stat_ = std::move(file_stat);
+        this->status_ = status;
+        this->uri_.clear();
+        this->display_size_.clear();
+        this->display_size_bytes_.clear();
+        this->display_disk_size_.clear();
+        this->display_atime_.clear();
+        this->display_btime_.clear();
+        this->display_ctime_.clear();
+        this->display_mtime_.clear();
+        this->display_perm_.clear();
     }
 
-    this->file_stat_ = ztd::statx(this->path_, ztd::statx::symlink::no_follow);
     if (!this->file_stat_)
     {
         this->mime_type_ = vfs_mime_type_get_from_type(XDG_MIME_TYPE_UNKNOWN);
@@ -92,34 +258,16 @@ vfs::file::update() noexcept
 
     // ztd::logger::debug("vfs::file::update({})    {}  size={}", fmt::ptr(this), this->name, this->file_stat.size());
 
-    // this->status = std::filesystem::status(file_path);
-    this->status_ = std::filesystem::symlink_status(this->path_);
-
-    this->mime_type_ = vfs_mime_type_get_from_file(this->path_);
-
-    // file size formated
-    this->display_size_ = vfs_file_size_format(this->size());
-    this->display_size_bytes_ = fmt::format("{:L}", this->size());
-
-    // disk file size formated
-    this->display_disk_size_ = vfs_file_size_format(this->size_on_disk());
+    this->mime_type_ = vfs_mime_type_get_from_file(path);
 
     // hidden
     this->is_hidden_ = this->name_.starts_with('.');
 
     // owner
-    const auto pw = ztd::passwd(this->file_stat_.uid());
-    this->display_owner_ = pw.name();
+    this->display_owner_ = intern_owner(this->file_stat_.uid());
 
     // group
-    const auto gr = ztd::group(this->file_stat_.gid());
-    this->display_group_ = gr.name();
-
-    // time
-    this->display_atime_ = vfs_create_display_date(this->atime());
-    this->display_btime_ = vfs_create_display_date(this->btime());
-    this->display_ctime_ = vfs_create_display_date(this->ctime());
-    this->display_mtime_ = vfs_create_display_date(this->mtime());
+    this->display_group_ = intern_group(this->file_stat_.gid());
 
     this->load_special_info();
 
@@ -132,10 +280,20 @@ vfs::file::name() const noexcept
     return this->name_;
 }
 
+const std::string_view
+vfs::file::name_folded() const noexcept
+{
+    return format_once(this, this->name_folded_, [this] { return ztd::lower(this->name_); });
+}
+
 // Get displayed name encoded in UTF-8
 const std::string_view
 vfs::file::display_name() const noexcept
 {
+    if (this->display_name_.empty())
+    {
+        return this->name_;
+    }
     return this->display_name_;
 }
 
@@ -145,16 +303,22 @@ vfs::file::update_display_name(const std::string_view new_display_name) noexcept
     this->display_name_ = new_display_name;
 }
 
-const std::filesystem::path&
+const std::filesystem::path
 vfs::file::path() const noexcept
 {
-    return this->path_;
+    if (!this->parent_)
+    {
+        return this->name_;
+    }
+    return *this->parent_ / this->name_;
 }
 
 const std::string_view
 vfs::file::uri() const noexcept
 {
-    return this->uri_;
+    return format_once(this,
+                       this->uri_,
+                       [this] { return Glib::filename_to_uri(this->path().string()); });
 }
 
 u64
@@ -172,19 +336,25 @@ vfs::file::size_on_disk() const noexcept
 const std::string_view
 vfs::file::display_size() const noexcept
 {
-    return this->display_size_;
+    return format_once(this,
+                       this->display_size_,
+                       [this] { return vfs_file_size_format(this->size()); });
 }
 
 const std::string_view
 vfs::file::display_size_in_bytes() const noexcept
 {
-    return this->display_size_bytes_;
+    return format_once(this,
+                       this->display_size_bytes_,
+                       [this] { return fmt::format("{:L}", this->size()); });
 }
 
 const std::string_view
 vfs::file::display_size_on_disk() const noexcept
 {
-    return this->display_disk_size_;
+    return format_once(this,
+                       this->display_disk_size_,
+                       [this] { return vfs_file_size_format(this->size_on_disk()); });
 }
 
 u64
@@ -202,7 +372,7 @@ vfs::file::mime_type() const noexcept
 void
 vfs::file::reload_mime_type() noexcept
 {
-    this->mime_type_ = vfs_mime_type_get_from_file(this->path_);
+    this->mime_type_ = vfs_mime_type_get_from_file(this->path());
     this->load_special_info();
 }
 
@@ -210,40 +380,41 @@ const std::string_view
 vfs::file::special_directory_get_icon_name() const noexcept
 {
     const bool symbolic = this->is_symlink();
+    const auto path = this->path();
 
-    if (vfs::user_dirs->home_dir() == this->path_)
+    if (vfs::user_dirs->home_dir() == path)
     {
         return (symbolic) ? ICON_FOLDER_HOME : ICON_FULLCOLOR_FOLDER_HOME;
     }
-    else if (vfs::user_dirs->desktop_dir() == this->path_)
+    else if (vfs::user_dirs->desktop_dir() == path)
     {
         return (symbolic) ? ICON_FOLDER_DESKTOP : ICON_FULLCOLOR_FOLDER_DESKTOP;
     }
-    else if (vfs::user_dirs->documents_dir() == this->path_)
+    else if (vfs::user_dirs->documents_dir() == path)
     {
         return (symbolic) ? ICON_FOLDER_DOCUMENTS : ICON_FULLCOLOR_FOLDER_DOCUMENTS;
     }
-    else if (vfs::user_dirs->download_dir() == this->path_)
+    else if (vfs::user_dirs->download_dir() == path)
     {
         return (symbolic) ? ICON_FOLDER_DOWNLOAD : ICON_FULLCOLOR_FOLDER_DOWNLOAD;
     }
-    else if (vfs::user_dirs->music_dir() == this->path_)
+    else if (vfs::user_dirs->music_dir() == path)
     {
         return (symbolic) ? ICON_FOLDER_MUSIC : ICON_FULLCOLOR_FOLDER_MUSIC;
     }
-    else if (vfs::user_dirs->pictures_dir() == this->path_)
+    else if (vfs::user_dirs->pictures_dir() == path)
     {
         return (symbolic) ? ICON_FOLDER_PICTURES : ICON_FULLCOLOR_FOLDER_PICTURES;
     }
-    else if (vfs::user_dirs->public_share_dir() == this->path_)
+    else if (vfs::user_dirs->public_share_dir() == path)
     {
         return (symbolic) ? ICON_FOLDER_PUBLIC_SHARE : ICON_FULLCOLOR_FOLDER_PUBLIC_SHARE;
     }
-    else if (vfs::user_dirs->template_dir() == this->path_)
+    else if (vfs::user_dirs->template_dir() == path)
     {
         return (symbolic) ? ICON_FOLDER_TEMPLATES : ICON_FULLCOLOR_FOLDER_TEMPLATES;
     }
-    else if (vfs::user_dirs->videos_dir() == this->path_)
+    else if (vfs::user_dirs->videos_dir() == path)
     {
         return (symbolic) ? ICON_FOLDER_VIDEOS : ICON_FULLCOLOR_FOLDER_VIDEOS;
     }
@@ -298,13 +469,23 @@ vfs::file::small_icon() noexcept
 GdkPixbuf*
 vfs::file::big_thumbnail() const noexcept
 {
-    return this->big_thumbnail_ ? g_object_ref(this->big_thumbnail_) : nullptr;
+    if (!this->big_thumbnail_)
+    {
+        return nullptr;
+    }
+    vfs::thumbnail_store::touch(this, true);
+    return g_object_ref(this->big_thumbnail_);
 }
 
 GdkPixbuf*
 vfs::file::small_thumbnail() const noexcept
 {
-    return this->small_thumbnail_ ? g_object_ref(this->small_thumbnail_) : nullptr;
+    if (!this->small_thumbnail_)
+    {
+        return nullptr;
+    }
+    vfs::thumbnail_store::touch(this, false);
+    return g_object_ref(this->small_thumbnail_);
 }
 
 void
@@ -312,6 +493,7 @@ vfs::file::unload_big_thumbnail() noexcept
 {
     if (this->big_thumbnail_)
     {
+        vfs::thumbnail_store::remove(this, true);
         g_object_unref(this->big_thumbnail_);
         this->big_thumbnail_ = nullptr;
     }
@@ -322,11 +504,63 @@ vfs::file::unload_small_thumbnail() noexcept
 {
     if (this->small_thumbnail_)
     {
+        vfs::thumbnail_store::remove(this, false);
         g_object_unref(this->small_thumbnail_);
         this->small_thumbnail_ = nullptr;
     }
 }
 
+void
+vfs::file::evict_thumbnail(bool big) noexcept
+{
+    if (big)
+    {
+        this->unload_big_thumbnail();
+        this->big_thumbnail_evicted_ = true;
+    }
+    else
+    {
+        this->unload_small_thumbnail();
+        this->small_thumbnail_evicted_ = true;
+    }
+}
+
+bool
+vfs::file::is_thumbnail_evicted(bool big) const noexcept
+{
+    if (big)
+    {
+        return this->big_thumbnail_evicted_;
+    }
+    return this->small_thumbnail_evicted_;
+}
+
+usize
+vfs::file::memory_usage() const noexcept
+{
+    usize size = sizeof(vfs::file);
+    for (const std::string_view str : {std::string_view(this->name_),
+                                       std::string_view(this->display_name_),
+                                       std::string_view(this->name_folded_),
+                                       std::string_view(this->uri_),
+                                       std::string_view(this->display_size_),
+                                       std::string_view(this->display_size_bytes_),
+                                       std::string_view(this->display_disk_size_),
+                                       std::string_view(this->display_atime_),
+                                       std::string_view(this->display_btime_),
+                                       std::string_view(this->display_ctime_),
+                                       std::string_view(this->display_mtime_),
+                                       std::string_view(this->display_perm_)})
+    {
+        // short strings are stored inline
+        if (str.size() >= sizeof(std::string))
+        {
+            size += str.size() + 1;
+        }
+    }
+    return size;
+}
+
 const std::string_view
 vfs::file::display_owner() const noexcept
 {
@@ -342,25 +576,33 @@ vfs::file::display_group() const noexcept
 const std::string_view
 vfs::file::display_atime() const noexcept
 {
-    return this->display_atime_;
+    return format_once(this,
+                       this->display_atime_,
+                       [this] { return vfs_create_display_date(this->atime()); });
 }
 
 const std::string_view
 vfs::file::display_btime() const noexcept
 {
-    return this->display_btime_;
+    return format_once(this,
+                       this->display_btime_,
+                       [this] { return vfs_create_display_date(this->btime()); });
 }
 
 const std::string_view
 vfs::file::display_ctime() const noexcept
 {
-    return this->display_ctime_;
+    return format_once(this,
+                       this->display_ctime_,
+                       [this] { return vfs_create_display_date(this->ctime()); });
 }
 
 const std::string_view
 vfs::file::display_mtime() const noexcept
 {
-    return this->display_mtime_;
+    return format_once(this,
+                       this->display_mtime_,
+                       [this] { return vfs_create_display_date(this->mtime()); });
 }
 
 std::time_t
@@ -535,11 +777,9 @@ get_file_perm_string(std::filesystem::file_status status)
 const std::string_view
 vfs::file::display_permissions() noexcept
 {
-    if (this->display_perm_.empty())
-    {
-        this->display_perm_ = get_file_perm_string(this->status_);
-    }
-    return this->display_perm_;
+    return format_once(this,
+                       this->display_perm_,
+                       [this] { return get_file_perm_string(this->status_); });
 }
 
 bool
@@ -550,7 +790,7 @@ vfs::file::is_directory() const noexcept
     if (std::filesystem::is_symlink(this->status_))
     {
         std::error_code ec;
-        const auto symlink_path = std::filesystem::read_symlink(this->path_, ec);
+        const auto symlink_path = std::filesystem::read_symlink(this->path(), ec);
         if (!ec)
         {
             return std::filesystem::is_directory(symlink_path);
@@ -730,9 +970,10 @@ vfs::file::load_thumbnail_small() noexcept
     {
         return;
     }
+    this->small_thumbnail_evicted_ = false;
 
     std::error_code ec;
-    const bool exists = std::filesystem::exists(this->path_, ec);
+    const bool exists = std::filesystem::exists(this->path(), ec);
     if (ec || !exists)
     {
         return;
@@ -745,6 +986,9 @@ vfs::file::load_thumbnail_small() noexcept
         if (thumbnail)
         {
             this->small_thumbnail_ = thumbnail;
+            vfs::thumbnail_store::add(this->shared_from_this(),
+                                      false,
+                                      gdk_pixbuf_get_byte_length(thumbnail));
             return;
         }
     }
@@ -761,9 +1005,10 @@ vfs::file::load_thumbnail_big() noexcept
     {
         return;
     }
+    this->big_thumbnail_evicted_ = false;
 
     std::error_code ec;
-    const bool exists = std::filesystem::exists(this->path_, ec);
+    const bool exists = std::filesystem::exists(this->path(), ec);
     if (ec || !exists)
     {
         return;
@@ -776,6 +1021,9 @@ vfs::file::load_thumbnail_big() noexcept
         if (thumbnail)
         {
             this->big_thumbnail_ = thumbnail;
+            vfs::thumbnail_store::add(this->shared_from_this(),
+                                      true,
+                                      gdk_pixbuf_get_byte_length(thumbnail));
             return;
         }
     }
@@ -794,10 +1042,10 @@ vfs::file::load_special_info() noexcept
     }
 
     this->is_special_desktop_entry_ = true;
-    const auto desktop = vfs::desktop::create(this->path_);
+    const auto desktop = vfs::desktop::create(this->path());
 
     // MOD  display real filenames of .desktop files not in desktop directory
-    // if (std::filesystem::equivalent(this->path_.parent_path(), vfs::user_dirs->desktop_dir()))
+    // if (std::filesystem::equivalent(this->path().parent_path(), vfs::user_dirs->desktop_dir()))
     // {
     //     this->update_display_name(desktop->display_name());
     // }
@@ -23,6 +23,9 @@
 #include <filesystem>
 
 #include <memory>
+#include <memory_resource>
+
+#include <atomic>
 
 #include <gtkmm.h>
 
@@ -42,13 +45,19 @@ namespace vfs
         ~file();
 
         static const std::shared_ptr<vfs::file> create(const std::filesystem::path& path) noexcept;
+        // allocate the record and its control block from a per dir arena
+        static const std::shared_ptr<vfs::file>
+        create(const std::filesystem::path& path,
+               const std::shared_ptr<std::pmr::memory_resource>& arena) noexcept;
 
         const std::string_view name() const noexcept;
+        // lowercase name for case insensitive matching, made on first use
+        const std::string_view name_folded() const noexcept;
         const std::string_view display_name() const noexcept;
 
         void update_display_name(const std::string_view new_display_name) noexcept;
 
-        const std::filesystem::path& path() const noexcept;
+        const std::filesystem::path path() const noexcept;
         const std::string_view uri() const noexcept;
 
         u64 size() const noexcept;
@@ -90,6 +99,14 @@ namespace vfs
         void unload_big_thumbnail() noexcept;
         void unload_small_thumbnail() noexcept;
 
+        // unloaded by vfs::thumbnail_store, cleared once it is loaded again
+        void evict_thumbnail(bool big) noexcept;
+        bool is_thumbnail_evicted(bool big) const noexcept;
+
+        // estimated heap usage in bytes. thumbnails are not included,
+        // their memory is bounded by vfs::thumbnail_store
+        usize memory_usage() const noexcept;
+
         bool is_directory() const noexcept;
         bool is_regular_file() const noexcept;
         bool is_symlink() const noexcept;
@@ -126,24 +143,34 @@ namespace vfs
         ztd::statx file_stat_; // cached copy of struct statx()
         std::filesystem::file_status status_;
 
-        std::filesystem::path path_{}; // real path on file system
-        std::string uri_{};            // uri of the real path on file system
-
-        std::string name_{};                          // real name on file system
-        std::string display_name_{};                  // displayed name (in UTF-8)
-        std::string display_size_{};                  // displayed human-readable file size
-        std::string display_size_bytes_{};            // displayed file size in bytes
-        std::string display_disk_size_{};             // displayed human-readable file size on disk
-        std::string display_owner_{};                 // displayed owner
-        std::string display_group_{};                 // displayed group
-        std::string display_atime_{};                 // displayed accessed time
-        std::string display_btime_{};                 // displayed created time
-        std::string display_ctime_{};                 // displayed last status change time
-        std::string display_mtime_{};                 // displayed modification time
-        std::string display_perm_{};                  // displayed permission in string form
+        // the parent path is shared by all files in the same dir
+        std::shared_ptr<const std::filesystem::path> parent_{nullptr};
+        std::string name_{};         // real name on file system
+        std::string display_name_{}; // displayed name (in UTF-8), empty if same as name_
+        mutable std::string name_folded_{};
+
+        // owner and group names are interned, one copy per uid/gid
+        std::string_view display_owner_{}; // displayed owner
+        std::string_view display_group_{}; // displayed group
+
+        // formatted on first use, cleared by update(), both under a pooled lock
+        // since worker threads read them too
+        mutable std::string uri_{};                // uri of the real path on file system
+        mutable std::string display_size_{};       // displayed human-readable file size
+        mutable std::string display_size_bytes_{}; // displayed file size in bytes
+        mutable std::string display_disk_size_{};  // displayed human-readable file size on disk
+        mutable std::string display_atime_{};      // displayed accessed time
+        mutable std::string display_btime_{};      // displayed created time
+        mutable std::string display_ctime_{};      // displayed last status change time
+        mutable std::string display_mtime_{};      // displayed modification time
+        std::string display_perm_{};               // displayed permission in string form
+
         std::shared_ptr<vfs::mime_type> mime_type_{}; // mime type related information
         GdkPixbuf* big_thumbnail_{};                  // thumbnail of the file
         GdkPixbuf* small_thumbnail_{};                // thumbnail of the file
+        // set by the store trim in the main loop, read by the thumbnail loader thread
+        std::atomic<bool> big_thumbnail_evicted_{false};
+        std::atomic<bool> small_thumbnail_evicted_{false};
 
         bool is_special_desktop_entry_{false}; // is a .desktop file
 
@@ -0,0 +1,284 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include <filesystem>
+
+#include <span>
+#include <vector>
+#include <deque>
+
+#include <memory>
+
+#include <optional>
+
+#include <chrono>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+
+#include <glibmm.h>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "vfs/vfs-launcher.hxx"
+
+extern char** environ;
+
+namespace
+{
+    // children count as starting until they exit or STARTUP_TIME passed,
+    // opening hundreds of files with a one file viewer starts them in waves
+    constexpr usize MAX_STARTING = 4;
+    constexpr std::chrono::milliseconds STARTUP_TIME{500};
+
+    // POSIX asks to leave this much of ARG_MAX free
+    constexpr usize ARG_HEADROOM = 2048;
+
+    struct launch
+    {
+        std::filesystem::path working_dir{};
+        std::vector<std::string> argv{};
+    };
+
+    struct child
+    {
+        pid_t pid{0};
+        bool starting{true};
+    };
+
+    std::deque<launch> queue;
+    usize starting = 0;
+
+    void run_queue() noexcept;
+
+    void
+    child_started(const std::shared_ptr<child>& c) noexcept
+    {
+        if (!c->starting)
+        {
+            return;
+        }
+        c->starting = false;
+        starting -= 1;
+        run_queue();
+    }
+
+    const std::optional<pid_t>
+    spawn_posix(const launch& item, const std::span<char*> argv) noexcept
+    {
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+        // like g_spawn, do not leak our descriptors into the application
+        posix_spawn_file_actions_addclosefrom_np(&actions, STDERR_FILENO + 1);
+#endif
+#if defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP)
+        if (!item.working_dir.empty())
+        {
+            posix_spawn_file_actions_addchdir_np(&actions, item.working_dir.c_str());
+        }
+#endif
+
+        // the child must not inherit the signal setup of the file manager
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        sigset_t mask;
+        sigemptyset(&mask);
+        posix_spawnattr_setsigmask(&attr, &mask);
+        sigset_t defaults;
+        sigemptyset(&defaults);
+        sigaddset(&defaults, SIGPIPE);
+        sigaddset(&defaults, SIGCHLD);
+        posix_spawnattr_setsigdefault(&attr, &defaults);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+        pid_t pid = 0;
+        const i32 ret = posix_spawnp(&pid, argv.front(), &actions, &attr, argv.data(), environ);
+
+        posix_spawnattr_destroy(&attr);
+        posix_spawn_file_actions_destroy(&actions);
+
+        if (ret != 0)
+        {
+            ztd::logger::error("Failed to start {}: {}", item.argv.front(), std::strerror(ret));
+            return {};
+        }
+        return pid;
+    }
+
+#if !defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP)
+    // without posix_spawn_file_actions_addchdir_np() the child cannot change its
+    // working directory, glib spawn does that after the fork
+    const std::optional<pid_t>
+    spawn_glib(const launch& item, const std::span<char*> argv) noexcept
+    {
+        GPid pid = 0;
+        GError* error = nullptr;
+        const bool ret = g_spawn_async(item.working_dir.c_str(),
+                                       argv.data(),
+                                       nullptr,
+                                       GSpawnFlags(G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD |
+                                                   G_SPAWN_STDOUT_TO_DEV_NULL |
+                                                   G_SPAWN_STDERR_TO_DEV_NULL),
+                                       nullptr,
+                                       nullptr,
+                                       &pid,
+                                       &error);
+        if (!ret)
+        {
+            ztd::logger::error("Failed to start {}: {}", item.argv.front(), error->message);
+            g_error_free(error);
+            return {};
+        }
+        return pid;
+    }
+#endif
+
+    bool
+    start(const launch& item) noexcept
+    {
+        std::vector<char*> argv;
+        argv.reserve(item.argv.size() + 1);
+        for (const auto& arg : item.argv)
+        {
+            argv.push_back(const_cast<char*>(arg.data()));
+        }
+        argv.push_back(nullptr);
+
+#if defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP)
+        const auto spawned = spawn_posix(item, argv);
+#else
+        const auto spawned =
+            item.working_dir.empty() ? spawn_posix(item, argv) : spawn_glib(item, argv);
+#endif
+        if (!spawned)
+        {
+            return false;
+        }
+        const pid_t pid = *spawned;
+
+        starting += 1;
+        const auto c = std::make_shared<child>(child{pid});
+
+        g_child_watch_add(
+            pid,
+            [](GPid pid, i32 status, void* user_data)
+            {
+                (void)status;
+                auto* c = static_cast<std::shared_ptr<child>*>(user_data);
+                g_spawn_close_pid(pid);
+                child_started(*c);
+                delete c;
+            },
+            new std::shared_ptr<child>(c));
+
+        g_timeout_add_full(
+            G_PRIORITY_DEFAULT,
+            STARTUP_TIME.count(),
+            [](void* user_data) -> gboolean
+            {
+                child_started(*static_cast<std::shared_ptr<child>*>(user_data));
+                return G_SOURCE_REMOVE;
+            },
+            new std::shared_ptr<child>(c),
+            [](void* user_data) { delete static_cast<std::shared_ptr<child>*>(user_data); });
+
+        return true;
+    }
+
+    void
+    run_queue() noexcept
+    {
+        while (starting < MAX_STARTING && !queue.empty())
+        {
+            const launch item = std::move(queue.front());
+            queue.pop_front();
+            start(item);
+        }
+    }
+} // namespace
+
+usize
+vfs::launcher::arg_budget() noexcept
+{
+    i64 arg_max = sysconf(_SC_ARG_MAX);
+    if (arg_max <= 0)
+    {
+        arg_max = 128 * 1024; // _POSIX_ARG_MAX is too small to be useful
+    }
+
+    usize env_size = 0;
+    for (char** env = environ; env && *env; ++env)
+    {
+        env_size += std::strlen(*env) + 1 + sizeof(char*);
+    }
+
+    const usize used = env_size + ARG_HEADROOM;
+    if (static_cast<usize>(arg_max) <= used + ARG_HEADROOM)
+    {
+        return ARG_HEADROOM;
+    }
+    return static_cast<usize>(arg_max) - used;
+}
+
+const std::vector<std::span<const std::filesystem::path>>
+vfs::launcher::split(const std::span<const std::filesystem::path> files, usize budget) noexcept
+{
+    std::vector<std::span<const std::filesystem::path>> runs;
+
+    usize first = 0;
+    usize size = 0;
+    for (usize i = 0; i < files.size(); ++i)
+    {
+        const usize cost = files[i].native().size() + 1 + sizeof(char*);
+        // a run always takes at least one file, even if that one is too large
+        if (i > first && size + cost > budget)
+        {
+            runs.push_back(files.subspan(first, i - first));
+            first = i;
+            size = 0;
+        }
+        size += cost;
+    }
+    if (first < files.size())
+    {
+        runs.push_back(files.subspan(first));
+    }
+
+    return runs;
+}
+
+void
+vfs::launcher::spawn(const std::filesystem::path& working_dir,
+                     const std::span<const std::string> argv) noexcept
+{
+    if (argv.empty())
+    {
+        return;
+    }
+
+    queue.push_back({working_dir, std::vector<std::string>(argv.begin(), argv.end())});
+    run_queue();
+}
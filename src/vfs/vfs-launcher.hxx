@@ -0,0 +1,47 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <filesystem>
+
+#include <span>
+#include <vector>
+
+#include <ztd/ztd.hxx>
+
+namespace vfs::launcher
+{
+    // Starts applications with posix_spawn, which does not copy the address
+    // space of this process. Argument lists are split like xargs so every
+    // command fits in ARG_MAX, and only a few children are starting at any
+    // time, the rest wait in a queue. Main loop thread only.
+
+    // Linux also limits the size of each single argument
+    inline constexpr usize MAX_ARG_LENGTH = 128 * 1024;
+
+    // bytes left for argv after the environment, the same bound xargs uses
+    usize arg_budget() noexcept;
+
+    // split files into runs whose paths, with their argv pointers, fit in budget
+    const std::vector<std::span<const std::filesystem::path>>
+    split(const std::span<const std::filesystem::path> files, usize budget) noexcept;
+
+    // queued if too many children are still starting, stdout and stderr go to /dev/null
+    void spawn(const std::filesystem::path& working_dir,
+               const std::span<const std::string> argv) noexcept;
+} // namespace vfs::launcher
@@ -14,85 +14,72 @@
  */
 
 #include <string>
-
-#include <fmt/core.h>
+#include <vector>
 
 #include <filesystem>
 
 #include <memory>
 
-#include <functional>
-
 #include <glibmm.h>
 
 #include <ztd/ztd.hxx>
 #include <ztd/ztd_logger.hxx>
 
+#include "mime-type/mime-type.hxx"
+
 #include "vfs/vfs-dir.hxx"
+#include "vfs/vfs-mime-type.hxx"
+#include "vfs/vfs-monitor.hxx"
 #include "vfs/vfs-user-dirs.hxx"
 
 #include "vfs/vfs-mime-monitor.hxx"
 
+// editors often write a file in several steps, wait for them to finish
+inline constexpr u32 MIME_CHANGE_DELAY = 250; // ms
+
 static u32 mime_change_timer = 0;
 static bool on_mime_change_timer(void* user_data);
 
-struct mime_monitor
-{
-    mime_monitor(const std::shared_ptr<vfs::dir>& dir) : dir(dir){};
-    ~mime_monitor() = default;
-
-    static const std::shared_ptr<mime_monitor>
-    create(const std::shared_ptr<vfs::dir>& dir) noexcept;
+static std::shared_ptr<vfs::monitor> user_mime_monitor = nullptr;
 
-    std::shared_ptr<vfs::dir> dir;
-
-    // signals
-    void on_mime_change(const std::shared_ptr<vfs::file>& file);
-};
-
-const std::shared_ptr<mime_monitor>
-mime_monitor::create(const std::shared_ptr<vfs::dir>& dir) noexcept
-{
-    return std::make_shared<mime_monitor>(dir);
-}
-
-void
-mime_monitor::on_mime_change(const std::shared_ptr<vfs::file>& file)
+static void
+on_mime_change(const vfs::monitor::event event, const std::filesystem::path& path)
 {
-    (void)file;
+    // after lost events the package files are all compared again
+    if (event != vfs::monitor::event::rescan && path.extension() != ".xml")
+    {
+        return;
+    }
 
     if (mime_change_timer != 0)
     {
-        // timer is already running, so ignore request
-        // ztd::logger::debug("MIME-UPDATE already set");
-        return;
+        // still being written, restart the delay from this event
+        // ztd::logger::debug("MIME-UPDATE timer reset");
+        g_source_remove(mime_change_timer);
     }
 
-    // update mime database in 2 seconds
-    mime_change_timer = g_timeout_add_seconds(2, (GSourceFunc)on_mime_change_timer, nullptr);
+    mime_change_timer =
+        g_timeout_add(MIME_CHANGE_DELAY, (GSourceFunc)on_mime_change_timer, nullptr);
     // ztd::logger::debug("MIME-UPDATE timer started");
 }
 
-std::shared_ptr<mime_monitor> user_mime_monitor = nullptr;
-
 static bool
 on_mime_change_timer(void* user_data)
 {
     (void)user_data;
 
-    // ztd::logger::debug("MIME-UPDATE on_timer");
-    const auto data_dir = vfs::user_dirs->data_dir();
-    const std::string command1 = fmt::format("update-mime-database {}/mime", data_dir.string());
-    ztd::logger::info("COMMAND={}", command1);
-    Glib::spawn_command_line_async(command1);
+    mime_change_timer = 0;
 
-    const std::string command2 =
-        fmt::format("update-desktop-database {}/applications", data_dir.string());
-    ztd::logger::info("COMMAND={}", command2);
-    Glib::spawn_command_line_async(command2);
+    // only the changed package files are parsed again, and only the
+    // files that have one of the changed types are updated
+    const std::vector<std::string> changed = mime_type_update_user_overlay();
+    if (!changed.empty())
+    {
+        ztd::logger::info("user mime types changed: {}", ztd::join(changed, ", "));
+        vfs_mime_type_invalidate(changed);
+        vfs_dir_mime_type_reload(changed);
+    }
 
-    g_source_remove(mime_change_timer);
-    mime_change_timer = 0;
     return false;
 }
 
@@ -110,13 +97,9 @@ vfs_mime_monitor()
         return;
     }
 
-    user_mime_monitor = mime_monitor::create(vfs::dir::create(path));
-
     // ztd::logger::debug("MIME-UPDATE watch started");
-    user_mime_monitor->dir->add_event<spacefm::signal::file_created>(
-        std::bind(&mime_monitor::on_mime_change, user_mime_monitor, std::placeholders::_1));
-    user_mime_monitor->dir->add_event<spacefm::signal::file_changed>(
-        std::bind(&mime_monitor::on_mime_change, user_mime_monitor, std::placeholders::_1));
-    user_mime_monitor->dir->add_event<spacefm::signal::file_deleted>(
-        std::bind(&mime_monitor::on_mime_change, user_mime_monitor, std::placeholders::_1));
+    user_mime_monitor = vfs::monitor::create(path, &on_mime_change);
+
+    // catch changes made before the monitor was started
+    on_mime_change_timer(nullptr);
 }
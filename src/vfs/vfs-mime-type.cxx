@@ -47,6 +47,7 @@
 #include "vfs/vfs-dir.hxx"
 #include "vfs/vfs-utils.hxx"
 #include "vfs/vfs-mime-type.hxx"
+#include "vfs/vfs-mime-monitor.hxx"
 
 static std::map<std::string, std::shared_ptr<vfs::mime_type>> mime_map;
 std::mutex mime_map_lock;
@@ -81,6 +82,16 @@ vfs_mime_type_get_from_type(const std::string_view type)
     return mime_type;
 }
 
+void
+vfs_mime_type_invalidate(const std::span<const std::string> types)
+{
+    std::unique_lock<std::mutex> lock(mime_map_lock);
+    for (const std::string& type : types)
+    {
+        mime_map.erase(type);
+    }
+}
+
 static bool
 vfs_mime_type_reload()
 {
@@ -128,6 +139,9 @@ vfs_mime_type_init()
 
         mime_caches_monitors.emplace_back(monitor);
     }
+
+    // the user mime database is kept up to date in process
+    vfs_mime_monitor();
 }
 
 void
@@ -24,6 +24,8 @@
 
 #include <vector>
 
+#include <span>
+
 #include <optional>
 
 #include <memory>
@@ -82,6 +84,9 @@ const std::shared_ptr<vfs::mime_type>
 vfs_mime_type_get_from_file(const std::filesystem::path& file_path);
 const std::shared_ptr<vfs::mime_type> vfs_mime_type_get_from_type(const std::string_view type);
 
+// drop the cached types, the next lookup gets the new description and icon
+void vfs_mime_type_invalidate(const std::span<const std::string> types);
+
 //////////////////////
 
 const std::optional<std::filesystem::path>
@@ -18,11 +18,28 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <string>
+
 #include <filesystem>
 
+#include <array>
+#include <vector>
+#include <unordered_map>
+
+#include <ranges>
+
 #include <memory>
 
+#include <mutex>
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <sys/inotify.h>
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
 
 #include <gtkmm.h>
 #include <glibmm.h>
@@ -40,6 +57,478 @@
 inline constexpr u32 EVENT_SIZE = (sizeof(inotify_event));
 inline constexpr u32 EVENT_BUF_LEN = (1024 * (EVENT_SIZE + 16));
 
+#if defined(FAN_REPORT_DFID_NAME)
+namespace
+{
+    // One fanotify group serves every directory monitor. Events carry the file handle
+    // of the parent directory and the entry name, and are routed to the monitors of
+    // that directory. A filesystem mark covers all directories of a filesystem with a
+    // single mark but needs CAP_SYS_ADMIN, otherwise each directory gets an inode mark
+    // on the same fd. Nothing counts against fs.inotify.max_user_watches, and no
+    // directory fd is kept open, so a watched filesystem can still be unmounted.
+    constexpr u64 FANOTIFY_DIR_MASK =
+        FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_ATTRIB | FAN_ONDIR;
+    // FAN_MODIFY would wake us for every write anywhere on the filesystem,
+    // one event when a writer closes the file is enough
+    constexpr u64 FANOTIFY_FILESYSTEM_MASK = FANOTIFY_DIR_MASK | FAN_CLOSE_WRITE;
+    // the kernel drops the mark of a deleted directory, FAN_DELETE_SELF tells us
+    constexpr u64 FANOTIFY_INODE_MASK =
+        FANOTIFY_DIR_MASK | FAN_MODIFY | FAN_DELETE_SELF | FAN_EVENT_ON_CHILD;
+
+    struct fanotify_watch
+    {
+        const vfs::monitor* owner{nullptr};
+        std::filesystem::path path{}; // as passed to the monitor, can be a symlink
+        vfs::monitor::callback_t callback{};
+    };
+
+    struct fanotify_dir
+    {
+        std::filesystem::path path{}; // absolute
+        std::string fsid{};
+        bool filesystem_mark{false};
+        // the directory has an inode mark of its own, false once the kernel
+        // dropped the mark of the deleted directory
+        bool inode_mark{false};
+        std::vector<fanotify_watch> watches{};
+    };
+
+    struct fanotify_filesystem
+    {
+        u32 count{0};
+    };
+
+    // monitors are created and destroyed on dir loader threads
+    std::recursive_mutex fanotify_lock;
+    i32 fanotify_fd = -1;
+    bool fanotify_failed = false;
+    bool fanotify_filesystem_marks = true;
+    sigc::connection fanotify_io_handler;
+
+    // key is the fsid followed by the directory file handle
+    std::unordered_map<std::string, fanotify_dir> fanotify_dirs;
+    std::unordered_map<const vfs::monitor*, std::string> fanotify_owners;
+    // key is the fsid
+    std::unordered_map<std::string, fanotify_filesystem> fanotify_filesystems;
+
+    const std::string
+    fanotify_key(const void* fsid, const file_handle* handle) noexcept
+    {
+        std::string key;
+        key.append(static_cast<const char*>(fsid), sizeof(fsid_t));
+        key.append(reinterpret_cast<const char*>(&handle->handle_type), sizeof(i32));
+        key.append(reinterpret_cast<const char*>(handle->f_handle), handle->handle_bytes);
+        return key;
+    }
+
+    void
+    fanotify_dispatch(const std::string& key, const std::string_view name, u64 mask) noexcept
+    {
+        if (name.empty())
+        {
+            return;
+        }
+
+        const auto it = fanotify_dirs.find(key);
+        if (it == fanotify_dirs.cend())
+        {
+            // another directory on a filesystem mark
+            return;
+        }
+
+        if (name == ".")
+        { // events on the directory itself
+            if (mask & FAN_DELETE_SELF)
+            {
+                it->second.inode_mark = false;
+            }
+            return;
+        }
+
+        const auto event_path = it->second.path / name;
+        const bool created = mask & (FAN_CREATE | FAN_MOVED_TO);
+        const bool deleted = mask & (FAN_DELETE | FAN_MOVED_FROM);
+
+        vfs::monitor::event monitor_event;
+        if (created && deleted)
+        { // the kernel merged both events, only the current state matters
+            const auto stat = ztd::statx(event_path, ztd::statx::symlink::no_follow);
+            monitor_event = stat ? vfs::monitor::event::created : vfs::monitor::event::deleted;
+        }
+        else if (created)
+        {
+            monitor_event = vfs::monitor::event::created;
+        }
+        else if (deleted)
+        {
+            monitor_event = vfs::monitor::event::deleted;
+        }
+        else if (mask & (FAN_MODIFY | FAN_CLOSE_WRITE | FAN_ATTRIB))
+        {
+            monitor_event = vfs::monitor::event::changed;
+        }
+        else
+        {
+            monitor_event = vfs::monitor::event::other;
+        }
+
+#if defined(VFS_MONITOR_DEBUG)
+        ztd::logger::debug("fanotify-event MASK={} PATH={}", mask, event_path);
+#endif
+
+        // a callback can remove monitors
+        const auto watches = it->second.watches;
+        for (const auto& watch : watches)
+        {
+            if (fanotify_owners.contains(watch.owner))
+            {
+                watch.callback(monitor_event, watch.path / name);
+            }
+        }
+    }
+
+    void
+    fanotify_dispatch_rescan() noexcept
+    {
+        // events were lost, every directory has to be reread
+        std::vector<fanotify_watch> watches;
+        for (const auto& dir : fanotify_dirs | std::views::values)
+        {
+            watches.insert(watches.cend(), dir.watches.cbegin(), dir.watches.cend());
+        }
+
+        // a callback can remove monitors
+        for (const auto& watch : watches)
+        {
+            if (fanotify_owners.contains(watch.owner))
+            {
+                watch.callback(vfs::monitor::event::rescan, watch.path);
+            }
+        }
+    }
+
+    bool
+    on_fanotify_event(const Glib::IOCondition condition) noexcept
+    {
+        if (condition == Glib::IOCondition::IO_HUP || condition == Glib::IOCondition::IO_ERR)
+        {
+            ztd::logger::error("Disconnected from fanotify");
+            return false;
+        }
+
+        const std::scoped_lock<std::recursive_mutex> lock(fanotify_lock);
+
+        alignas(fanotify_event_metadata) std::array<char, 64 * 1024> buffer;
+        bool overflow = false;
+        while (true)
+        {
+            auto length = read(fanotify_fd, buffer.data(), buffer.size());
+            if (length == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            if (length == -1 && errno == EAGAIN)
+            {
+                break;
+            }
+            if (length <= 0)
+            {
+                ztd::logger::error("Error reading fanotify event: {}", std::strerror(errno));
+                return false;
+            }
+
+            for (auto* metadata = reinterpret_cast<fanotify_event_metadata*>(buffer.data());
+                 FAN_EVENT_OK(metadata, length);
+                 metadata = FAN_EVENT_NEXT(metadata, length))
+            {
+                if (metadata->vers != FANOTIFY_METADATA_VERSION)
+                {
+                    ztd::logger::error("fanotify metadata version mismatch");
+                    return false;
+                }
+                if (metadata->mask & FAN_Q_OVERFLOW)
+                {
+                    // rescan once the queue is drained, events read after
+                    // the overflow are still dispatched
+                    ztd::logger::warn("fanotify event queue overflow, rescanning");
+                    overflow = true;
+                    continue;
+                }
+
+                // FID groups report no fd, only info records
+                const auto* event = reinterpret_cast<const char*>(metadata);
+                usize offset = metadata->metadata_len;
+                while (offset + sizeof(fanotify_event_info_header) <= metadata->event_len)
+                {
+                    const auto* header =
+                        reinterpret_cast<const fanotify_event_info_header*>(event + offset);
+                    if (header->len == 0)
+                    {
+                        break;
+                    }
+                    if (header->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME)
+                    {
+                        const auto* fid = reinterpret_cast<const fanotify_event_info_fid*>(header);
+                        const auto* handle = reinterpret_cast<const file_handle*>(fid->handle);
+                        const auto* name =
+                            reinterpret_cast<const char*>(handle->f_handle + handle->handle_bytes);
+
+                        fanotify_dispatch(fanotify_key(&fid->fsid, handle), name, metadata->mask);
+                    }
+                    offset += header->len;
+                }
+            }
+        }
+
+        if (overflow)
+        {
+            fanotify_dispatch_rescan();
+        }
+
+        return true;
+    }
+
+    bool
+    fanotify_open() noexcept
+    {
+        if (fanotify_fd != -1)
+        {
+            return true;
+        }
+        if (fanotify_failed)
+        {
+            return false;
+        }
+
+        // FAN_REPORT_DFID_NAME needs Linux 5.9, unprivileged use needs Linux 5.13
+        fanotify_fd = fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_CLOEXEC |
+                                        FAN_NONBLOCK,
+                                    O_RDONLY | O_LARGEFILE);
+        if (fanotify_fd == -1)
+        {
+            ztd::logger::info("fanotify is not available, using inotify: {}",
+                              std::strerror(errno));
+            fanotify_failed = true;
+            return false;
+        }
+
+        fanotify_io_handler =
+            Glib::signal_io().connect(sigc::ptr_fun(&on_fanotify_event),
+                                      fanotify_fd,
+                                      Glib::IOCondition::IO_IN | Glib::IOCondition::IO_HUP |
+                                          Glib::IOCondition::IO_ERR);
+        return true;
+    }
+
+    bool
+    fanotify_mark_filesystem(const i32 dir_fd, const std::string& fsid) noexcept
+    {
+        const auto it = fanotify_filesystems.find(fsid);
+        if (it != fanotify_filesystems.cend())
+        {
+            it->second.count += 1;
+            return true;
+        }
+        if (!fanotify_filesystem_marks)
+        {
+            return false;
+        }
+
+        if (fanotify_mark(fanotify_fd,
+                          FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                          FANOTIFY_FILESYSTEM_MASK,
+                          dir_fd,
+                          nullptr) == -1)
+        {
+            if (errno == EPERM)
+            { // unprivileged, do not try again
+                fanotify_filesystem_marks = false;
+            }
+            return false;
+        }
+
+        fanotify_filesystems.insert({fsid, {1}});
+        return true;
+    }
+
+    void
+    fanotify_unmark_filesystem(const std::filesystem::path& path, const std::string& fsid) noexcept
+    {
+        const auto it = fanotify_filesystems.find(fsid);
+        if (it == fanotify_filesystems.cend())
+        {
+            return;
+        }
+        it->second.count -= 1;
+        if (it->second.count != 0)
+        {
+            return;
+        }
+
+        fanotify_filesystems.erase(it);
+
+        // any path on the filesystem will do, the directory itself can be gone.
+        // Once the filesystem is unmounted its mark is gone as well.
+        for (auto parent = path; !parent.empty(); parent = parent.parent_path())
+        {
+            struct statfs sfs;
+            if (statfs(parent.c_str(), &sfs) == 0 &&
+                std::memcmp(&sfs.f_fsid, fsid.data(), sizeof(fsid_t)) == 0)
+            {
+                if (fanotify_mark(fanotify_fd,
+                                  FAN_MARK_REMOVE | FAN_MARK_FILESYSTEM,
+                                  FANOTIFY_FILESYSTEM_MASK,
+                                  AT_FDCWD,
+                                  parent.c_str()) == -1)
+                {
+                    ztd::logger::debug("failed to remove fanotify filesystem mark: {}",
+                                       std::strerror(errno));
+                }
+                return;
+            }
+            if (parent == parent.root_path())
+            {
+                return;
+            }
+        }
+    }
+
+    void
+    fanotify_unmark_dir(const std::string& key, const fanotify_dir& dir) noexcept
+    {
+        // the path has to still lead to the marked directory, after a rename
+        // another directory can have taken its place. A mark left behind stays
+        // until the inode is freed, its events match no monitor.
+        std::array<char, sizeof(file_handle) + MAX_HANDLE_SZ> handle_buffer;
+        auto* handle = reinterpret_cast<file_handle*>(handle_buffer.data());
+        handle->handle_bytes = MAX_HANDLE_SZ;
+        i32 mount_id = 0;
+        if (name_to_handle_at(AT_FDCWD, dir.path.c_str(), handle, &mount_id, 0) == -1 ||
+            fanotify_key(dir.fsid.data(), handle) != key)
+        {
+            return;
+        }
+
+        if (fanotify_mark(fanotify_fd,
+                          FAN_MARK_REMOVE,
+                          FANOTIFY_INODE_MASK,
+                          AT_FDCWD,
+                          dir.path.c_str()) == -1)
+        {
+            ztd::logger::debug("failed to remove fanotify mark for {}: {}",
+                               dir.path.string(),
+                               std::strerror(errno));
+        }
+    }
+
+    bool
+    fanotify_add_watch(const vfs::monitor* owner, const std::filesystem::path& path,
+                       const vfs::monitor::callback_t& callback) noexcept
+    {
+        const std::scoped_lock<std::recursive_mutex> lock(fanotify_lock);
+
+        if (!fanotify_open())
+        {
+            return false;
+        }
+
+        const auto real_path = std::filesystem::absolute(path);
+
+        // resolve the directory once, the handle and the mark refer to the same inode
+        const i32 dir_fd = open(real_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd == -1)
+        {
+            return false;
+        }
+
+        struct statfs sfs;
+        if (fstatfs(dir_fd, &sfs) == -1)
+        {
+            close(dir_fd);
+            return false;
+        }
+        const std::string fsid(reinterpret_cast<const char*>(&sfs.f_fsid), sizeof(fsid_t));
+
+        std::array<char, sizeof(file_handle) + MAX_HANDLE_SZ> handle_buffer;
+        auto* handle = reinterpret_cast<file_handle*>(handle_buffer.data());
+        handle->handle_bytes = MAX_HANDLE_SZ;
+        i32 mount_id = 0;
+        if (name_to_handle_at(dir_fd, "", handle, &mount_id, AT_EMPTY_PATH) == -1)
+        { // filesystem without file handles
+            close(dir_fd);
+            return false;
+        }
+        const auto key = fanotify_key(&sfs.f_fsid, handle);
+
+        auto it = fanotify_dirs.find(key);
+        if (it == fanotify_dirs.cend())
+        {
+            fanotify_dir dir{real_path, fsid, false, false, {}};
+            if (fanotify_mark_filesystem(dir_fd, fsid))
+            {
+                dir.filesystem_mark = true;
+            }
+            else
+            {
+                if (fanotify_mark(fanotify_fd,
+                                  FAN_MARK_ADD,
+                                  FANOTIFY_INODE_MASK,
+                                  dir_fd,
+                                  nullptr) == -1)
+                {
+                    close(dir_fd);
+                    return false;
+                }
+                dir.inode_mark = true;
+            }
+            it = fanotify_dirs.insert({key, std::move(dir)}).first;
+        }
+        // the mark holds the inode, not the fd
+        close(dir_fd);
+
+        it->second.watches.push_back({owner, path, callback});
+        fanotify_owners.insert_or_assign(owner, key);
+
+        return true;
+    }
+
+    void
+    fanotify_rm_watch(const vfs::monitor* owner) noexcept
+    {
+        const std::scoped_lock<std::recursive_mutex> lock(fanotify_lock);
+
+        const auto owner_it = fanotify_owners.find(owner);
+        if (owner_it == fanotify_owners.cend())
+        {
+            return;
+        }
+        const auto it = fanotify_dirs.find(owner_it->second);
+        fanotify_owners.erase(owner_it);
+        if (it == fanotify_dirs.cend())
+        {
+            return;
+        }
+
+        auto& dir = it->second;
+        std::erase_if(dir.watches, [owner](const auto& watch) { return watch.owner == owner; });
+        if (!dir.watches.empty())
+        {
+            return;
+        }
+
+        if (dir.inode_mark)
+        {
+            fanotify_unmark_dir(it->first, dir);
+        }
+        else if (dir.filesystem_mark)
+        {
+            fanotify_unmark_filesystem(dir.path, dir.fsid);
+        }
+        fanotify_dirs.erase(it);
+    }
+} // namespace
+#endif
+
 const std::shared_ptr<vfs::monitor>
 vfs::monitor::create(const std::filesystem::path& path, const callback_t& callback) noexcept
 {
@@ -49,6 +538,22 @@ vfs::monitor::create(const std::filesystem::path& path, const callback_t& callba
 vfs::monitor::monitor(const std::filesystem::path& path, const callback_t& callback)
     : path_(path), callback_(callback)
 {
+#if defined(FAN_REPORT_DFID_NAME)
+    // only directories, file monitors stay on inotify
+    if (std::filesystem::is_directory(this->path_))
+    {
+        this->fanotify_ = fanotify_add_watch(
+            this,
+            this->path_,
+            [this](const vfs::monitor::event event, const std::filesystem::path& path)
+            { this->dispatch_event(event, path); });
+        if (this->fanotify_)
+        {
+            return;
+        }
+    }
+#endif
+
     this->inotify_fd_ = inotify_init();
     if (this->inotify_fd_ == -1)
     {
@@ -91,6 +596,14 @@ vfs::monitor::~monitor()
 {
     // ztd::logger::debug("vfs::monitor::~monitor({}) {}", fmt::ptr(this),this->path_);
 
+#if defined(FAN_REPORT_DFID_NAME)
+    if (this->fanotify_)
+    {
+        fanotify_rm_watch(this);
+        return;
+    }
+#endif
+
     this->signal_io_handler_.disconnect();
 
     inotify_rm_watch(this->inotify_fd_, this->inotify_wd_);
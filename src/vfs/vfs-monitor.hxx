@@ -39,6 +39,8 @@ namespace vfs
             deleted,
             changed,
             other,
+            // events were lost, path is the monitored directory which has to be reread
+            rescan,
         };
 
         // Callback function which will be called when monitored events happen
@@ -59,6 +61,9 @@ namespace vfs
         i32 inotify_fd_{-1};
         i32 inotify_wd_{-1};
 
+        // directory is watched by the shared fanotify group instead of inotify
+        bool fanotify_{false};
+
         std::filesystem::path path_{};
 
 #if (GTK_MAJOR_VERSION == 4)
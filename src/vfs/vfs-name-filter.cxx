@@ -0,0 +1,190 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <string_view>
+
+#include <memory>
+
+#include <optional>
+
+#include <regex>
+
+#include <algorithm>
+
+#include <cctype>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "vfs/vfs-file.hxx"
+
+#include "vfs/vfs-name-filter.hxx"
+
+vfs::name_filter::name_filter(const std::string_view pattern) noexcept : pattern_(pattern)
+{
+    // smart case
+    this->icase_ = std::ranges::none_of(pattern, [](unsigned char c) { return std::isupper(c); });
+
+    if (pattern.starts_with('/'))
+    {
+        this->mode_ = vfs::name_filter::mode::regex;
+
+        auto flags = std::regex::ECMAScript | std::regex::optimize;
+        if (this->icase_)
+        {
+            flags |= std::regex::icase;
+        }
+        try
+        {
+            this->regex_ = std::regex(pattern.substr(1).data(), pattern.size() - 1, flags);
+        }
+        catch (const std::regex_error&)
+        {
+            // still being typed
+            this->valid_ = false;
+        }
+        return;
+    }
+
+    std::string_view text = pattern;
+    if (text.starts_with('^'))
+    {
+        this->anchor_start_ = true;
+        text.remove_prefix(1);
+    }
+    if (text.ends_with('$'))
+    {
+        this->anchor_end_ = true;
+        text.remove_suffix(1);
+    }
+
+    if (text.find_first_of("*?[") != std::string_view::npos)
+    {
+        this->mode_ = vfs::name_filter::mode::glob;
+        this->text_ = text;
+        if (!this->anchor_start_ && !this->text_.starts_with('*'))
+        {
+            this->text_.insert(0, 1, '*');
+        }
+        if (!this->anchor_end_ && !this->text_.ends_with('*'))
+        {
+            this->text_.push_back('*');
+        }
+    }
+    else
+    {
+        this->mode_ = vfs::name_filter::mode::substring;
+        this->text_ = text;
+    }
+
+    if (this->icase_)
+    {
+        this->text_ = ztd::lower(this->text_);
+    }
+}
+
+const std::shared_ptr<vfs::name_filter>
+vfs::name_filter::create(const std::string_view pattern) noexcept
+{
+    return std::make_shared<vfs::name_filter>(pattern);
+}
+
+bool
+vfs::name_filter::match(const std::shared_ptr<vfs::file>& file) const noexcept
+{
+    if (this->mode_ == vfs::name_filter::mode::regex)
+    {
+        // icase is handled by the regex
+        return this->match(file->name());
+    }
+    return this->match(this->icase_ ? file->name_folded() : file->name());
+}
+
+bool
+vfs::name_filter::match(const std::string_view name) const noexcept
+{
+    switch (this->mode_)
+    {
+        case vfs::name_filter::mode::substring:
+            if (this->anchor_start_ && this->anchor_end_)
+            {
+                return name == this->text_;
+            }
+            if (this->anchor_start_)
+            {
+                return name.starts_with(this->text_);
+            }
+            if (this->anchor_end_)
+            {
+                return name.ends_with(this->text_);
+            }
+            return name.contains(this->text_);
+        case vfs::name_filter::mode::glob:
+            return ztd::fnmatch(this->text_, name);
+        case vfs::name_filter::mode::regex:
+            if (!this->valid_)
+            {
+                return true;
+            }
+            return std::regex_search(name.cbegin(), name.cend(), *this->regex_);
+    }
+    return true;
+}
+
+bool
+vfs::name_filter::refines(const vfs::name_filter& other) const noexcept
+{
+    // only substrings are cheap to reason about, typing more text can only
+    // remove matches as long as the case mode and anchors stay the same
+    if (this->mode_ != vfs::name_filter::mode::substring ||
+        other.mode_ != vfs::name_filter::mode::substring || this->icase_ != other.icase_ ||
+        this->anchor_start_ != other.anchor_start_ || this->anchor_end_ != other.anchor_end_)
+    {
+        return false;
+    }
+
+    if (this->anchor_start_ && this->anchor_end_)
+    {
+        return this->text_ == other.text_;
+    }
+    if (this->anchor_start_)
+    {
+        return this->text_.starts_with(other.text_);
+    }
+    if (this->anchor_end_)
+    {
+        return this->text_.ends_with(other.text_);
+    }
+    return this->text_.contains(other.text_);
+}
+
+const std::string_view
+vfs::name_filter::pattern() const noexcept
+{
+    return this->pattern_;
+}
+
+vfs::name_filter::mode
+vfs::name_filter::type() const noexcept
+{
+    return this->mode_;
+}
+
+bool
+vfs::name_filter::is_valid() const noexcept
+{
+    return this->valid_;
+}
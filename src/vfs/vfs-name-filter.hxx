@@ -0,0 +1,83 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <memory>
+
+#include <optional>
+
+#include <regex>
+
+#include <ztd/ztd.hxx>
+
+namespace vfs
+{
+    struct file;
+
+    // A file name pattern compiled once and matched against many files.
+    //
+    //   /expr      ECMAScript regex
+    //   a*b?c[de]  glob, '*' is implied at the ends unless anchored
+    //   text       substring
+    //
+    // '^' at the start and '$' at the end anchor glob and substring patterns.
+    // Matching ignores case, against the pre-folded file names, unless the
+    // pattern contains an uppercase letter. Then the names are matched as is.
+    struct name_filter
+    {
+        enum class mode
+        {
+            substring,
+            glob,
+            regex,
+        };
+
+        name_filter() = delete;
+        name_filter(const std::string_view pattern) noexcept;
+        ~name_filter() = default;
+        name_filter(const name_filter& other) = delete;
+        name_filter& operator=(const name_filter& other) = delete;
+
+        static const std::shared_ptr<vfs::name_filter>
+        create(const std::string_view pattern) noexcept;
+
+        [[nodiscard]] bool match(const std::shared_ptr<vfs::file>& file) const noexcept;
+        [[nodiscard]] bool match(const std::string_view name) const noexcept;
+
+        // everything this filter matches is also matched by other,
+        // so other's result set can be filtered further
+        [[nodiscard]] bool refines(const vfs::name_filter& other) const noexcept;
+
+        [[nodiscard]] const std::string_view pattern() const noexcept;
+        [[nodiscard]] vfs::name_filter::mode type() const noexcept;
+        // false for a regex that does not compile, such a filter matches everything
+        [[nodiscard]] bool is_valid() const noexcept;
+
+      private:
+        std::string pattern_{};
+        vfs::name_filter::mode mode_{vfs::name_filter::mode::substring};
+        bool icase_{true};
+        bool anchor_start_{false};
+        bool anchor_end_{false};
+
+        std::string text_{}; // substring or glob, folded when icase_
+        std::optional<std::regex> regex_{std::nullopt};
+        bool valid_{true};
+    };
+} // namespace vfs
@@ -0,0 +1,515 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include <fmt/core.h>
+
+#include <filesystem>
+
+#include <array>
+#include <vector>
+
+#include <optional>
+
+#include <memory>
+
+#include <algorithm>
+
+#include <chrono>
+
+#include <mutex>
+#include <thread>
+#include <stop_token>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <gtkmm.h>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "mime-type/mime-type.hxx"
+
+#include "vfs/vfs-file.hxx"
+#include "vfs/vfs-user-dirs.hxx"
+
+#include "vfs/vfs-preview.hxx"
+
+extern char** environ;
+
+// only the start of a text file is shown
+inline constexpr usize MAX_TEXT_BYTES = 16 * 1024;
+// larger images are described but not decoded
+inline constexpr u64 MAX_IMAGE_BYTES = 64 * 1024 * 1024;
+inline constexpr usize READ_SIZE = 64 * 1024;
+// decoding an image is given up after this, checked between chunks
+inline constexpr std::chrono::milliseconds TIME_BUDGET{1500};
+// taking a video frame is given up after this, the thumbnailer is killed
+inline constexpr std::chrono::milliseconds VIDEO_TIME_BUDGET{5000};
+inline constexpr std::chrono::milliseconds VIDEO_POLL_INTERVAL{20};
+// thumbnail sizes of the shared thumbnails/normal and thumbnails/large cache
+inline constexpr i32 NORMAL_THUMBNAIL_SIZE = 128;
+inline constexpr i32 LARGE_THUMBNAIL_SIZE = 256;
+
+namespace
+{
+    struct delivery
+    {
+        std::weak_ptr<vfs::preview> preview{};
+        u64 generation{0};
+        std::unique_ptr<vfs::preview::result> result{nullptr};
+    };
+
+    struct image_size
+    {
+        i32 size{0};
+        i32 width{0};
+        i32 height{0};
+    };
+
+    void
+    on_size_prepared(GdkPixbufLoader* loader, i32 width, i32 height, image_size* data) noexcept
+    {
+        data->width = width;
+        data->height = height;
+
+        if (width <= data->size && height <= data->size)
+        {
+            return;
+        }
+
+        // fit into size x size, the loader scales while decoding
+        if (width > height)
+        {
+            height = std::max(1, height * data->size / width);
+            width = data->size;
+        }
+        else
+        {
+            width = std::max(1, width * data->size / height);
+            height = data->size;
+        }
+        gdk_pixbuf_loader_set_size(loader, width, height);
+    }
+
+    // a thumbnail from the shared cache, only if it was made for this mtime
+    GdkPixbuf*
+    load_cached_thumbnail(const std::filesystem::path& path, std::time_t mtime) noexcept
+    {
+        GdkPixbuf* thumbnail = gdk_pixbuf_new_from_file(path.c_str(), nullptr);
+        if (!thumbnail)
+        {
+            return nullptr;
+        }
+        const char* thumb_mtime = gdk_pixbuf_get_option(thumbnail, "tEXt::Thumb::MTime");
+        if (thumb_mtime == nullptr || std::strtoll(thumb_mtime, nullptr, 10) != mtime)
+        {
+            g_object_unref(thumbnail);
+            return nullptr;
+        }
+        return thumbnail;
+    }
+
+    // the in process ffmpegthumbnailer api cannot be interrupted, seeking in a
+    // broken or slow file can take forever, so the program is run instead
+    bool
+    create_thumbnail(const std::filesystem::path& path,
+                     const std::filesystem::path& thumbnail_file, const auto& is_current) noexcept
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(thumbnail_file.parent_path(), ec);
+
+        // renamed when complete, other readers of the cache never see a partial file
+        std::string tmp_file = fmt::format("{}.XXXXXX", thumbnail_file.string());
+        const i32 fd = mkstemp(tmp_file.data());
+        if (fd == -1)
+        {
+            ztd::logger::debug("preview: failed to create {}: {}", tmp_file, std::strerror(errno));
+            return false;
+        }
+        close(fd);
+
+        std::string size = std::to_string(LARGE_THUMBNAIL_SIZE);
+        std::string path_arg = path.string();
+        std::array<char*, 12> argv{const_cast<char*>("ffmpegthumbnailer"),
+                                   const_cast<char*>("-s"),
+                                   size.data(),
+                                   const_cast<char*>("-t"),
+                                   const_cast<char*>("25"),
+                                   const_cast<char*>("-c"),
+                                   const_cast<char*>("png"),
+                                   const_cast<char*>("-i"),
+                                   path_arg.data(),
+                                   const_cast<char*>("-o"),
+                                   tmp_file.data(),
+                                   nullptr};
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+        posix_spawn_file_actions_addclosefrom_np(&actions, STDERR_FILENO + 1);
+#endif
+
+        pid_t pid = 0;
+        const i32 ret = posix_spawnp(&pid, argv.front(), &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if (ret != 0)
+        {
+            ztd::logger::debug("preview: cannot run ffmpegthumbnailer: {}", std::strerror(ret));
+            unlink(tmp_file.c_str());
+            return false;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + VIDEO_TIME_BUDGET;
+        i32 status = 0;
+        bool ok = false;
+        while (true)
+        {
+            const pid_t waited = waitpid(pid, &status, WNOHANG);
+            if (waited == pid)
+            {
+                ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+                break;
+            }
+            if (waited == -1 && errno != EINTR)
+            {
+                break;
+            }
+            if (!is_current() || std::chrono::steady_clock::now() > deadline)
+            {
+                kill(pid, SIGKILL);
+                while (waitpid(pid, &status, 0) == -1 && errno == EINTR)
+                {
+                }
+                break;
+            }
+            std::this_thread::sleep_for(VIDEO_POLL_INTERVAL);
+        }
+
+        if (!ok || rename(tmp_file.c_str(), thumbnail_file.c_str()) == -1)
+        {
+            unlink(tmp_file.c_str());
+            return false;
+        }
+        return true;
+    }
+} // namespace
+
+vfs::preview::result::~result()
+{
+    if (this->pixbuf)
+    {
+        g_object_unref(this->pixbuf);
+    }
+}
+
+vfs::preview::preview(const callback_t& callback) noexcept : callback_(callback)
+{
+    this->thread_ =
+        std::jthread([this](const std::stop_token& stop_token) { this->worker_thread(stop_token); });
+}
+
+vfs::preview::~preview()
+{
+    this->generation_ += 1;
+    this->thread_.request_stop();
+    this->cond_.notify_all();
+    if (this->thread_.joinable())
+    {
+        this->thread_.join();
+    }
+}
+
+const std::shared_ptr<vfs::preview>
+vfs::preview::create(const callback_t& callback) noexcept
+{
+    return std::make_shared<vfs::preview>(callback);
+}
+
+void
+vfs::preview::request(const std::shared_ptr<vfs::file>& file, i32 size) noexcept
+{
+    job job;
+    // the running decoder sees the new generation and stops early
+    job.generation = this->generation_.fetch_add(1) + 1;
+    job.file = file;
+    job.mime_type = file->mime_type()->type();
+    job.file_size = file->size();
+    job.mtime = file->mtime();
+    job.uri = file->uri();
+    job.size = size;
+
+    {
+        const std::scoped_lock<std::mutex> lock(this->lock_);
+        this->pending_ = std::move(job);
+    }
+    this->cond_.notify_one();
+}
+
+void
+vfs::preview::cancel() noexcept
+{
+    this->generation_ += 1;
+
+    const std::scoped_lock<std::mutex> lock(this->lock_);
+    this->pending_ = std::nullopt;
+}
+
+bool
+vfs::preview::is_current(u64 generation) const noexcept
+{
+    return this->generation_ == generation;
+}
+
+void
+vfs::preview::worker_thread(const std::stop_token& stop_token) noexcept
+{
+    while (!stop_token.stop_requested())
+    {
+        job job;
+        {
+            std::unique_lock<std::mutex> lock(this->lock_);
+            if (!this->cond_.wait(lock, stop_token, [this] { return this->pending_.has_value(); }))
+            {
+                break;
+            }
+            job = std::move(*this->pending_);
+            this->pending_ = std::nullopt;
+        }
+
+        if (!this->is_current(job.generation))
+        {
+            continue;
+        }
+
+        auto result = std::make_unique<vfs::preview::result>();
+        result->path = job.file->path();
+
+        if (job.mime_type.starts_with("image/"))
+        {
+            this->decode_image(job, *result);
+        }
+        else if (job.mime_type.starts_with("video/"))
+        {
+            this->decode_video(job, *result);
+        }
+        else if (mime_type_is_text_file(result->path, job.mime_type))
+        {
+            this->decode_text(job, *result);
+        }
+
+        if (!this->is_current(job.generation))
+        {
+            continue;
+        }
+
+        g_idle_add(
+            [](void* user_data) -> gboolean
+            {
+                auto* data = static_cast<delivery*>(user_data);
+                const auto self = data->preview.lock();
+                if (self && self->is_current(data->generation) && self->callback_)
+                {
+                    self->callback_(*data->result);
+                }
+                delete data;
+                return G_SOURCE_REMOVE;
+            },
+            new delivery{this->weak_from_this(), job.generation, std::move(result)});
+    }
+}
+
+void
+vfs::preview::decode_text(const job& job, vfs::preview::result& result) const noexcept
+{
+    const i32 fd = open(result.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        ztd::logger::debug("preview: failed to open {}: {}",
+                           result.path.string(),
+                           std::strerror(errno));
+        return;
+    }
+
+    std::string data(MAX_TEXT_BYTES, '\0');
+    usize length = 0;
+    while (length < data.size() && this->is_current(job.generation))
+    {
+        const auto ret = read(fd, data.data() + length, data.size() - length);
+        if (ret == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ret <= 0)
+        {
+            break;
+        }
+        length += ret;
+    }
+    close(fd);
+
+    data.resize(length);
+    result.truncated = job.file_size > length;
+
+    // a chunk can end inside a multibyte character, make_valid replaces it
+    std::ranges::replace(data, '\0', ' ');
+    char* valid = g_utf8_make_valid(data.data(), static_cast<gssize>(data.size()));
+    result.text = valid;
+    g_free(valid);
+}
+
+void
+vfs::preview::decode_image(const job& job, vfs::preview::result& result) const noexcept
+{
+    if (job.file_size > MAX_IMAGE_BYTES)
+    {
+        return;
+    }
+
+    const i32 fd = open(result.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        ztd::logger::debug("preview: failed to open {}: {}",
+                           result.path.string(),
+                           std::strerror(errno));
+        return;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + TIME_BUDGET;
+
+    image_size size;
+    size.size = job.size;
+    GdkPixbufLoader* loader = gdk_pixbuf_loader_new();
+    g_signal_connect(G_OBJECT(loader), "size-prepared", G_CALLBACK(on_size_prepared), &size);
+
+    std::vector<u8> buffer(READ_SIZE);
+    u64 total = 0;
+    bool ok = true;
+    while (true)
+    {
+        if (!this->is_current(job.generation) || std::chrono::steady_clock::now() > deadline ||
+            total > MAX_IMAGE_BYTES)
+        {
+            ok = false;
+            break;
+        }
+
+        const auto length = read(fd, buffer.data(), buffer.size());
+        if (length == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (length <= 0)
+        {
+            ok = length == 0;
+            break;
+        }
+        total += length;
+
+        if (!gdk_pixbuf_loader_write(loader, buffer.data(), length, nullptr))
+        {
+            ok = false;
+            break;
+        }
+    }
+    close(fd);
+
+    // close also has to be called when giving up, the error is expected then
+    if (!gdk_pixbuf_loader_close(loader, nullptr))
+    {
+        ok = false;
+    }
+
+    if (ok)
+    {
+        GdkPixbuf* pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
+        if (pixbuf)
+        {
+            // new reference, rotated if the image has an orientation tag
+            result.pixbuf = gdk_pixbuf_apply_embedded_orientation(pixbuf);
+        }
+    }
+    g_object_unref(loader);
+
+    if (size.width > 0 && size.height > 0)
+    {
+        result.info = fmt::format("{} x {} pixels", size.width, size.height);
+    }
+}
+
+void
+vfs::preview::decode_video(const job& job, vfs::preview::result& result) const noexcept
+{
+    // the same cache the file list uses, other programs fill it too
+    const auto filename =
+        fmt::format("{}.png", ztd::compute_checksum(ztd::checksum::type::md5, job.uri));
+    const auto cache_dir = vfs::user_dirs->cache_dir() / "thumbnails";
+    const auto large_file = cache_dir / "large" / filename;
+
+    GdkPixbuf* thumbnail = load_cached_thumbnail(large_file, job.mtime);
+    if (!thumbnail && job.size <= NORMAL_THUMBNAIL_SIZE)
+    {
+        thumbnail = load_cached_thumbnail(cache_dir / "normal" / filename, job.mtime);
+    }
+    if (!thumbnail)
+    {
+        const auto is_current = [this, &job] { return this->is_current(job.generation); };
+        if (!create_thumbnail(result.path, large_file, is_current))
+        {
+            return;
+        }
+        thumbnail = load_cached_thumbnail(large_file, job.mtime);
+        if (!thumbnail)
+        {
+            return;
+        }
+    }
+
+    const i32 width = gdk_pixbuf_get_width(thumbnail);
+    const i32 height = gdk_pixbuf_get_height(thumbnail);
+    if (width <= job.size && height <= job.size)
+    {
+        result.pixbuf = thumbnail;
+        return;
+    }
+
+    if (width > height)
+    {
+        result.pixbuf = gdk_pixbuf_scale_simple(thumbnail,
+                                                job.size,
+                                                std::max(1, height * job.size / width),
+                                                GdkInterpType::GDK_INTERP_BILINEAR);
+    }
+    else
+    {
+        result.pixbuf = gdk_pixbuf_scale_simple(thumbnail,
+                                                std::max(1, width * job.size / height),
+                                                job.size,
+                                                GdkInterpType::GDK_INTERP_BILINEAR);
+    }
+    g_object_unref(thumbnail);
+}
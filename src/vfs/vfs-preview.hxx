@@ -0,0 +1,111 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <filesystem>
+
+#include <ctime>
+
+#include <optional>
+
+#include <memory>
+
+#include <functional>
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+
+#include <gtkmm.h>
+
+#include <ztd/ztd.hxx>
+
+#include "vfs/vfs-file.hxx"
+
+namespace vfs
+{
+    // Decodes the preview of one file at a time on its own thread. A new
+    // request supersedes the one being decoded, the decoder checks for this
+    // between chunks and also gives up once its byte or time budget is spent.
+    // Only the result of the latest request reaches the callback.
+    struct preview : public std::enable_shared_from_this<preview>
+    {
+        struct result
+        {
+            std::filesystem::path path{};
+            // first bytes of a text file, always valid UTF-8
+            std::string text{};
+            bool truncated{false};
+            // downscaled image or media thumbnail, owned by the result
+            GdkPixbuf* pixbuf{nullptr};
+            // format details found while decoding, e.g. image dimensions
+            std::string info{};
+
+            result() = default;
+            ~result();
+            result(const result& other) = delete;
+            result& operator=(const result& other) = delete;
+        };
+
+        // called in the main loop thread
+        using callback_t = std::function<void(const vfs::preview::result& result)>;
+
+        preview() = delete;
+        preview(const callback_t& callback) noexcept;
+        ~preview();
+        preview(const preview& other) = delete;
+        preview& operator=(const preview& other) = delete;
+
+        static const std::shared_ptr<vfs::preview> create(const callback_t& callback) noexcept;
+
+        // main loop thread only, size is the largest image width or height
+        void request(const std::shared_ptr<vfs::file>& file, i32 size) noexcept;
+        void cancel() noexcept;
+
+      private:
+        struct job
+        {
+            u64 generation{0};
+            std::shared_ptr<vfs::file> file{nullptr};
+            std::string mime_type{};
+            u64 file_size{0};
+            std::time_t mtime{0};
+            std::string uri{};
+            i32 size{0};
+        };
+
+        void worker_thread(const std::stop_token& stop_token) noexcept;
+        [[nodiscard]] bool is_current(u64 generation) const noexcept;
+
+        void decode_text(const job& job, vfs::preview::result& result) const noexcept;
+        void decode_image(const job& job, vfs::preview::result& result) const noexcept;
+        void decode_video(const job& job, vfs::preview::result& result) const noexcept;
+
+        callback_t callback_{nullptr};
+
+        std::atomic<u64> generation_{0};
+
+        std::mutex lock_;
+        std::condition_variable_any cond_;
+        std::optional<job> pending_{std::nullopt};
+
+        std::jthread thread_;
+    };
+} // namespace vfs
@@ -0,0 +1,183 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <string_view>
+
+#include <vector>
+
+#include <memory>
+#include <new>
+
+#include <atomic>
+#include <mutex>
+
+#include <algorithm>
+#include <ranges>
+
+#include <bit>
+
+#include <ztd/ztd.hxx>
+
+#include "vfs/vfs-task-log.hxx"
+
+// bounded MPMC queue, Dmitry Vyukov's design. Each cell sequence tells
+// producers and the consumer whose turn it is to use the cell.
+
+vfs::task_log::task_log(usize capacity, usize max_bytes) noexcept
+{
+    capacity = std::bit_ceil(std::max(capacity, usize(2)));
+    this->mask_ = capacity - 1;
+    this->max_bytes_ = max_bytes;
+    this->cells_ = std::make_unique<cell[]>(capacity);
+    for (const auto i : std::views::iota(0uz, capacity))
+    {
+        this->cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool
+vfs::task_log::push(const vfs::task_log::level level, const std::string_view msg) noexcept
+{
+    const usize size = msg.size();
+    if (this->bytes_.fetch_add(size, std::memory_order_relaxed) + size > this->max_bytes_)
+    {
+        this->bytes_.fetch_sub(size, std::memory_order_relaxed);
+        this->dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // copied before a cell is claimed, a claimed cell has to be published
+    std::string text;
+    try
+    {
+        text = msg;
+    }
+    catch (const std::bad_alloc&)
+    {
+        this->bytes_.fetch_sub(size, std::memory_order_relaxed);
+        this->dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    cell* c = nullptr;
+    usize pos = this->enqueue_pos_.load(std::memory_order_relaxed);
+    while (true)
+    {
+        c = &this->cells_[pos & this->mask_];
+        const usize seq = c->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<isize>(seq) - static_cast<isize>(pos);
+        if (diff == 0)
+        {
+            if (this->enqueue_pos_.compare_exchange_weak(pos,
+                                                         pos + 1,
+                                                         std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // full
+            this->bytes_.fetch_sub(size, std::memory_order_relaxed);
+            this->dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            pos = this->enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    c->data.level = level;
+    c->data.msg = std::move(text);
+    c->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void
+vfs::task_log::push_notice(const vfs::task_log::level level, const std::string_view msg) noexcept
+{
+    const std::scoped_lock<std::mutex> lock(this->notice_lock_);
+    try
+    {
+        this->notices_.push_back({level, std::string(msg)});
+    }
+    catch (const std::bad_alloc&)
+    {
+        this->dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    this->has_notices_.store(true, std::memory_order_release);
+}
+
+usize
+vfs::task_log::drain(std::vector<vfs::task_log::record>& records) noexcept
+{
+    usize count = 0;
+    usize pos = this->dequeue_pos_.load(std::memory_order_relaxed);
+    while (true)
+    {
+        cell* c = &this->cells_[pos & this->mask_];
+        const usize seq = c->sequence.load(std::memory_order_acquire);
+        if (seq != pos + 1)
+        {
+            // empty, or the producer has not finished writing this cell
+            break;
+        }
+
+        this->bytes_.fetch_sub(c->data.msg.size(), std::memory_order_relaxed);
+        records.push_back(std::move(c->data));
+        c->data = {};
+        c->sequence.store(pos + this->mask_ + 1, std::memory_order_release);
+
+        pos += 1;
+        count += 1;
+    }
+    this->dequeue_pos_.store(pos, std::memory_order_relaxed);
+
+    if (this->has_notices_.load(std::memory_order_acquire))
+    {
+        const std::scoped_lock<std::mutex> lock(this->notice_lock_);
+        count += this->notices_.size();
+        records.insert(records.cend(),
+                       std::make_move_iterator(this->notices_.begin()),
+                       std::make_move_iterator(this->notices_.end()));
+        this->notices_.clear();
+        this->has_notices_.store(false, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+u64
+vfs::task_log::take_dropped() noexcept
+{
+    return this->dropped_.exchange(0, std::memory_order_relaxed);
+}
+
+usize
+vfs::task_log::max_bytes() const noexcept
+{
+    return this->max_bytes_;
+}
+
+bool
+vfs::task_log::empty() const noexcept
+{
+    const usize pos = this->dequeue_pos_.load(std::memory_order_relaxed);
+    const usize seq = this->cells_[pos & this->mask_].sequence.load(std::memory_order_acquire);
+    return seq != pos + 1 && this->dropped_.load(std::memory_order_relaxed) == 0 &&
+           !this->has_notices_.load(std::memory_order_acquire);
+}
@@ -0,0 +1,95 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <vector>
+
+#include <memory>
+
+#include <atomic>
+#include <mutex>
+
+#include <ztd/ztd.hxx>
+
+namespace vfs
+{
+    // Bounded log for a file task. Any thread can append without taking a lock,
+    // the GTK thread drains all pending records in one batch. When the record
+    // count or the byte budget is exhausted new records are dropped and counted.
+    struct task_log
+    {
+        enum class level
+        {
+            info,
+            error,
+            output, // exec stdout/stderr
+        };
+
+        struct record
+        {
+            vfs::task_log::level level{vfs::task_log::level::info};
+            std::string msg{};
+        };
+
+        task_log() = delete;
+        // capacity is rounded up to a power of two
+        task_log(usize capacity, usize max_bytes) noexcept;
+        ~task_log() = default;
+        task_log(const task_log& other) = delete;
+        task_log& operator=(const task_log& other) = delete;
+
+        // producers, any thread. returns false if the record was dropped,
+        // also when its copy could not be allocated
+        bool push(const vfs::task_log::level level, const std::string_view msg) noexcept;
+        // producers, any thread. not bound by the capacity, only for the few
+        // messages that tell where dropped or redirected output went
+        void push_notice(const vfs::task_log::level level, const std::string_view msg) noexcept;
+
+        // single consumer, appends all pending records to records, notices last
+        usize drain(std::vector<vfs::task_log::record>& records) noexcept;
+
+        // number of records dropped since the last call
+        u64 take_dropped() noexcept;
+
+        [[nodiscard]] bool empty() const noexcept;
+
+        // bytes the pending records may take up at once
+        [[nodiscard]] usize max_bytes() const noexcept;
+
+      private:
+        struct cell
+        {
+            std::atomic<usize> sequence{0};
+            vfs::task_log::record data{};
+        };
+
+        usize mask_{0};
+        usize max_bytes_{0};
+        std::unique_ptr<cell[]> cells_{nullptr};
+
+        alignas(64) std::atomic<usize> enqueue_pos_{0};
+        alignas(64) std::atomic<usize> dequeue_pos_{0};
+        alignas(64) std::atomic<usize> bytes_{0};
+        std::atomic<u64> dropped_{0};
+
+        std::mutex notice_lock_;
+        std::vector<vfs::task_log::record> notices_{};
+        std::atomic<bool> has_notices_{false};
+    };
+} // namespace vfs
@@ -0,0 +1,221 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+#include <functional>
+
+#include <atomic>
+#include <mutex>
+
+#include <chrono>
+
+#include <cstdint>
+
+#include <glibmm.h>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "settings/app.hxx"
+
+#include "vfs/vfs-file.hxx"
+
+#include "vfs/vfs-thumbnail-store.hxx"
+
+namespace
+{
+    struct entry
+    {
+        std::uintptr_t key{0};
+        std::weak_ptr<vfs::file> file{};
+        bool big{false};
+        usize bytes{0};
+        std::chrono::steady_clock::time_point shown{};
+    };
+
+    // newest first
+    using lru_t = std::list<entry>;
+
+    std::mutex store_lock;
+    lru_t lru;
+    std::unordered_map<std::uintptr_t, lru_t::iterator> lru_index;
+    usize total_bytes{0};
+
+    std::atomic<bool> trim_queued{false};
+
+    // main loop thread only
+    std::unordered_map<const void*, vfs::thumbnail_store::visible_callback_t> visible_callbacks;
+
+    std::uintptr_t
+    make_key(const vfs::file* file, bool big) noexcept
+    {
+        // vfs::file is at least pointer aligned, the low bit is free
+        return reinterpret_cast<std::uintptr_t>(file) | (big ? 1 : 0);
+    }
+
+    void
+    queue_trim() noexcept
+    {
+        if (trim_queued.exchange(true))
+        {
+            return;
+        }
+
+        g_idle_add_full(
+            G_PRIORITY_LOW,
+            [](void* user_data) -> gboolean
+            {
+                (void)user_data;
+                trim_queued = false;
+                vfs::thumbnail_store::trim();
+                return G_SOURCE_REMOVE;
+            },
+            nullptr,
+            nullptr);
+    }
+} // namespace
+
+void
+vfs::thumbnail_store::add(const std::shared_ptr<vfs::file>& file, bool big, usize bytes) noexcept
+{
+    bool over_budget = false;
+    {
+        const std::scoped_lock<std::mutex> lock(store_lock);
+
+        const auto key = make_key(file.get(), big);
+        const auto it = lru_index.find(key);
+        if (it != lru_index.cend())
+        {
+            total_bytes -= it->second->bytes;
+            lru.erase(it->second);
+        }
+
+        lru.push_front({key, file, big, bytes, std::chrono::steady_clock::now()});
+        lru_index.insert_or_assign(key, lru.begin());
+        total_bytes += bytes;
+
+        over_budget = total_bytes > app_settings.thumbnail_cache_size();
+    }
+
+    if (over_budget)
+    {
+        queue_trim();
+    }
+}
+
+void
+vfs::thumbnail_store::touch(const vfs::file* file, bool big) noexcept
+{
+    const std::scoped_lock<std::mutex> lock(store_lock);
+
+    const auto it = lru_index.find(make_key(file, big));
+    if (it == lru_index.cend())
+    {
+        return;
+    }
+    it->second->shown = std::chrono::steady_clock::now();
+    if (it->second != lru.begin())
+    {
+        lru.splice(lru.begin(), lru, it->second);
+    }
+}
+
+void
+vfs::thumbnail_store::remove(const vfs::file* file, bool big) noexcept
+{
+    const std::scoped_lock<std::mutex> lock(store_lock);
+
+    const auto it = lru_index.find(make_key(file, big));
+    if (it != lru_index.cend())
+    {
+        total_bytes -= it->second->bytes;
+        lru.erase(it->second);
+        lru_index.erase(it);
+    }
+}
+
+void
+vfs::thumbnail_store::add_visible_callback(const void* owner,
+                                           const visible_callback_t& callback) noexcept
+{
+    visible_callbacks.insert_or_assign(owner, callback);
+}
+
+void
+vfs::thumbnail_store::remove_visible_callback(const void* owner) noexcept
+{
+    visible_callbacks.erase(owner);
+}
+
+void
+vfs::thumbnail_store::trim() noexcept
+{
+    // everything touched from here on is on screen
+    const auto visible_since = std::chrono::steady_clock::now();
+    for (const auto& [owner, callback] : visible_callbacks)
+    {
+        callback();
+    }
+
+    std::vector<std::pair<std::shared_ptr<vfs::file>, bool>> evict;
+    {
+        const std::scoped_lock<std::mutex> lock(store_lock);
+
+        const usize budget = app_settings.thumbnail_cache_size();
+        while (total_bytes > budget && !lru.empty())
+        {
+            const auto& oldest = lru.back();
+            if (oldest.shown >= visible_since)
+            {
+                // newest first, the rest is on screen as well
+                break;
+            }
+
+            auto file = oldest.file.lock();
+            if (file)
+            {
+                evict.emplace_back(std::move(file), oldest.big);
+            }
+
+            total_bytes -= oldest.bytes;
+            lru_index.erase(oldest.key);
+            lru.pop_back();
+        }
+    }
+
+    // unload without holding the lock, unloading calls remove()
+    for (const auto& [file, big] : evict)
+    {
+        file->evict_thumbnail(big);
+    }
+
+    if (!evict.empty())
+    {
+        ztd::logger::debug("thumbnail store: evicted {} thumbnails", evict.size());
+    }
+}
+
+usize
+vfs::thumbnail_store::size() noexcept
+{
+    const std::scoped_lock<std::mutex> lock(store_lock);
+
+    return total_bytes;
+}
@@ -0,0 +1,58 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <functional>
+
+#include <ztd/ztd.hxx>
+
+namespace vfs
+{
+    struct file;
+}
+
+// Process wide accounting of loaded thumbnails. Every thumbnail that was
+// decoded for a vfs::file is registered here with its pixbuf size. Once
+// the total is over app_settings.thumbnail_cache_size() the least recently
+// shown thumbnails are unloaded from their files, the file list requests
+// them again from the on-disk thumbnail cache when they are shown.
+// Thumbnails of rows that are on screen are never unloaded, even when that
+// goes over the budget, otherwise a view showing more than the budget would
+// unload and reload in a loop. Views report those rows through a callback.
+namespace vfs::thumbnail_store
+{
+    // any thread, a trim is queued in the main loop when over budget
+    void add(const std::shared_ptr<vfs::file>& file, bool big, usize bytes) noexcept;
+
+    // any thread, mark as recently shown
+    void touch(const vfs::file* file, bool big) noexcept;
+
+    // any thread, the thumbnail was unloaded by its file
+    void remove(const vfs::file* file, bool big) noexcept;
+
+    // main loop thread only, called at the start of every trim, it has to
+    // touch() the thumbnails of all rows that owner shows on screen
+    using visible_callback_t = std::function<void()>;
+    void add_visible_callback(const void* owner, const visible_callback_t& callback) noexcept;
+    void remove_visible_callback(const void* owner) noexcept;
+
+    // main loop thread only
+    void trim() noexcept;
+
+    [[nodiscard]] usize size() noexcept;
+} // namespace vfs::thumbnail_store
@@ -24,12 +24,17 @@
 
 #include <chrono>
 
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <ztd/ztd.hxx>
 #include <ztd/ztd_logger.hxx>
 
-#include "write.hxx"
-
 #include "vfs/vfs-user-dirs.hxx"
+#include "vfs/vfs-unique-name.hxx"
 
 #include "vfs/vfs-trash-can.hxx"
 
@@ -144,8 +149,24 @@ vfs::trash_can::trash(const std::filesystem::path& path) noexcept
 
     trash_dir->create_trash_dir();
 
-    const std::string target_name = trash_dir->unique_name(path);
-    trash_dir->create_trash_info(path, target_name);
+    std::string target_name;
+    while (true)
+    {
+        target_name = trash_dir->unique_name(path);
+        const i32 result = trash_dir->create_trash_info(path, target_name);
+        if (result == 0)
+        {
+            break;
+        }
+        if (result != EEXIST)
+        {
+            ztd::logger::error("Failed to create trash info for {}: {}",
+                               path.string(),
+                               std::strerror(result));
+            return false;
+        }
+        // another process trashed a file with the same name
+    }
     trash_dir->move(path, target_name);
 
     // ztd::logger::info("moved to trash: {}", path);
@@ -188,30 +209,21 @@ vfs::trash_can::trash_dir::trash_dir(const std::filesystem::path& path) noexcept
 const std::string
 vfs::trash_can::trash_dir::unique_name(const std::filesystem::path& path) const noexcept
 {
-    const std::string filename = path.filename();
-    const std::string basename = path.stem();
-    const std::string ext = path.extension();
-
-    std::string to_trash_filename = filename;
-    const std::string to_trash_path = this->files_path_ / to_trash_filename;
-
-    if (!std::filesystem::exists(to_trash_path))
-    {
-        return to_trash_filename;
-    }
-
-    for (usize i = 1; true; ++i)
+    // "foo." has the extension ".", it stays part of the name
+    std::string basename = path.filename();
+    std::string ext;
+    const std::string extension = path.extension();
+    if (extension.size() > 1)
     {
-        const std::string check_to_trash_filename = fmt::format("{}_{}{}", basename, i, ext);
-        const auto check_to_trash_path = this->files_path_ / check_to_trash_filename;
-        if (!std::filesystem::exists(check_to_trash_path))
-        {
-            to_trash_filename = check_to_trash_filename;
-            break;
-        }
+        basename = path.stem();
+        ext = extension.substr(1);
     }
 
-    return to_trash_filename;
+    const auto unique_path = vfs::unique_name::get(this->files_path_,
+                                                   basename,
+                                                   ext,
+                                                   vfs::unique_name::style::underscore);
+    return unique_path.filename();
 }
 
 void
@@ -258,7 +270,7 @@ vfs::trash_can::trash_dir::create_trash_date(const std::time_t time) const noexc
     /* return fmt::format("{0:%Y-%m-%d}T{:2d}:{:2d}:{:2d}", date, hours.count(), minutes.count(), seconds.count()); */
 }
 
-void
+i32
 vfs::trash_can::trash_dir::create_trash_info(const std::filesystem::path& path,
                                              const std::string_view target_name) const noexcept
 {
@@ -270,7 +282,24 @@ vfs::trash_can::trash_dir::create_trash_info(const std::filesystem::path& path,
     const std::string trash_info_content =
         fmt::format("[Trash Info]\nPath={}\nDeletionDate={}\n", path.string(), iso_time);
 
-    write_file(trash_info, trash_info_content);
+    const i32 fd = open(trash_info.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd == -1)
+    {
+        return errno;
+    }
+
+    i32 result = 0;
+    const auto length = write(fd, trash_info_content.data(), trash_info_content.size());
+    if (length == -1)
+    {
+        result = errno;
+    }
+    else if (length != static_cast<isize>(trash_info_content.size()))
+    {
+        result = EIO;
+    }
+    close(fd);
+    return result;
 }
 
 void
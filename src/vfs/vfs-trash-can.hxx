@@ -69,9 +69,11 @@ namespace vfs
 
             void create_trash_dir() const noexcept;
 
-            // Create a .trashinfo file for a file or directory 'path'
-            void create_trash_info(const std::filesystem::path& path,
-                                   const std::string_view target_name) const noexcept;
+            // Create a .trashinfo file for a file or directory 'path'.
+            // The file is created with O_EXCL, this is what reserves target_name.
+            // Returns 0 on success, otherwise errno, EEXIST if target_name is taken.
+            i32 create_trash_info(const std::filesystem::path& path,
+                                  const std::string_view target_name) const noexcept;
 
             // Move a file or directory into the trash directory
             void move(const std::filesystem::path& path,
@@ -0,0 +1,223 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <string_view>
+
+#include <fmt/core.h>
+
+#include <filesystem>
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <algorithm>
+
+#include <chrono>
+
+#include <mutex>
+
+#include <magic_enum.hpp>
+
+#include <ztd/ztd.hxx>
+#include <ztd/ztd_logger.hxx>
+
+#include "vfs/vfs-unique-name.hxx"
+
+namespace
+{
+    // the name set is only a hint, every returned name is checked on disk,
+    // so a short lifetime is enough to cover a single paste or trash operation
+    constexpr std::chrono::seconds CACHE_TIMEOUT{10};
+    constexpr usize CACHE_MAX_DIRS{16};
+
+    struct dir_names
+    {
+        std::unordered_set<std::string> names{};
+        // next number to try for a base name, ext and style
+        std::unordered_map<std::string, u64> next{};
+        std::chrono::steady_clock::time_point loaded{};
+    };
+
+    std::mutex cache_lock;
+    std::unordered_map<std::string, dir_names> cache;
+
+    dir_names&
+    get_dir_names(const std::filesystem::path& dir) noexcept
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        const auto it = cache.find(dir.string());
+        if (it != cache.cend() && now - it->second.loaded < CACHE_TIMEOUT)
+        {
+            return it->second;
+        }
+
+        if (cache.size() >= CACHE_MAX_DIRS)
+        {
+            std::erase_if(cache,
+                          [now](const auto& item)
+                          { return now - item.second.loaded >= CACHE_TIMEOUT; });
+        }
+        if (cache.size() >= CACHE_MAX_DIRS)
+        {
+            const auto oldest = std::ranges::min_element(
+                cache,
+                [](const auto& a, const auto& b) { return a.second.loaded < b.second.loaded; });
+            cache.erase(oldest);
+        }
+
+        // one pass over the directory instead of a stat for every candidate
+        dir_names entry;
+        entry.loaded = now;
+        std::error_code ec;
+        for (const auto& file : std::filesystem::directory_iterator(dir, ec))
+        {
+            entry.names.insert(file.path().filename());
+        }
+
+        return cache.insert_or_assign(dir.string(), std::move(entry)).first->second;
+    }
+
+    const std::string
+    make_name(const std::string_view base_name, const std::string_view ext,
+              const vfs::unique_name::style style, u64 n) noexcept
+    {
+        std::string name;
+        if (n == 0)
+        {
+            name = base_name;
+        }
+        else
+        {
+            switch (style)
+            {
+                case vfs::unique_name::style::copy:
+                    name = fmt::format("{}-copy{}", base_name, n);
+                    break;
+                case vfs::unique_name::style::number:
+                    name = fmt::format("{}{}", base_name, n);
+                    break;
+                case vfs::unique_name::style::underscore:
+                    name = fmt::format("{}_{}", base_name, n);
+                    break;
+            }
+        }
+
+        if (ext.empty())
+        {
+            return name;
+        }
+        return fmt::format("{}.{}", name, ext);
+    }
+
+    u64
+    first_number(const vfs::unique_name::style style) noexcept
+    {
+        switch (style)
+        {
+            case vfs::unique_name::style::copy:
+            case vfs::unique_name::style::number:
+                return 2;
+            case vfs::unique_name::style::underscore:
+                return 1;
+        }
+        return 1;
+    }
+} // namespace
+
+const std::filesystem::path
+vfs::unique_name::get(const std::filesystem::path& dir, const std::string_view base_name,
+                      const std::string_view ext, const style style, bool reserve)
+{
+    const std::scoped_lock<std::mutex> lock(cache_lock);
+
+    auto& entry = get_dir_names(dir);
+
+    const auto is_free = [&entry, &dir](const std::string& name)
+    {
+        if (entry.names.contains(name))
+        {
+            return false;
+        }
+        // created since the names were read, need to see broken symlinks
+        if (ztd::statx(dir / name, ztd::statx::symlink::no_follow))
+        {
+            entry.names.insert(name);
+            return false;
+        }
+        return true;
+    };
+
+    const auto name = make_name(base_name, ext, style, 0);
+    if (is_free(name))
+    {
+        if (reserve)
+        {
+            entry.names.insert(name);
+        }
+        return dir / name;
+    }
+
+    const auto key = fmt::format("{}/{}/{}", base_name, ext, magic_enum::enum_integer(style));
+    const auto next = entry.next.find(key);
+    u64 n = (next != entry.next.cend()) ? next->second : first_number(style);
+
+    std::string new_name;
+    while (true)
+    {
+        new_name = make_name(base_name, ext, style, n);
+        if (is_free(new_name))
+        {
+            break;
+        }
+        n += 1;
+    }
+
+    if (reserve)
+    {
+        entry.names.insert(new_name);
+        entry.next.insert_or_assign(key, n + 1);
+    }
+    else
+    {
+        entry.next.insert_or_assign(key, n);
+    }
+
+    return dir / new_name;
+}
+
+void
+vfs::unique_name::invalidate(const std::filesystem::path& dir)
+{
+    const std::scoped_lock<std::mutex> lock(cache_lock);
+
+    cache.erase(dir.string());
+}
+
+void
+vfs::unique_name::release(const std::filesystem::path& path)
+{
+    const std::scoped_lock<std::mutex> lock(cache_lock);
+
+    const auto it = cache.find(path.parent_path().string());
+    if (it == cache.cend())
+    {
+        return;
+    }
+    it->second.names.erase(path.filename());
+    // numbering starts over, lower numbers are found in the name set without disk access
+    it->second.next.clear();
+}
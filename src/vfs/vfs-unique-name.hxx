@@ -0,0 +1,50 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string_view>
+
+#include <filesystem>
+
+#include <ztd/ztd.hxx>
+
+// Find a free filename in a directory without probing every candidate on disk.
+// The names in a directory are read once and kept for a short time, repeated
+// requests for the same name continue from the last number handed out.
+// The returned name is only free at the time of the call, callers that create
+// the file must still use O_EXCL or RENAME_NOREPLACE.
+namespace vfs::unique_name
+{
+    enum class style
+    {
+        copy,       // name-copy2.ext, name-copy3.ext, used for paste
+        number,     // name2.ext, name3.ext, used for new files
+        underscore, // name_1.ext, name_2.ext, used for the trash
+    };
+
+    // base_name is returned unchanged when it is free.
+    // reserve: the name is remembered as taken before the file exists, use
+    // false when the name is only a suggestion shown to the user.
+    const std::filesystem::path get(const std::filesystem::path& dir,
+                                    const std::string_view base_name, const std::string_view ext,
+                                    const style style = style::copy, bool reserve = true);
+
+    // the names in dir changed in a way the cache cannot see, e.g. files were removed
+    void invalidate(const std::filesystem::path& dir);
+
+    // path was removed or renamed, its name can be handed out again
+    void release(const std::filesystem::path& path);
+} // namespace vfs::unique_name
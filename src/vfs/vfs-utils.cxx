@@ -22,6 +22,10 @@
 
 #include <filesystem>
 
+#include <cstdio>
+
+#include <fcntl.h>
+
 #include <ztd/ztd.hxx>
 #include <ztd/ztd_logger.hxx>
 
@@ -74,36 +78,29 @@ vfs_file_size_format(u64 size_in_bytes, bool decimal)
     }
 }
 
-const std::filesystem::path
-vfs_get_unique_name(const std::filesystem::path& dest_dir, const std::string_view base_name,
-                    const std::string_view ext)
-{ // returns nullptr if all names used; otherwise newly allocated string
-    std::string new_name;
-    if (ext.empty())
+i32
+vfs_rename_noreplace(const std::filesystem::path& src, const std::filesystem::path& dest)
+{
+    if (renameat2(AT_FDCWD, src.c_str(), AT_FDCWD, dest.c_str(), RENAME_NOREPLACE) == 0)
     {
-        new_name = base_name.data();
+        return 0;
     }
-    else
+
+    if (errno != EINVAL && errno != ENOSYS)
     {
-        new_name = fmt::format("{}.{}", base_name, ext);
+        return errno;
     }
 
-    auto new_dest_file = dest_dir / new_name;
-
-    u32 n = 1;
-    while (std::filesystem::exists(new_dest_file))
+    // filesystem does not support RENAME_NOREPLACE
+    std::error_code ec;
+    if (std::filesystem::exists(std::filesystem::symlink_status(dest, ec)))
     {
-        if (ext.empty())
-        {
-            new_name = fmt::format("{}-copy{}", base_name, ++n);
-        }
-        else
-        {
-            new_name = fmt::format("{}-copy{}.{}", base_name, ++n, ext);
-        }
-
-        new_dest_file = dest_dir / new_name;
+        return EEXIST;
     }
 
-    return new_dest_file;
+    if (rename(src.c_str(), dest.c_str()) == 0)
+    {
+        return 0;
+    }
+    return errno;
 }
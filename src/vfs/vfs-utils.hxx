@@ -58,6 +58,6 @@ GdkPixbuf* vfs_load_icon(const std::string_view icon_name, i32 icon_size);
 
 const std::string vfs_file_size_format(u64 size_in_bytes, bool decimal = true);
 
-const std::filesystem::path vfs_get_unique_name(const std::filesystem::path& dest_dir,
-                                                const std::string_view base_name,
-                                                const std::string_view ext);
+// rename() that never replaces an existing file, uses renameat2(RENAME_NOREPLACE)
+// when supported. Returns 0 on success, otherwise errno.
+i32 vfs_rename_noreplace(const std::filesystem::path& src, const std::filesystem::path& dest);
@@ -24,6 +24,7 @@
 #include <filesystem>
 
 #include <vector>
+#include <unordered_map>
 
 #include <optional>
 
@@ -52,7 +53,7 @@
 
 static const std::shared_ptr<vfs::volume> vfs_volume_read_by_device(const libudev::device& udevice);
 static void vfs_volume_device_removed(const libudev::device& udevice);
-static void call_callbacks(const std::shared_ptr<vfs::volume>& vol, const vfs::volume::state state);
+static void queue_publish();
 
 struct VFSVolumeCallbackData
 {
@@ -74,6 +75,75 @@ using volume_callback_data_t = std::shared_ptr<VFSVolumeCallbackData>;
 static std::vector<std::shared_ptr<vfs::volume>> volumes;
 static std::vector<volume_callback_data_t> callbacks;
 
+// device and mount events arriving within this time are published as one delta
+inline constexpr u32 VOLUME_BATCH_DELAY = 100; // ms
+
+struct VolumeSnapshotEntry
+{
+    std::shared_ptr<vfs::volume> volume{nullptr};
+    vfs::volume_info info{};
+};
+using volume_snapshot_t = std::unordered_map<const vfs::volume*, VolumeSnapshotEntry>;
+
+// the volumes as last published to the subscribers
+static volume_snapshot_t published_snapshot;
+
+static u32 publish_timer = 0;
+// the batch has udev events, open tabs may have become invalid
+static bool batch_udev_event = false;
+// mountinfo changed, it is only parsed once per batch
+static bool batch_mounts_changed = false;
+
+static const volume_snapshot_t
+take_snapshot()
+{
+    volume_snapshot_t snapshot;
+    snapshot.reserve(volumes.size());
+    for (const auto& volume : volumes)
+    {
+        if (!volume)
+        {
+            continue;
+        }
+
+        VolumeSnapshotEntry entry;
+        entry.volume = volume;
+        entry.info.display_name = volume->display_name();
+        entry.info.mount_point = volume->mount_point();
+        entry.info.icon = volume->icon();
+        entry.info.is_mounted = volume->is_mounted();
+        entry.info.is_mountable = volume->is_mountable();
+        entry.info.is_removable = volume->is_removable();
+        entry.info.is_user_visible = volume->is_user_visible();
+        snapshot.insert({volume.get(), std::move(entry)});
+    }
+    return snapshot;
+}
+
+static u8
+compare_volume_info(const vfs::volume_info& old, const vfs::volume_info& current)
+{
+    u8 changed = 0;
+    if (old.display_name != current.display_name)
+    {
+        changed |= VOLUME_CHANGED_NAME;
+    }
+    if (old.mount_point != current.mount_point || old.is_mounted != current.is_mounted)
+    {
+        changed |= VOLUME_CHANGED_MOUNT;
+    }
+    if (old.icon != current.icon)
+    {
+        changed |= VOLUME_CHANGED_ICON;
+    }
+    if (old.is_mounted != current.is_mounted || old.is_mountable != current.is_mountable ||
+        old.is_removable != current.is_removable || old.is_user_visible != current.is_user_visible)
+    {
+        changed |= VOLUME_CHANGED_VISIBLE;
+    }
+    return changed;
+}
+
 static libudev::udev udev;
 static libudev::monitor umonitor;
 
@@ -351,7 +421,8 @@ cb_mount_monitor_watch(Glib::IOCondition condition)
     }
 
     // ztd::logger::debug("@@@ {} changed", MOUNTINFO);
-    parse_mounts(true);
+    batch_mounts_changed = true;
+    queue_publish();
 
     return true;
 }
@@ -414,13 +485,20 @@ cb_udev_monitor_watch(Glib::IOCondition condition)
         else if (action == "remove")
         {
             vfs_volume_device_removed(udevice);
+
+            // add and change events carry a newer seqnum and reload on their own
+            const auto syspath = udevice.get_syspath();
+            if (syspath)
+            {
+                vfs::device::invalidate(syspath.value());
+            }
         }
         // what to do for move action?
 
-        // TOOD refresh
-        parse_mounts(true);
-
-        main_window_close_all_invalid_tabs();
+        // mounts are parsed and tabs refreshed once for the whole batch
+        batch_udev_event = true;
+        batch_mounts_changed = true;
+        queue_publish();
     }
 
     return true;
@@ -480,7 +558,10 @@ vfs_volume_device_removed(const libudev::device& udevice)
         { // remove volume
             // ztd::logger::debug("remove volume {}", volume->device_file);
             volumes.erase(std::remove(volumes.begin(), volumes.end(), volume), volumes.end());
-            call_callbacks(volume, vfs::volume::state::removed);
+            // a volume added since the last delta may already be shown, it has
+            // to be published as removed too before it is freed
+            published_snapshot.try_emplace(volume.get(), VolumeSnapshotEntry{volume, {}});
+            queue_publish();
             if (volume->is_mounted() && !volume->mount_point().empty())
             {
                 main_window_refresh_all_tabs_matching(volume->mount_point());
@@ -530,6 +611,14 @@ vfs_volume_init()
     // enumerate non-block
     parse_mounts(true);
 
+    // subscribers read the initial volumes themselves, only later changes are published
+    if (publish_timer != 0)
+    {
+        g_source_remove(publish_timer);
+        publish_timer = 0;
+    }
+    published_snapshot = take_snapshot();
+
     // start udev monitor
     const auto check_umonitor = udev.monitor_new_from_netlink("udev");
     if (!check_umonitor)
@@ -594,6 +683,13 @@ vfs_volume_finalize()
     uchannel = nullptr;
 #endif
 
+    if (publish_timer != 0)
+    {
+        g_source_remove(publish_timer);
+        publish_timer = 0;
+    }
+    published_snapshot.clear();
+
     // free all devmounts
     devmounts.clear();
 
@@ -629,12 +725,85 @@ vfs_volume_get_by_device(const std::string_view device_file)
 }
 
 static void
-call_callbacks(const std::shared_ptr<vfs::volume>& vol, const vfs::volume::state state)
+publish_delta()
 {
-    for (const auto& callback : callbacks)
+    volume_snapshot_t snapshot = take_snapshot();
+
+    const auto delta = std::make_shared<vfs::volume_delta>();
+    for (const auto& [key, current] : snapshot)
     {
-        callback->cb(vol, state, callback->user_data);
+        const auto old = published_snapshot.find(key);
+        if (old == published_snapshot.cend())
+        {
+            delta->entries.push_back({current.volume, vfs::volume::state::added, current.info, 0});
+            continue;
+        }
+
+        const u8 changed = compare_volume_info(old->second.info, current.info);
+        if (changed != 0)
+        {
+            delta->entries.push_back(
+                {current.volume, vfs::volume::state::changed, current.info, changed});
+        }
+    }
+    for (const auto& [key, old] : published_snapshot)
+    {
+        if (!snapshot.contains(key))
+        {
+            delta->entries.push_back({old.volume, vfs::volume::state::removed, old.info, 0});
+        }
+    }
+
+    published_snapshot = std::move(snapshot);
+
+    if (delta->entries.empty())
+    {
+        return;
+    }
+
+    // ztd::logger::debug("publish volume delta, {} entries", delta->entries.size());
+
+    // copied, a subscriber can remove its callback while being called
+    const auto subscribers = callbacks;
+    const std::shared_ptr<const vfs::volume_delta> published_delta = delta;
+    for (const auto& callback : subscribers)
+    {
+        callback->cb(published_delta, callback->user_data);
+    }
+}
+
+static bool
+on_publish_timer(void* user_data)
+{
+    (void)user_data;
+
+    // can update volumes, this timer is still set so that does not queue another batch
+    if (batch_mounts_changed)
+    {
+        batch_mounts_changed = false;
+        parse_mounts(true);
+    }
+
+    publish_timer = 0;
+    publish_delta();
+
+    if (batch_udev_event)
+    {
+        batch_udev_event = false;
+        main_window_close_all_invalid_tabs();
+    }
+
+    return false;
+}
+
+static void
+queue_publish()
+{
+    if (publish_timer != 0)
+    {
+        return;
     }
+    publish_timer = g_timeout_add(VOLUME_BATCH_DELAY, (GSourceFunc)on_publish_timer, nullptr);
 }
 
 void
@@ -954,7 +1123,7 @@ vfs::volume::device_added() noexcept
                 }
             }
 
-            call_callbacks(volume, vfs::volume::state::changed);
+            queue_publish();
 
             // refresh tabs containing changed mount point
             if (!changed_mount_point.empty())
@@ -970,7 +1139,7 @@ vfs::volume::device_added() noexcept
 
     // add as new volume
     volumes.emplace_back(this->shared_from_this());
-    call_callbacks(this->shared_from_this(), vfs::volume::state::added);
+    queue_publish();
 
     // refresh tabs containing changed mount point
     if (this->is_mounted() && !this->mount_point_.empty())
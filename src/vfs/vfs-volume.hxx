@@ -21,6 +21,8 @@
 #include <string>
 #include <string_view>
 
+#include <vector>
+
 #include <span>
 
 #include <optional>
@@ -30,9 +32,16 @@
 #include <ztd/ztd.hxx>
 #include <ztd/ztd_logger.hxx>
 
+// parts of a volume that differ between two volume snapshots
+inline constexpr u8 VOLUME_CHANGED_NAME = 0b0001;
+inline constexpr u8 VOLUME_CHANGED_MOUNT = 0b0010;
+inline constexpr u8 VOLUME_CHANGED_ICON = 0b0100;
+inline constexpr u8 VOLUME_CHANGED_VISIBLE = 0b1000;
+
 namespace vfs
 {
     struct device;
+    struct volume_delta;
 
     struct volume : public std::enable_shared_from_this<volume>
     {
@@ -61,8 +70,9 @@ namespace vfs
         static const std::shared_ptr<vfs::volume>
         create(const std::shared_ptr<vfs::device>& device) noexcept;
 
-        using callback_t = void (*)(const std::shared_ptr<vfs::volume>& volume,
-                                    const vfs::volume::state state, void* user_data);
+        // called once per batch of device and mount events
+        using callback_t =
+            void (*)(const std::shared_ptr<const vfs::volume_delta>& delta, void* user_data);
 
       public:
         const std::string_view display_name() const noexcept;
@@ -121,6 +131,37 @@ namespace vfs
 
         bool ever_mounted_{false};
     };
+
+    // What subscribers show of a volume, copied when a snapshot is taken.
+    struct volume_info
+    {
+        std::string display_name{};
+        std::string mount_point{};
+        std::string icon{};
+        bool is_mounted{false};
+        bool is_mountable{false};
+        bool is_removable{false};
+        bool is_user_visible{false};
+    };
+
+    // The volumes added, removed or changed since the previous snapshot. One
+    // delta is built per batch of udev and mountinfo events and the same
+    // read only delta is handed to every subscriber.
+    struct volume_delta
+    {
+        struct entry
+        {
+            // removed volumes are kept alive until all subscribers saw the delta
+            std::shared_ptr<vfs::volume> volume{nullptr};
+            vfs::volume::state state{vfs::volume::state::changed};
+            // the new info, or the last info of a removed volume
+            vfs::volume_info info{};
+            // VOLUME_CHANGED_* flags, only set for state::changed
+            u8 changed{0};
+        };
+
+        std::vector<entry> entries{};
+    };
 } // namespace vfs
 
 bool vfs_volume_init();
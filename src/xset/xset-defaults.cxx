@@ -1069,6 +1069,10 @@ xset_defaults()
     set->menu_style = xset::menu::check;
     set->b = xset::b::xtrue;
 
+    set = xset_get(xset::name::view_preview);
+    xset_set_var(set, xset::var::menu_label, "_Preview Pane (global)");
+    set->menu_style = xset::menu::check;
+
     set = xset_get(xset::name::view_sortby);
     xset_set_var(set, xset::var::menu_label, "_Sort");
     set->menu_style = xset::menu::submenu;
@@ -1225,11 +1229,16 @@ xset_defaults()
                          xset::name::separator,
                          xset::name::copy_to,
                          xset::name::move_to,
+                         xset::name::sync_to,
+                         xset::name::find_dups,
                          xset::name::edit_hide,
                          xset::name::separator,
                          xset::name::select_all,
                          xset::name::select_patt,
+                         xset::name::select_filter,
                          xset::name::select_invert,
+                         xset::name::select_compare,
+                         xset::name::select_compare_content,
                          xset::name::select_un,
                      });
     xset_set_var(set, xset::var::icn, "gtk-edit");
@@ -1400,6 +1409,34 @@ xset_defaults()
     xset_set(xset::name::move_panel_3, xset::var::menu_label, "Panel _3");
     xset_set(xset::name::move_panel_4, xset::var::menu_label, "Panel _4");
 
+    set = xset_get(xset::name::sync_to);
+    xset_set_var(set, xset::var::menu_label, "S_ync To");
+    set->menu_style = xset::menu::submenu;
+    xset_set_submenu(set,
+                     {
+                         xset::name::sync_panel_next,
+                         xset::name::sync_panel_mirror,
+                         xset::name::sync_panel_both,
+                         xset::name::separator,
+                         xset::name::sync_content,
+                     });
+
+    set = xset_get(xset::name::sync_panel_next);
+    xset_set_var(set, xset::var::menu_label, "_Update Next Panel");
+
+    set = xset_get(xset::name::sync_panel_mirror);
+    xset_set_var(set, xset::var::menu_label, "_Mirror To Next Panel");
+
+    set = xset_get(xset::name::sync_panel_both);
+    xset_set_var(set, xset::var::menu_label, "Sync _Both Panels");
+
+    set = xset_get(xset::name::sync_content);
+    xset_set_var(set, xset::var::menu_label, "Compare By _Content");
+    set->menu_style = xset::menu::check;
+
+    set = xset_get(xset::name::find_dups);
+    xset_set_var(set, xset::var::menu_label, "Find _Duplicates");
+
     set = xset_get(xset::name::edit_hide);
     xset_set_var(set, xset::var::menu_label, "_Hide");
 
@@ -1416,6 +1453,15 @@ xset_defaults()
     set = xset_get(xset::name::select_patt);
     xset_set_var(set, xset::var::menu_label, "S_elect By Pattern");
 
+    set = xset_get(xset::name::select_filter);
+    xset_set_var(set, xset::var::menu_label, "_Filter");
+
+    set = xset_get(xset::name::select_compare);
+    xset_set_var(set, xset::var::menu_label, "Co_mpare Panels");
+
+    set = xset_get(xset::name::select_compare_content);
+    xset_set_var(set, xset::var::menu_label, "Compare Panels By C_ontent");
+
     // Properties
     set = xset_get(xset::name::con_prop);
     xset_set_var(set, xset::var::menu_label, "Propert_ies");
@@ -1829,6 +1875,7 @@ xset_default_keys()
     def_key(xset::name::paste_link, GDK_KEY_V, (GdkModifierType::GDK_SHIFT_MASK | GdkModifierType::GDK_CONTROL_MASK));
     def_key(xset::name::paste_as, GDK_KEY_A, (GdkModifierType::GDK_SHIFT_MASK | GdkModifierType::GDK_CONTROL_MASK));
     def_key(xset::name::select_all, GDK_KEY_A, GdkModifierType::GDK_CONTROL_MASK);
+    def_key(xset::name::select_filter, GDK_KEY_f, GdkModifierType::GDK_CONTROL_MASK);
     def_key(xset::name::main_terminal, GDK_KEY_F4, 0);
     def_key(xset::name::go_default, GDK_KEY_Escape, 0);
 #if (GTK_MAJOR_VERSION == 4)
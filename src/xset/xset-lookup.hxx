@@ -282,6 +282,7 @@ namespace xset
         view_columns,
         view_reorder_col,
         rubberband,
+        view_preview,
 
         view_sortby,
         sortby_name,
@@ -374,11 +375,21 @@ namespace xset
         move_panel_3,
         move_panel_4,
 
+        sync_to,
+        sync_panel_next,
+        sync_panel_mirror,
+        sync_panel_both,
+        sync_content,
+        find_dups,
+
         edit_hide,
         select_all,
         select_un,
         select_invert,
         select_patt,
+        select_filter,
+        select_compare,
+        select_compare_content,
 
         // Properties //
         con_prop,